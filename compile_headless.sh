@@ -0,0 +1,14 @@
+#!/bin/bash
+# HEADLESS BATCH RENDERER FOR LINUX RENDER NODES, NEEDS GLEW, EGL AND A MESA OR VENDOR GL DRIVER
+baseDir="$(cd "$(dirname "$0")" && pwd)"
+exePath="$baseDir/build/rayleak_headless"
+
+# COMPILE AND LINK, TINYFILEDIALOGS IS ONLY LINKED FOR THE MATERIAL MANAGER AND NEVER OPENS
+clang++ -std=c++17 -O2 -fopenmp "$baseDir/src/headless.cpp" -x c++ "$baseDir/lib/tinyfiledialogs/tinyfiledialogs.c++" \
+-o "$exePath" -lGLEW -lEGL -lOpenGL -fopenmp || exit 1
+
+# COPY SHADERS AND THE THUMBNAIL MESH TO BUILD
+rm -rf "$baseDir/build/shaders"
+cp -r "$baseDir/shaders" "$baseDir/build/shaders"
+mkdir -p "$baseDir/build/thumbnail"
+cp "$baseDir/thumbnail/ThumbnailSphere.obj" "$baseDir/build/thumbnail/"
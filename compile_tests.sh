@@ -0,0 +1,18 @@
+#!/bin/bash
+# TESTS FOR CODE THAT RUNS WITHOUT A GL CONTEXT OR DISPLAY
+baseDir="$(cd "$(dirname "$0")" && pwd)"
+mkdir -p "$baseDir/build/tests"
+
+# GL IS ONLY LINKED BECAUSE THE MANAGER HEADERS REFERENCE IT, NO GL CALL IS MADE
+clang++ -std=c++17 -O2 -fopenmp "$baseDir/tests/memory_managers.cpp" -x c++ "$baseDir/lib/tinyfiledialogs/tinyfiledialogs.c++" \
+-o "$baseDir/build/tests/memory_managers" -lGLEW -lEGL -lOpenGL -fopenmp || exit 1
+
+# THE TILE SCHEDULER HEADER IS PURE C++
+clang++ -std=c++17 -O2 "$baseDir/tests/tile_scheduler.cpp" -o "$baseDir/build/tests/tile_scheduler" || exit 1
+
+# RUN EVERY TEST, A NON ZERO EXIT FAILS THE SCRIPT
+"$baseDir/build/tests/memory_managers" || exit 1
+"$baseDir/build/tests/tile_scheduler" || exit 1
+
+# THE HEADLESS stdout CHECK NEEDS AN EGL DRIVER AND THE BINARY FROM ./compile_headless.sh
+if [ -x "$baseDir/build/rayleak_headless" ]; then "$baseDir/tests/headless_stdout.sh" || exit 1; fi
@@ -0,0 +1,118 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+#include "include/scene.glsl"
+#include "include/accumulate.glsl"
+#include "include/gbuffer.glsl"
+
+// EDGE AVOIDING A-TROUS WAVELET FILTER. THE PREPARE STAGE DIVIDES THE ALBEDO OUT OF THE COLOUR
+// SO TEXTURES SURVIVE THE BLUR, THEN EACH FILTER STAGE WIDENS THE 5x5 KERNEL BY u_stepSize. THE
+// LAST STAGE PUTS THE ALBEDO BACK AND WRITES THE DISPLAYED IMAGE
+
+// ILLUMINATION AND ITS VARIANCE, PING-PONGED BETWEEN STAGES
+layout (binding = 4, rgba32f) uniform readonly image2D filterInput;
+layout (binding = 5, rgba32f) uniform writeonly image2D filterOutput;
+layout (binding = 6, rgba8) uniform writeonly image2D denoisedImage;
+
+// ACCUMULATED OR TEMPORALLY RESOLVED COLOUR, ANY FORMAT
+layout (binding = 0) uniform sampler2D colourTexture;
+
+layout(location = 0) uniform int u_denoiseStage;
+layout(location = 1) uniform int u_stepSize;
+layout(location = 2) uniform uvec2 u_extent;
+layout(location = 3) uniform float u_colourSigma;
+
+#define DENOISE_PREPARE 0
+#define DENOISE_FILTER 1
+#define DENOISE_OUTPUT 2
+
+// SHARPNESS OF THE NORMAL AND RELATIVE DEPTH EDGE STOPS
+#define NORMAL_POWER 64.0f
+#define DEPTH_SIGMA 0.02f
+
+// ALBEDO IS CLAMPED AWAY FROM ZERO SO BLACK SURFACES DON'T BLOW UP THE DIVISION
+vec3 DemodulationAlbedo(FirstHitSample firstHit)
+{
+    return max(firstHit.albedo, vec3(0.01f));
+}
+
+// VARIANCE OF THE PIXEL MEAN FROM ITS MOMENTS, A SPATIAL ESTIMATE WHILE THERE ARE TOO FEW SAMPLES
+float IlluminationVariance(ivec2 pixel, vec3 illumination)
+{
+    vec2 moments = imageLoad(momentImage, pixel).xy;
+    float luminance = Luminance(illumination);
+    if (moments.y >= 4.0f)
+    {
+        float colourLuminance = Luminance(texelFetch(colourTexture, pixel, 0).xyz);
+        float albedoLuminance = max(Luminance(DemodulationAlbedo(LoadFirstHit(pixel))), 0.01f);
+        return max(moments.x - colourLuminance * colourLuminance, 0.0f) / moments.y / (albedoLuminance * albedoLuminance);
+    }
+
+    float mean = 0.0f;
+    float meanSquared = 0.0f;
+    for (int y=-1; y<=1; y++) for (int x=-1; x<=1; x++)
+    {
+        ivec2 tap = clamp(pixel + ivec2(x, y), ivec2(0), ivec2(u_extent) - 1);
+        float tapLuminance = Luminance(texelFetch(colourTexture, tap, 0).xyz / DemodulationAlbedo(LoadFirstHit(tap)));
+        mean += tapLuminance;
+        meanSquared += tapLuminance * tapLuminance;
+    }
+    mean /= 9.0f;
+    return max(meanSquared / 9.0f - mean * mean, 0.0f);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x >= int(u_extent.x) || pixel.y >= int(u_extent.y)) return;
+
+    FirstHitSample centre = LoadFirstHit(pixel);
+
+    if (u_denoiseStage == DENOISE_PREPARE)
+    {
+        vec3 illumination = texelFetch(colourTexture, pixel, 0).xyz / DemodulationAlbedo(centre);
+        imageStore(filterOutput, pixel, vec4(illumination, IlluminationVariance(pixel, illumination)));
+        return;
+    }
+
+    vec4 centreValue = imageLoad(filterInput, pixel);
+    float centreLuminance = Luminance(centreValue.xyz);
+    float luminanceScale = u_colourSigma * sqrt(centreValue.w) + 0.0001f;
+
+    // B3 SPLINE KERNEL, EVERY TAP IS WEIGHTED DOWN ACROSS NORMAL, DEPTH AND COLOUR EDGES
+    const float kernel[3] = float[3](3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f);
+    vec3 sum = vec3(0.0f);
+    float varianceSum = 0.0f;
+    float weightSum = 0.0f;
+    for (int y=-2; y<=2; y++) for (int x=-2; x<=2; x++)
+    {
+        ivec2 tap = pixel + ivec2(x, y) * u_stepSize;
+        if (tap.x < 0 || tap.y < 0 || tap.x >= int(u_extent.x) || tap.y >= int(u_extent.y)) continue;
+
+        vec4 tapValue = imageLoad(filterInput, tap);
+        FirstHitSample tapHit = LoadFirstHit(tap);
+        if (tapHit.hit != centre.hit) continue;
+
+        float normalWeight = centre.hit ? pow(max(dot(centre.normal, tapHit.normal), 0.0f), NORMAL_POWER) : 1.0f;
+        float depthWeight = exp(-abs(centre.distance - tapHit.distance) / (DEPTH_SIGMA * centre.distance * float(max(abs(x), abs(y)) * u_stepSize) + 0.0001f));
+        float colourWeight = exp(-abs(centreLuminance - Luminance(tapValue.xyz)) / luminanceScale);
+
+        float weight = kernel[abs(x)] * kernel[abs(y)] * normalWeight * depthWeight * colourWeight;
+        sum += tapValue.xyz * weight;
+        varianceSum += tapValue.w * weight * weight;
+        weightSum += weight;
+    }
+
+    // THE CENTRE TAP ALWAYS HAS FULL WEIGHT SO THE SUM IS NEVER ZERO
+    vec3 illumination = sum / weightSum;
+    float variance = varianceSum / (weightSum * weightSum);
+    imageStore(filterOutput, pixel, vec4(illumination, variance));
+
+    if (u_denoiseStage == DENOISE_OUTPUT)
+    {
+        imageStore(denoisedImage, pixel, vec4(ACES(illumination * DemodulationAlbedo(centre)), 1.0f));
+    }
+}
@@ -3,8 +3,49 @@
 out vec4 FragColour;
 in vec2 TextureCoord;
 uniform sampler2D DisplayTexture;
+uniform vec2 u_uvScale; // PART OF THE TEXTURE THE IMAGE COVERS, PREVIEWS ONLY FILL A CORNER
+
+// UPSCALES THE (POSSIBLY LOWER RESOLUTION) RENDER TO THE VIEWPORT WITH A CATMULL-ROM FILTER
+// BUILT FROM NINE BILINEAR TAPS. THE FILTER INTERPOLATES, SO AT 1:1 IT RETURNS THE TEXELS UNCHANGED
+// FROM https://gist.github.com/TheRealMJP/c83b8c0f46b63f3a88a5986f4fa982b1
+vec4 SampleCatmullRom(sampler2D tex, vec2 uv)
+{
+    vec2 texSize = vec2(textureSize(tex, 0));
+    vec2 samplePos = uv * texSize;
+    vec2 texPos1 = floor(samplePos - 0.5f) + 0.5f;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5f + f * (1.0f - 0.5f * f));
+    vec2 w1 = 1.0f + f * f * (-2.5f + 1.5f * f);
+    vec2 w2 = f * (0.5f + f * (2.0f - 1.5f * f));
+    vec2 w3 = f * f * (-0.5f + 0.5f * f);
+
+    // THE MIDDLE TWO TAPS ARE MERGED INTO ONE BILINEAR FETCH
+    vec2 w12 = w1 + w2;
+    vec2 offset12 = w2 / w12;
+
+    // KEEP TAPS INSIDE THE RENDERED AREA SO TEXELS OUTSIDE IT NEVER BLEED IN
+    vec2 minPos = 0.5f / texSize;
+    vec2 maxPos = u_uvScale - 0.5f / texSize;
+    vec2 texPos0 = clamp((texPos1 - 1.0f) / texSize, minPos, maxPos);
+    vec2 texPos3 = clamp((texPos1 + 2.0f) / texSize, minPos, maxPos);
+    vec2 texPos12 = clamp((texPos1 + offset12) / texSize, minPos, maxPos);
+
+    vec4 result = vec4(0.0f);
+    result += texture(tex, vec2(texPos0.x, texPos0.y)) * w0.x * w0.y;
+    result += texture(tex, vec2(texPos12.x, texPos0.y)) * w12.x * w0.y;
+    result += texture(tex, vec2(texPos3.x, texPos0.y)) * w3.x * w0.y;
+    result += texture(tex, vec2(texPos0.x, texPos12.y)) * w0.x * w12.y;
+    result += texture(tex, vec2(texPos12.x, texPos12.y)) * w12.x * w12.y;
+    result += texture(tex, vec2(texPos3.x, texPos12.y)) * w3.x * w12.y;
+    result += texture(tex, vec2(texPos0.x, texPos3.y)) * w0.x * w3.y;
+    result += texture(tex, vec2(texPos12.x, texPos3.y)) * w12.x * w3.y;
+    result += texture(tex, vec2(texPos3.x, texPos3.y)) * w3.x * w3.y;
+    return result;
+}
 
 void main()
 {
-    FragColour = texture(DisplayTexture, TextureCoord);
-}
\ No newline at end of file
+    // THE NEGATIVE LOBES CAN OVERSHOOT AT HARD EDGES
+    FragColour = clamp(SampleCatmullRom(DisplayTexture, TextureCoord * u_uvScale), 0.0f, 1.0f);
+}
@@ -0,0 +1,50 @@
+layout (binding = 0, rgba32f) uniform image2D renderImage;
+layout (binding = 1, rgba8) uniform image2D displayImage;
+layout (binding = 2, rg32f) uniform image2D momentImage; // MEAN LUMINANCE SQUARED, SAMPLE COUNT
+
+// SIMPLIFIED ACES TONE MAPPING
+vec3 ACES(vec3 colour)
+{
+    vec3 numerator = colour * (2.51f * colour + 0.03f);
+    vec3 denominator = colour * (2.43f * colour + 0.59f) + 0.14f;
+    vec3 result = numerator / denominator;
+    return clamp(result, 0.0f, 1.0f);
+}
+
+// RELATIVE STANDARD ERROR OF THE PIXEL MEAN, HIGH UNTIL THERE ARE ENOUGH SAMPLES TO TELL
+float PixelError(float mean, float meanSquared, float sampleCount)
+{
+    if (sampleCount < 2.0f) return 1.0f;
+    float variance = max(meanSquared - mean * mean, 0.0f) * sampleCount / (sampleCount - 1.0f);
+    return sqrt(variance / sampleCount) / (mean + 0.05f);
+}
+
+float Luminance(vec3 colour)
+{
+    return dot(colour, vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// ADDS A DISPATCH'S SAMPLES TO THE PIXEL IN ONE READ-MODIFY-WRITE AND RETURNS ITS NEW ERROR
+// ESTIMATE. colourSum AND luminanceSquaredSum ARE SUMMED OVER THE samples TAKEN
+float AccumulatePixel(uint pX, uint pY, vec3 colourSum, float luminanceSquaredSum, float samples)
+{
+    // PIXELS SKIPPED BY ADAPTIVE SAMPLING HOLD FEWER SAMPLES THAN THE PASS COUNT
+    vec2 moments = imageLoad(momentImage, ivec2(pX, pY)).xy;
+    float sampleCount = u_accumulationFrame == 0 ? 0.0f : moments.y;
+    float newSampleCount = sampleCount + samples;
+
+    // FRAME ACCUMULATION
+    vec4 oldAvg = imageLoad(renderImage, ivec2(pX, pY)); 
+    vec4 newAvg = ((oldAvg * sampleCount) + vec4(colourSum.xyz, samples)) / newSampleCount;
+    imageStore(renderImage, ivec2(pX, pY), vec4(newAvg.xyz, 1.0f));   
+
+    // SECOND MOMENT OF LUMINANCE FOR THE VARIANCE ESTIMATE
+    float meanSquared = ((moments.x * sampleCount) + luminanceSquaredSum) / newSampleCount;
+    imageStore(momentImage, ivec2(pX, pY), vec4(meanSquared, newSampleCount, 0.0f, 0.0f));
+
+    // SET DISPLAY IMAGE PIXEL
+    vec3 outputColour = ACES(newAvg.xyz);
+    imageStore(displayImage, ivec2(pX, pY), vec4(outputColour.xyz, 1.0f));  
+
+    return PixelError(Luminance(newAvg.xyz), meanSquared, newSampleCount);
+}
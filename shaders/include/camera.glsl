@@ -0,0 +1,56 @@
+vec3 PixelRayPos(uint x, uint y, uint width, uint height, uint seed, bool antiAliased)
+{
+    float FOV_Radians = DegreesToRadians(cameraInfo.FOV);
+    float aspectRatio = float(width) / float(height);
+    float nearPlane = 0.1f;
+    
+    // VIEWING PLANE
+    float planeHeight = nearPlane * tan(FOV_Radians * 0.5f);
+    float planeWidth = planeHeight * aspectRatio;
+
+    // NORMALISED PIXEL COORDINATES
+    float nx, ny;
+    if (antiAliased)
+    {
+        vec2 randomCirclePoint = RandomPointInCircle(seed);
+        nx = (x + randomCirclePoint.x) / (width - 1.0f);
+        ny = (y + randomCirclePoint.y) / (height - 1.0f);
+    }
+    else
+    {
+        nx = (x) / (width - 1.0f);
+        ny = (y) / (height - 1.0f);
+    }
+
+    // CALCULATE PIXEL COORDINATE IN PLANE SPACE
+    vec3 localBL = vec3(-planeWidth * 0.5f, -planeHeight * 0.5f, nearPlane);
+    vec3 localPoint = localBL + vec3(planeWidth * nx, planeHeight * ny, 0.0f);
+
+    // CALCULATE PIXEL COORDINATE IN WORLD SPACE
+    vec3 worldPoint = cameraInfo.pos - cameraInfo.right * localPoint.x + cameraInfo.up * localPoint.y + cameraInfo.forward * localPoint.z;
+    return worldPoint;
+}
+
+// CAMERA RAY THROUGH A PIXEL WITH ANTI ALIASING AND DEPTH OF FIELD
+Ray CameraRay(uint pX, uint pY, uint width, uint height, uint seed)
+{
+    Ray camRay;
+    camRay.origin = PixelRayPos(pX, pY, width, height, seed + 313874256, cameraInfo.antiAliasing == 1);
+    camRay.dir = normalize(camRay.origin - cameraInfo.pos);
+
+    // DEPTH OF FIELD
+    if (cameraInfo.DOF == 1 && u_resolution_scale > 0.9)
+    {
+        float ratio = dot(cameraInfo.forward, camRay.dir);
+        float inverseRatio = 1 / ratio;
+        vec3 shortCUP = cameraInfo.pos + cameraInfo.forward * ratio;
+        vec3 orthogonal = (camRay.origin + camRay.dir) - shortCUP;
+        vec3 unitFocalPoint = cameraInfo.pos + cameraInfo.forward + orthogonal * inverseRatio;
+        vec3 focalPoint = cameraInfo.pos + cameraInfo.forward * cameraInfo.focusDistance + orthogonal * inverseRatio * cameraInfo.focusDistance;
+
+        vec2 randCirclePos = RandomPointInCircle(seed) * cameraInfo.aperture;
+        camRay.origin += cameraInfo.right * randCirclePos.x + cameraInfo.up * randCirclePos.y;
+        camRay.dir = normalize(focalPoint - camRay.origin);
+    }
+    return camRay;
+}
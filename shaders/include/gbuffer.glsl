@@ -0,0 +1,58 @@
+// FIRST HIT OF EACH PIXEL, WRITTEN BY THE FIRST PASS AT A CAMERA POSE AND USED TO REPROJECT AND
+// DENOISE. PACKED INTO ONE TEXEL SO THE GUIDES FIT THE GUARANTEED IMAGE UNITS:
+// X DISTANCE FROM THE CAMERA, Y OCTAHEDRAL NORMAL, Z ALBEDO, W 1 FOR A HIT AND 0 FOR SKY
+layout (binding = 3, rgba32ui) uniform uimage2D firstHitImage;
+
+// SKY PIXELS SIT THIS FAR ALONG THEIR RAY SO THEY STILL REPROJECT
+#define SKY_DISTANCE 10000.0f
+
+struct FirstHitSample
+{
+    float distance;
+    vec3 normal;
+    vec3 albedo;
+    bool hit;
+};
+
+vec2 OctahedralEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 folded = (1.0f - abs(n.yx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    return n.z >= 0.0f ? n.xy : folded;
+}
+
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+uvec4 PackFirstHit(float distance, vec3 normal, vec3 albedo)
+{
+    return uvec4(floatBitsToUint(distance), packSnorm2x16(OctahedralEncode(normal)), packUnorm4x8(vec4(albedo, 1.0f)), 1u);
+}
+
+uvec4 PackSkyHit()
+{
+    return uvec4(floatBitsToUint(SKY_DISTANCE), 0u, packUnorm4x8(vec4(1.0f)), 0u);
+}
+
+void StoreFirstHit(uint pX, uint pY, uvec4 firstHit)
+{
+    if (u_accumulationFrame != 0) return;
+    imageStore(firstHitImage, ivec2(pX, pY), firstHit);
+}
+
+FirstHitSample LoadFirstHit(ivec2 pixel)
+{
+    uvec4 bits = imageLoad(firstHitImage, pixel);
+    FirstHitSample firstHit;
+    firstHit.distance = uintBitsToFloat(bits.x);
+    firstHit.normal = OctahedralDecode(unpackSnorm2x16(bits.y));
+    firstHit.albedo = unpackUnorm4x8(bits.z).xyz;
+    firstHit.hit = bits.w == 1u;
+    return firstHit;
+}
@@ -0,0 +1,359 @@
+// RAYS TRACED BY THIS INVOCATION, SUMMED PER GROUP FOR THE RAYS/SEC STATISTIC
+uint tracedRays = 0;
+
+// adapted from https://jacco.ompf2.com/2022/04/13/how-to-build-a-bvh-part-1-basics/
+float IntersectAABB(Ray ray, vec3 aabbMin, vec3 aabbMax)
+{
+    vec3 tMin = (aabbMin - ray.origin) * (1.0f / ray.dir);
+    vec3 tMax = (aabbMax - ray.origin) * (1.0f / ray.dir);
+    vec3 t1 = min(tMin, tMax);
+    vec3 t2 = max(tMin, tMax);
+    float distFar = min(min(t2.x, t2.y), t2.z);
+    float distNear = max(max(t1.x, t1.y), t1.z);
+    bool hit = distFar >= distNear && distFar > 0.0f;
+    return hit ? distNear : 100000.0f;
+}
+
+// HOW THE STACKLESS TRAVERSAL REACHED THE CURRENT NODE. A NODE REACHED FROM ITS PARENT IS THE
+// NEAR CHILD, FROM ITS SIBLING THE FAR CHILD, AND FROM A CHILD ITS SUBTREE IS ALREADY DONE
+#define BVH_FROM_PARENT 0
+#define BVH_FROM_SIBLING 1
+#define BVH_FROM_CHILD 2
+
+// THE WAY DOWN AND THE WAY BACK UP MUST AGREE ON WHICH CHILD IS NEAR, SO IT ONLY DEPENDS ON THE
+// SPLIT AXIS AND THE RAY DIRECTION
+bool LeftIsNear(uint splitAxis, vec3 dir)
+{
+    return dir[splitAxis] >= 0.0f;
+}
+
+// CHILDREN ARE ALLOCATED IN PAIRS WITH THE LEFT ONE ON THE ODD INDEX
+uint SiblingNode(uint node)
+{
+    return (node & 1u) != 0u ? node + 1u : node - 1u;
+}
+
+struct RayHit
+{
+    vec3 pos;
+    vec3 normal;
+    vec3 faceNormal;
+    vec3 tangent;
+    vec2 uv;
+    float dist;
+    bool hit;
+    bool frontFace;
+    uint materialIndex;
+};
+
+// CLOSEST TRIANGLE FOUND BY THE TRAVERSAL, HIT ATTRIBUTES ARE ONLY BUILT FOR IT ONCE IT HAS WON
+struct TriangleHit
+{
+    float dist;
+    float u;
+    float v;
+    uint index; // FIRST OF THE TRIANGLE'S THREE ENTRIES IN ITS INDEX PAGE
+    int mesh;
+};
+
+// MOLLER-TRUMBORE, ONLY THE DISTANCE AND BARYCENTRICS
+bool RayTriangle(Ray ray, vec3 v1, vec3 v2, vec3 v3, out float dist, out float u, out float v)
+{
+    dist = 10000000.0f;
+
+    // CALCULATE THE DETERMINANT
+    vec3 edge1 = v2 - v1;
+    vec3 edge2 = v3 - v1;
+    vec3 p = cross(ray.dir, edge2);
+    float determinant = dot(edge1, p);
+    if (abs(determinant) < 0.000001f) return false;
+
+    // CALCULATE U BARYCENTRIC COORDINATE
+    float inverseDeterminant = 1.0f / determinant;
+    vec3 v1TOorigin = ray.origin - v1;
+    u = dot(v1TOorigin, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    // CALCULATE V BARYCENTRIC COORDINATE
+    vec3 q = cross(v1TOorigin, edge1);
+    v = dot(ray.dir, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    // CALCULATE HIT DISTANCE
+    dist = dot(edge2, q) * inverseDeterminant;
+    return dist >= 0.0f;
+}
+
+// BUILDS THE SHADING ATTRIBUTES OF THE WINNING TRIANGLE, ONCE PER RAY
+RayHit ReconstructHit(Ray ray, TriangleHit closest)
+{
+    uint mesh = uint(closest.mesh);
+    uint meshPage = meshPartitions[mesh].page;
+    uint verticesStart = meshPartitions[mesh].verticesStart;
+
+    // PAGE INDICES MUST STAY DYNAMICALLY UNIFORM, SO EACH PAGE IS VISITED RATHER THAN INDEXED
+    Vertex v1, v2, v3;
+    for (uint page=0; page<GEOMETRY_PAGES; page++)
+    {
+        if (page != meshPage) continue;
+        v1 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[closest.index]];
+        v2 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[closest.index + 1]];
+        v3 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[closest.index + 2]];
+    }
+
+    // SAME MESH SPACE RAY THE TRAVERSAL HIT THE TRIANGLE WITH
+    Ray transformedRay;
+    transformedRay.origin = (meshPartitions[mesh].inverseTransform * vec4(ray.origin, 1.0)).xyz;
+    transformedRay.dir = (meshPartitions[mesh].inverseTransform * vec4(ray.dir, 0.0)).xyz;
+
+    // CALCULATE W BARYCENTRIC COORDINATE
+    float u = closest.u;
+    float v = closest.v;
+    float w = 1.0f - u - v;
+
+    // INTERPOLATE NORMAL USING BARYCENTRIC COORDINATES
+    vec3 edge1 = v2.pos - v1.pos;
+    vec3 edge2 = v3.pos - v1.pos;
+    vec3 normal = normalize(v1.normal * w + v2.normal * u + v3.normal * v);
+    vec3 faceNormal = normalize(cross(edge1, edge2));
+
+    RayHit hit;
+    hit.pos = transformedRay.origin + transformedRay.dir * closest.dist;
+
+    // CALCULATE THE TANGENT
+    vec2 dUV1 = vec2(v2.u, v2.v) - vec2(v1.u, v1.v);
+    vec2 dUV2 = vec2(v3.u, v3.v) - vec2(v1.u, v1.v);
+    float tanDenominator = dUV1.x * dUV2.y - dUV2.x * dUV1.y;
+    if (abs(tanDenominator) > 0.000001f)
+    {
+        float inverseDenominator = 1 / tanDenominator;
+        hit.tangent = normalize(vec3(edge1 * dUV2.y - edge2 * dUV1.y) * inverseDenominator);
+    }
+    else
+    {
+        hit.tangent = vec3(1, 0, 0);
+    }
+
+    // SET HIT VALUES
+    hit.frontFace = dot(transformedRay.dir, normal) < 0.0f;
+    hit.normal = hit.frontFace ? normal : -normal;
+    hit.faceNormal = hit.frontFace ? faceNormal : -faceNormal;
+    hit.uv = vec2(v1.u, v1.v) * w + vec2(v2.u, v2.v) * u + vec2(v3.u, v3.v) * v;
+    hit.dist = closest.dist;
+    hit.hit = true;
+    hit.materialIndex = meshPartitions[mesh].materialIndex;
+
+    // NORMAL MAP IN MESH SPACE, THEN EVERYTHING BACK TO WORLD SPACE
+    if ((materials[hit.materialIndex].textureFlags & (1 << 1)) != 0)
+    {
+        vec3 bitangent = normalize(cross(hit.tangent, hit.faceNormal));
+        mat3 TBM = mat3(hit.tangent, bitangent, hit.faceNormal);
+        vec3 normalMap = SampleMaterialTexture(materials[hit.materialIndex].normalHandle, hit.uv).xyz * 2 - 1;
+        hit.normal = normalize(TBM * normalMap);
+    }
+    mat3 normalMatrix = transpose(mat3(meshPartitions[mesh].inverseTransform));
+    hit.normal = normalMatrix * hit.normal;
+    hit.pos = (meshPartitions[mesh].transform * vec4(hit.pos, 1.0)).xyz;
+    return hit;
+}
+
+// CLOSEST HIT TRAVERSAL. LEAVES ONLY READ VERTEX POSITIONS AND KEEP t, u, v AND THE TRIANGLE,
+// THE ATTRIBUTES OF THE FINAL HIT ARE FETCHED ONCE AFTERWARDS
+RayHit CastRay(Ray ray)
+{   
+    tracedRays++;
+
+    TriangleHit closest;
+    closest.dist = 100000.0f;
+    closest.mesh = -1;
+
+    // FOR EACH MESH
+    for (int m=0; m<u_meshCount; m++) 
+    {
+        uint indicesStart = meshPartitions[m].indicesStart;
+        uint verticesStart = meshPartitions[m].verticesStart;
+        uint bvhStart = meshPartitions[m].bvhNodeStart;
+        uint page = meshPartitions[m].page;
+
+        // TRANSFORM RAY TO BE IN MESH SPACE
+        Ray transformedRay;
+        transformedRay.origin = (meshPartitions[m].inverseTransform * vec4(ray.origin, 1.0)).xyz;
+        transformedRay.dir = (meshPartitions[m].inverseTransform * vec4(ray.dir, 0.0)).xyz;
+
+        // TRAVERSE BVH WITHOUT A STACK, CORRECT AT ANY DEPTH
+        uint current = 0;
+        uint state = BVH_FROM_PARENT;
+        while (true)
+        {
+            // SUBTREE DONE: A NEAR CHILD HANDS OVER TO ITS SIBLING, A FAR CHILD CLIMBS ON UP
+            if (state == BVH_FROM_CHILD)
+            {
+                if (current == 0) break;
+                uint parent = bvhPages[page].bvhNodes[current + bvhStart].parent;
+                bool isLeft = (current & 1u) != 0u;
+                if (isLeft == LeftIsNear(bvhPages[page].bvhNodes[parent + bvhStart].splitAxis, transformedRay.dir))
+                {
+                    current = SiblingNode(current);
+                    state = BVH_FROM_SIBLING;
+                }
+                else current = parent;
+                continue;
+            }
+
+            BVH_Node node = bvhPages[page].bvhNodes[current + bvhStart];
+            bool boxHit = IntersectAABB(transformedRay, node.aabbMin, node.aabbMax) < closest.dist;
+            if (boxHit && node.indexCount == 0)
+            {
+                current = LeftIsNear(node.splitAxis, transformedRay.dir) ? node.leftChild : node.rightChild;
+                state = BVH_FROM_PARENT;
+                continue;
+            }
+
+            // NODE IS A LEAF: CHECK FOR TRIANGLE INTERSECTION
+            if (boxHit)
+            {
+                // FOR EACH TRIANGLE IN NODE's BOUNDING BOX
+                for (int i=0; i<node.indexCount; i+=3) 
+                {
+                    uint index = node.firstIndex + indicesStart + i;
+                    vec3 v1 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index]].pos;
+                    vec3 v2 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index + 1]].pos;
+                    vec3 v3 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index + 2]].pos;
+                    float dist, u, v;
+                    if (RayTriangle(transformedRay, v1, v2, v3, dist, u, v) && dist < closest.dist) 
+                    {
+                        closest.dist = dist;
+                        closest.u = u;
+                        closest.v = v;
+                        closest.index = index;
+                        closest.mesh = m;
+                    }
+                }
+            }
+
+            // NODE MISSED OR LEAF DONE
+            if (current == 0) break;
+            if (state == BVH_FROM_PARENT)
+            {
+                current = SiblingNode(current);
+                state = BVH_FROM_SIBLING;
+            }
+            else
+            {
+                current = node.parent;
+                state = BVH_FROM_CHILD;
+            }
+        }
+    }
+
+    if (closest.mesh >= 0) return ReconstructHit(ray, closest);
+
+    RayHit hit;
+    hit.dist = 100000.0f;
+    hit.hit = false;
+    return hit;
+}
+
+// OCCLUSION ONLY MOLLER-TRUMBORE, BARYCENTRICS ARE KEPT SCALED BY THE DETERMINANT SO THE ONE
+// DIVISION IS LEFT UNTIL THE TRIANGLE IS KNOWN TO BE HIT
+bool OccludesRay(Ray ray, vec3 v1, vec3 v2, vec3 v3, float maxDist)
+{
+    vec3 edge1 = v2 - v1;
+    vec3 edge2 = v3 - v1;
+    vec3 p = cross(ray.dir, edge2);
+    float determinant = dot(edge1, p);
+    if (abs(determinant) < 0.000001f) return false;
+
+    // FLIP SO THE SCALED TESTS ALL COMPARE AGAINST A POSITIVE DETERMINANT
+    float sign = determinant < 0.0f ? -1.0f : 1.0f;
+    float absDeterminant = determinant * sign;
+    vec3 v1TOorigin = ray.origin - v1;
+    float u = dot(v1TOorigin, p) * sign;
+    if (u < 0.0f || u > absDeterminant) return false;
+
+    vec3 q = cross(v1TOorigin, edge1);
+    float v = dot(ray.dir, q) * sign;
+    if (v < 0.0f || u + v > absDeterminant) return false;
+
+    float dist = dot(edge2, q) * sign;
+    return dist >= 0.0f && dist < maxDist * absDeterminant;
+}
+
+// ANY-HIT TRAVERSAL FOR SHADOW RAYS, RETURNS ON THE FIRST OCCLUDER IN ANY MESH. ONLY VERTEX
+// POSITIONS ARE READ AND NO HIT ATTRIBUTES ARE BUILT. BOXES MISSED OR BEYOND THE LIGHT ARE
+// SKIPPED, NEARER CHILDREN ARE VISITED FIRST
+bool ShadowCast(Ray ray, vec3 lightPos)
+{
+    tracedRays++;
+    float lightDist = length(lightPos - ray.origin);
+    
+    // FOR EACH MESH
+    for (int m=0; m<u_meshCount; m++) 
+    {
+        uint indicesStart = meshPartitions[m].indicesStart;
+        uint verticesStart = meshPartitions[m].verticesStart;
+        uint bvhStart = meshPartitions[m].bvhNodeStart;
+        uint page = meshPartitions[m].page;
+
+        // TRANSFORM RAY TO BE IN MESH SPACE
+        Ray transformedRay;
+        transformedRay.origin = (meshPartitions[m].inverseTransform * vec4(ray.origin, 1.0)).xyz;
+        transformedRay.dir = (meshPartitions[m].inverseTransform * vec4(ray.dir, 0.0)).xyz;
+
+        // TRAVERSE BVH WITHOUT A STACK, A MISSED ROOT SKIPS THE WHOLE MESH
+        uint current = 0;
+        uint state = BVH_FROM_PARENT;
+        while (true)
+        {
+            if (state == BVH_FROM_CHILD)
+            {
+                if (current == 0) break;
+                uint parent = bvhPages[page].bvhNodes[current + bvhStart].parent;
+                bool isLeft = (current & 1u) != 0u;
+                if (isLeft == LeftIsNear(bvhPages[page].bvhNodes[parent + bvhStart].splitAxis, transformedRay.dir))
+                {
+                    current = SiblingNode(current);
+                    state = BVH_FROM_SIBLING;
+                }
+                else current = parent;
+                continue;
+            }
+
+            BVH_Node node = bvhPages[page].bvhNodes[current + bvhStart];
+            bool boxHit = IntersectAABB(transformedRay, node.aabbMin, node.aabbMax) < lightDist;
+            if (boxHit && node.indexCount == 0)
+            {
+                current = LeftIsNear(node.splitAxis, transformedRay.dir) ? node.leftChild : node.rightChild;
+                state = BVH_FROM_PARENT;
+                continue;
+            }
+
+            // NODE IS A LEAF: ANY TRIANGLE BEFORE THE LIGHT ENDS THE QUERY
+            if (boxHit)
+            {
+                for (int i=0; i<node.indexCount; i+=3) 
+                {
+                    uint index = node.firstIndex + indicesStart + i;
+                    vec3 v1 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index]].pos;
+                    vec3 v2 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index + 1]].pos;
+                    vec3 v3 = vertexPages[page].vertices[verticesStart + indexPages[page].indices[index + 2]].pos;
+                    if (OccludesRay(transformedRay, v1, v2, v3, lightDist)) return true;
+                }
+            }
+
+            if (current == 0) break;
+            if (state == BVH_FROM_PARENT)
+            {
+                current = SiblingNode(current);
+                state = BVH_FROM_SIBLING;
+            }
+            else
+            {
+                current = node.parent;
+                state = BVH_FROM_CHILD;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,82 @@
+// EACH SAMPLE RETURNS THE LIGHT REACHING THE SURFACE IF NOTHING BLOCKS IT, PLUS THE SHADOW
+// RAY AND DISTANCE TO TEST THAT WITH. FALSE WHEN THE LIGHT CAN'T REACH THE SURFACE AT ALL
+
+bool SampleDirectionalLight(int d, vec3 position, vec3 normal, float roughness, uint seed, out Ray shadowRay, out float lightDist, out vec3 light)
+{
+    light = vec3(0.0f, 0.0f, 0.0f);
+    shadowRay.dir = -directionalLights[d].direction;
+    shadowRay.origin = position + normal * 0.00001f;
+    lightDist = 5000.0f;
+
+    // SKIP COMPUTATION IF SURFACE FACES AWAY FROM LIGHT
+    if (dot(normal, -directionalLights[d].direction) < 0.0f) return false;
+
+    // PERTURB THE SURFACE NORMAL BASED ON ROUGHNESS
+    vec3 roughNormal = RandomHemisphereDirection(normal, seed + d * 23563456);
+    vec3 surfaceNormal = normalize((1.0f - roughness) * normal + roughness * roughNormal);
+    float surfaceCosineFactor = max(0.0f, dot(surfaceNormal, shadowRay.dir));
+
+    light = surfaceCosineFactor * (directionalLights[d].colour * directionalLights[d].brightness);
+    return true;
+}
+
+bool SamplePointLight(int p, vec3 position, vec3 normal, float roughness, uint seed, out Ray shadowRay, out float lightDist, out vec3 light)
+{
+    light = vec3(0.0f, 0.0f, 0.0f);
+    shadowRay.dir = normalize(pointLights[p].position - position);  // Direction to the light
+    shadowRay.origin = position + normal * 0.00001f;
+    lightDist = length(pointLights[p].position - shadowRay.origin);
+
+    // SKIP COMPUTATION IF SURFACE FACES AWAY FROM LIGHT
+    if (dot(normal, shadowRay.dir) < 0.0f) return false;
+
+    // PERTURB THE SURFACE NORMAL BASED ON ROUGHNESS
+    vec3 roughNormal = RandomHemisphereDirection(normal, seed + p * 345768996);
+    vec3 surfaceNormal = normalize((1.0f - roughness) * normal + roughness * roughNormal);
+    float surfaceCosineFactor = max(0.0f, dot(surfaceNormal, shadowRay.dir));
+
+    light = surfaceCosineFactor * (pointLights[p].colour * pointLights[p].brightness) / (lightDist * lightDist);
+    return true;
+}
+
+bool SampleSpotlight(int s, vec3 position, vec3 normal, float roughness, uint seed, out Ray shadowRay, out float lightDist, out vec3 light)
+{
+    light = vec3(0.0f, 0.0f, 0.0f);
+    shadowRay.dir = normalize(spotlights[s].position - position);
+    shadowRay.origin = position + normal * 0.00001f;
+    lightDist = length(spotlights[s].position - shadowRay.origin);
+
+    // SKIP COMPUTATION IF SURFACE FACES AWAY FROM LIGHT
+    if (dot(normal, shadowRay.dir) < 0.0f) return false;
+
+    vec3 dirFromSpotlight = normalize(shadowRay.origin - spotlights[s].position);
+
+    // ANGLE BETWEEN SPOTLIGHT DIRECTION AND DIRECTION OF LIGHT
+    // RAY EMMITED FROM SPOTLIGHT TO SURFACE POINT
+    float surfaceToSpotlightRadians = acos(dot(spotlights[s].direction, dirFromSpotlight));
+    float spotlightAngleRadians = DegreesToRadians(spotlights[s].angle);
+    float spotlightFalloffRadians = DegreesToRadians(spotlights[s].falloff);
+    float spotlightMaxAngleRadians = spotlightAngleRadians + spotlightFalloffRadians;
+
+    // SKIP SHADOW CAST IF SURFACE POINT NOT IN VISIBLE CONE
+    if (surfaceToSpotlightRadians > spotlightMaxAngleRadians) return false;
+
+    // PERTURB THE SURFACE NORMAL BASED ON ROUGHNESS
+    vec3 roughNormal = RandomHemisphereDirection(normal, seed + s * 54739845);
+    vec3 surfaceNormal = normalize((1.0f - roughness) * normal + roughness * roughNormal);
+    float surfaceCosineFactor = max(0.0f, dot(surfaceNormal, shadowRay.dir));
+
+    // POINT INSIDE INNER CONE
+    if (surfaceToSpotlightRadians < spotlightAngleRadians)
+    {
+        light = surfaceCosineFactor * (spotlights[s].colour * spotlights[s].brightness) / (lightDist * lightDist);
+    }
+
+    // POINT INSIDE CONE FALLOFF
+    else if (surfaceToSpotlightRadians < spotlightMaxAngleRadians)
+    {
+        float fallOffFade = CosineInterpolation(spotlightAngleRadians, spotlightMaxAngleRadians, surfaceToSpotlightRadians);
+        light = surfaceCosineFactor * fallOffFade * (spotlights[s].colour * spotlights[s].brightness) / (lightDist * lightDist);
+    }
+    return true;
+}
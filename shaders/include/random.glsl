@@ -0,0 +1,67 @@
+// FROM Sebastian Lague
+// BY // www.pcg-random.org and www.shadertoy.com/view/XlGcRh
+float Random(uint seed)
+{
+    seed = seed * 747796405 + 2891336453;
+    uint result = ((seed >> ((seed >> 28) + 4)) ^ seed) * 277803737;
+    result = (result >> 22) ^ result;
+    return result / 4294967295.0;
+}
+
+float RandomValueNormalDistribution(uint seed)
+{
+    float theta = 2.0f * 3.1415926 * Random(seed);
+    float rho = sqrt(-2.0f * log(Random(seed + 124284930)));
+    return rho * cos(theta);
+}
+
+vec3 RandomDirection(uint seed)
+{
+    float x = RandomValueNormalDistribution(seed+100);
+    float y = RandomValueNormalDistribution(seed+101);
+    float z = RandomValueNormalDistribution(seed+102);
+    vec3 randomDir = vec3(x, y, z);
+    return normalize(randomDir);
+}
+
+vec3 RandomHemisphereDirection(vec3 normal, uint seed)
+{
+    vec3 randDir = RandomDirection(seed);
+    if (dot(randDir, normal) < 0.0f) randDir = -randDir;
+    return randDir;
+}
+
+vec3 RandomHemisphereDirectionCosine(vec3 normal, uint seed)
+{
+    float u1 = Random(seed+103);
+    float u2 = Random(seed+104);
+    float r = sqrt(u1);
+    float theta = 6.2831853f * u2;
+    float x = r * cos(theta);
+    float y = r * sin(theta);
+    vec3 randDir = vec3(x, y, sqrt(max(0.0f, 1.0f - u1)));
+    if (dot(randDir, normal) < 0.0f) randDir = -randDir;
+    return randDir;
+}
+
+// ADAPTED FROM USER Pommy https://stackoverflow.com/questions/5837572/generate-a-random-point-within-a-circle-uniformly
+vec2 RandomPointInCircle(uint seed)
+{
+    float rho = Random(seed);
+    float phi = Random(seed) * 6.2831853f;
+    float x = rho * cos(phi);
+    float y = rho * sin(phi);
+    return vec2(x, y);
+}
+
+float DegreesToRadians(float degrees)
+{
+    return degrees * 0.01745329f;
+}
+
+float CosineInterpolation(float min, float max, float value)
+{
+    // CONVERT TO RADIANS
+    float radians = ((value - min) / (max - min)) * 1.570796f; 
+    return cos(radians);
+}
@@ -0,0 +1,172 @@
+// SCENE DATA SHARED BY THE MEGAKERNEL AND THE WAVEFRONT KERNELS
+
+// TEXTURE HANDLES NEED BINDLESS TEXTURES. DRIVERS WITHOUT THEM (MESA LLVMPIPE ON RENDER NODES)
+// CARRY THE HANDLE AS A uvec2 OF THE SAME SIZE AND THE HOST NEVER SETS ANY TEXTURE FLAGS
+#ifdef GL_ARB_bindless_texture
+#define TextureHandle uint64_t
+#else
+#define TextureHandle uvec2
+#endif
+
+struct Vertex
+{
+    vec3 pos;
+    vec3 normal;
+    float u, v;
+};
+
+struct Material
+{
+    vec3 colour;
+    float roughness;
+    float emission;
+    float IOR;
+    int refractive;
+    TextureHandle albedoHandle;
+    TextureHandle normalHandle;
+    TextureHandle roughnessHandle;
+    uint textureFlags;
+};
+
+vec4 SampleMaterialTexture(TextureHandle handle, vec2 uv)
+{
+#ifdef GL_ARB_bindless_texture
+    return texture(sampler2D(handle), uv);
+#else
+    return vec4(1.0f);
+#endif
+}
+
+struct DirectionalLight
+{
+    vec3 direction;
+    vec3 rotation;
+    vec3 colour;
+    float brightness;
+};
+
+struct PointLight
+{
+    vec3 position;
+    vec3 colour;
+    float brightness;
+};
+
+struct Spotlight
+{
+    vec3 position;
+    vec3 rotation;
+    vec3 direction;
+    vec3 colour;
+    float brightness;
+    float angle;
+    float falloff;
+};
+
+struct BVH_Node
+{
+    vec3 aabbMin;
+    uint parent;
+    vec3 aabbMax;
+    uint leftChild;
+    uint rightChild;
+    uint firstIndex;
+    uint indexCount;
+    uint splitAxis;
+};
+
+struct MeshPartition
+{
+    uint verticesStart;
+    uint indicesStart;
+    uint materialIndex;
+    uint bvhNodeStart;
+    mat4x4 inverseTransform;
+    mat4x4 transform;
+    uint page;
+    uint padding[3];
+};
+
+struct CameraInfo
+{
+    vec3 pos;
+    vec3 forward;
+    vec3 right;
+    vec3 up;
+    float FOV;
+    uint DOF;
+    float focusDistance;
+    float aperture;
+    uint antiAliasing;
+    float exposure;
+};
+
+struct Ray
+{
+    vec3 origin;
+    vec3 dir;
+};
+
+layout(binding = 4) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+
+// GEOMETRY IS PAGED OVER SEVERAL BUFFERS, THE CPU DEFINES GEOMETRY_PAGES FROM THE DEVICE LIMITS
+// PAGE INDICES COME FROM THE MESH LOOP SO THEY STAY DYNAMICALLY UNIFORM
+#ifndef GEOMETRY_PAGES
+#define GEOMETRY_PAGES 2
+#endif
+#define GEOMETRY_PAGE_BINDING 27
+
+// KERNELS THAT NEVER TRACE OR LIGHT CAN LEAVE THOSE BUFFERS OUT WITH SCENE_NO_GEOMETRY AND
+// SCENE_NO_LIGHTS, SOME DRIVERS COUNT EVERY DECLARED BLOCK AGAINST THE LIMIT OF 16
+#ifndef SCENE_NO_GEOMETRY
+layout(binding = GEOMETRY_PAGE_BINDING) readonly buffer VertexBuffer {
+    Vertex vertices[];
+} vertexPages[GEOMETRY_PAGES];
+
+layout(binding = GEOMETRY_PAGE_BINDING + GEOMETRY_PAGES) readonly buffer IndexBuffer {
+    uint indices[];
+} indexPages[GEOMETRY_PAGES];
+
+layout(binding = GEOMETRY_PAGE_BINDING + 2 * GEOMETRY_PAGES) readonly buffer BVHBuffer {
+    BVH_Node bvhNodes[];
+} bvhPages[GEOMETRY_PAGES];
+
+layout(binding = 6) readonly buffer PartitionBuffer {
+    MeshPartition meshPartitions[];
+};
+#endif
+
+#ifndef SCENE_NO_LIGHTS
+layout(binding = 7) readonly buffer DirectionalLightBuffer {
+    DirectionalLight directionalLights[];
+};
+
+layout(binding = 8) readonly buffer PointLightBuffer {
+    PointLight pointLights[];
+};
+
+layout(binding = 9) readonly buffer SpotlightLightBuffer {
+    Spotlight spotlights[];
+};
+#endif
+
+layout(std140, binding = 0) uniform FrameConstants {
+    CameraInfo cameraInfo;
+    vec3 u_skyColour;
+    float u_skyBrightness;
+    uint u_frameCount;
+    uint u_accumulationFrame;
+    uint u_bounces;
+    float u_resolution_scale;
+    int u_meshCount;
+    uint u_directionalLightCount;
+    uint u_pointLightCount;
+    uint u_spotlightCount;
+    uint u_debugMode;
+    uint u_statsSlot;
+    uint u_samplesPerDispatch;
+    uint u_renderWidth;
+    uint u_renderHeight;
+};
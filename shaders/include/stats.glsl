@@ -0,0 +1,20 @@
+// RAYS TRACED PER BATCH, THE CPU PICKS THE SLOT AND READS IT BACK WITH THE BATCH TIMER
+layout(binding = 26) buffer RayStatsBuffer {
+    uint rayCounts[];
+};
+
+shared uint groupRays;
+
+// BOTH MUST BE REACHED BY EVERY INVOCATION IN THE GROUP
+void BeginRayStats()
+{
+    if (gl_LocalInvocationIndex == 0) groupRays = 0;
+    barrier();
+}
+
+void EndRayStats()
+{
+    atomicAdd(groupRays, tracedRays);
+    barrier();
+    if (gl_LocalInvocationIndex == 0) atomicAdd(rayCounts[u_statsSlot], groupRays);
+}
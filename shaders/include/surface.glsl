@@ -0,0 +1,87 @@
+// FROM RAY TRACING IN A WEEKEND https://raytracing.github.io/books/RayTracingInOneWeekend.html#dielectrics/refraction
+vec3 Refract(vec3 inDir, vec3 normal, float eta, float cosTheta)
+{
+    vec3 rPerp = eta * (inDir + cosTheta * normal);
+    float rPerpSquared = dot(rPerp, rPerp);
+    if (rPerpSquared > 1.0f) return vec3(0.0f, 0.0f, 0.0f);
+    vec3 rParallel = -sqrt(1 - rPerpSquared) * normal;
+    return rPerp + rParallel;
+}
+
+// FROM https://graphicscompendium.com/raytracing/11-fresnel-beer
+float SchlicksReflectionProbability(vec3 inDir, vec3 normal, float IOR)
+{
+    float F0 = pow((1.0f - IOR) / (1.0f + IOR), 2.0f);
+    return F0 + (1.0f - F0) * pow((1.0f - dot(normal, inDir)), 5.0f);
+}
+
+struct SurfaceSample
+{
+    vec3 colour;
+    float roughness;
+    float emission;
+};
+
+// MATERIAL VALUES AT A HIT, WITH ALBEDO AND ROUGHNESS TEXTURES APPLIED
+SurfaceSample EvaluateSurface(Material material, vec2 uv)
+{
+    SurfaceSample surface;
+
+    // IF MATERIAL HAS AN ALBEDO TEXTURE
+    if ((material.textureFlags & (1 << 0)) != 0) { 
+        vec3 albedo = SampleMaterialTexture(material.albedoHandle, uv).xyz;
+        surface.colour = albedo * material.colour;
+    }
+    else {
+        surface.colour = material.colour;
+    }
+
+    // IF MATERIAL HAS A ROUGHNESS TEXTURE
+    if ((material.textureFlags & (1 << 2)) != 0) { 
+        surface.roughness = material.roughness * SampleMaterialTexture(material.roughnessHandle, uv).x;
+    }
+    else {
+        surface.roughness = material.roughness;
+    }
+
+    surface.emission = material.emission;
+    return surface;
+}
+
+// BOUNCES THE RAY OFF OR THROUGH THE SURFACE, RETURNS TRUE IF IT REFRACTED
+bool ScatterRay(inout Ray ray, vec3 hitPos, vec3 hitNormal, bool frontFace, Material material, float roughness, uint seed, uint b)
+{
+    bool refracted = false;
+    if (material.refractive == 1)
+    {
+        float reflectProbability = SchlicksReflectionProbability(ray.dir, -hitNormal, material.IOR);
+        float random = Random(seed + b + 534805);
+        if (random > reflectProbability)
+        {
+            // FROM RAY TRACING IN A WEEKEND https://raytracing.github.io/books/RayTracingInOneWeekend.html#dielectrics/refraction
+            float eta = frontFace ? 1.0 / material.IOR : material.IOR;
+            float cosTheta = min(dot(ray.dir, hitNormal), 1.0f);
+            float sinTheta = sqrt(1.0f - cosTheta * cosTheta);
+            refracted = eta * sinTheta < 1.0f;
+
+            // REFRACT RAY
+            if (refracted)
+            {
+                vec3 refractDir = Refract(-ray.dir, hitNormal, eta, cosTheta);
+                vec3 roughRefractDir = RandomHemisphereDirectionCosine(refractDir, seed + b);
+                ray.origin = hitPos - hitNormal * 0.00001f;
+                ray.dir = normalize(roughRefractDir * roughness + refractDir * (1.0f - roughness));
+            }
+        }
+    }
+    
+    // REFLECT RAY
+    if (!refracted)
+    {
+        vec3 diffuseDir = RandomHemisphereDirectionCosine(hitNormal, seed + b);
+        vec3 specularDir = ray.dir - hitNormal * 2.0f * dot(ray.dir, hitNormal);
+        ray.origin = hitPos - ray.dir * 0.00001f; 
+        ray.dir = normalize(diffuseDir * roughness + specularDir * (1.0f - roughness)); 
+    }
+    return refracted;
+}
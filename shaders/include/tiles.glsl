@@ -0,0 +1,10 @@
+layout(binding = 18) readonly buffer TileGroupBuffer {
+    uint tileGroups[];
+};
+
+// WORK GROUP COORDINATES FROM THE TILE LIST, PACKED AS (Y << 16) | X
+uvec2 TileGroup(uint workGroup)
+{
+    uint tileGroup = tileGroups[workGroup];
+    return uvec2(tileGroup & 0xFFFF, tileGroup >> 16);
+}
@@ -0,0 +1,77 @@
+// PATHS IN FLIGHT FOR THE WAVEFRONT KERNELS, MUST MATCH WAVEFRONT_PATH_CAPACITY ON THE CPU
+#define WAVEFRONT_PATH_CAPACITY 524288
+
+// EACH PATH SENDS AT MOST ONE SHADOW RAY PER LIGHT TYPE PER BOUNCE
+#define SHADOW_SLOTS 3
+
+struct PathState
+{
+    vec3 origin;
+    uint pixelIndex;
+    vec3 dir;
+    uint bounce;
+    vec3 throughput;
+    uint seed;
+    vec3 radiance;
+    uint alive;
+};
+
+struct WavefrontHit
+{
+    vec3 pos;
+    uint materialIndex;
+    vec3 normal;
+    uint frontFace;
+    vec2 uv;
+    uint hit;
+    uint padding;
+};
+
+struct ShadowRay
+{
+    vec3 origin;
+    float maxDist;
+    vec3 dir;
+    uint slot;
+};
+
+layout(binding = 20) buffer PathStateBuffer {
+    PathState paths[];
+};
+
+layout(binding = 21) buffer WavefrontHitBuffer {
+    WavefrontHit hits[];
+};
+
+// TWO QUEUES OF PATH INDICES, ONE READ AND ONE APPENDED TO EACH BOUNCE
+layout(binding = 22) buffer PathQueueBuffer {
+    uint pathQueues[];
+};
+
+layout(binding = 23) buffer ShadowRayBuffer {
+    ShadowRay shadowRays[];
+};
+
+// UNOCCLUDED LIGHT PER SHADOW SLOT, ZEROED BY THE SHADOW KERNEL WHEN BLOCKED
+layout(binding = 24) buffer ShadowLightBuffer {
+    vec4 shadowLight[];
+};
+
+// COUNTS AND INDIRECT DISPATCH ARGUMENTS, ALSO BOUND AS GL_DISPATCH_INDIRECT_BUFFER
+layout(binding = 25) buffer WavefrontCounterBuffer {
+    uint queueCounts[2];
+    uint shadowCount;
+    uint counterPadding;
+    uint activeArgs[3];
+    uint activePadding;
+    uint shadowArgs[3];
+    uint shadowPadding;
+};
+
+// QUEUE READ THIS BOUNCE, THE OTHER ONE IS APPENDED TO
+layout(location = 0) uniform uint u_queue;
+
+// PER GROUP ERRORS AS UINT BITS SO PIXELS FROM ANY PATH CAN atomicMax INTO THEM
+layout(binding = 19) buffer GroupErrorBuffer {
+    uint groupErrorBits[];
+};
@@ -0,0 +1,120 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+#include "include/scene.glsl"
+#include "include/random.glsl"
+#include "include/camera.glsl"
+#include "include/accumulate.glsl"
+#include "include/gbuffer.glsl"
+
+// HISTORY IS PING-PONGED, ALPHA HOLDS THE NUMBER OF FRAMES BLENDED INTO IT
+layout (binding = 4, rgba16f) uniform readonly image2D historyImage;
+layout (binding = 5, rgba16f) uniform writeonly image2D resolvedImage;
+
+// DISTANCE FROM THE CAMERA TO THE FIRST HIT OF THE FRAME EACH HISTORY BELONGS TO
+layout (binding = 6, r32f) uniform readonly image2D historyDepthImage;
+layout (binding = 7, r32f) uniform writeonly image2D resolvedDepthImage;
+
+// CAMERA AND RENDERED AREA OF THE FRAME THE HISTORY WAS RESOLVED FOR
+layout(location = 0) uniform vec3 u_prevPos;
+layout(location = 1) uniform vec3 u_prevForward;
+layout(location = 2) uniform vec3 u_prevRight;
+layout(location = 3) uniform vec3 u_prevUp;
+layout(location = 4) uniform float u_prevFOV;
+layout(location = 5) uniform uvec2 u_prevSize;
+layout(location = 6) uniform uint u_historyValid;
+layout(location = 7) uniform float u_maxHistory;
+
+// HISTORY FURTHER THAN THIS FRACTION OF ITS DISTANCE FROM THE SURFACE IS DISOCCLUDED
+#define DEPTH_TOLERANCE 0.05f
+
+// WIDTH OF THE NEIGHBOURHOOD COLOUR BOX IN STANDARD DEVIATIONS
+#define CLAMP_GAMMA 1.25f
+
+// INVERSE OF PixelRayPos FOR THE PREVIOUS CAMERA, FALSE BEHIND IT
+bool ProjectToPrevious(vec3 worldPos, out vec2 pixel)
+{
+    vec3 offset = worldPos - u_prevPos;
+    float z = dot(offset, u_prevForward);
+    if (z <= 0.0f) return false;
+
+    float planeHeight = tan(DegreesToRadians(u_prevFOV) * 0.5f);
+    float planeWidth = planeHeight * float(u_prevSize.x) / float(u_prevSize.y);
+    float nx = -dot(offset, u_prevRight) / z / planeWidth + 0.5f;
+    float ny = dot(offset, u_prevUp) / z / planeHeight + 0.5f;
+    pixel = vec2(nx * (float(u_prevSize.x) - 1.0f), ny * (float(u_prevSize.y) - 1.0f));
+    return true;
+}
+
+// BILINEAR HISTORY FETCH, TAPS FROM A DIFFERENT SURFACE ARE DROPPED AND THE REST REWEIGHTED
+bool SampleHistory(vec2 pixel, float expectedDepth, out vec4 history)
+{
+    vec2 base = floor(pixel);
+    vec2 f = pixel - base;
+    vec4 sum = vec4(0.0f);
+    float weightSum = 0.0f;
+    for (int t=0; t<4; t++)
+    {
+        ivec2 offset = ivec2(t & 1, t >> 1);
+        ivec2 tap = ivec2(base) + offset;
+        if (tap.x < 0 || tap.y < 0 || tap.x >= int(u_prevSize.x) || tap.y >= int(u_prevSize.y)) continue;
+
+        float depth = imageLoad(historyDepthImage, tap).x;
+        if (abs(depth - expectedDepth) > expectedDepth * DEPTH_TOLERANCE) continue;
+
+        float weight = (offset.x == 1 ? f.x : 1.0f - f.x) * (offset.y == 1 ? f.y : 1.0f - f.y);
+        sum += imageLoad(historyImage, tap) * weight;
+        weightSum += weight;
+    }
+
+    if (weightSum < 0.01f) return false;
+    history = sum / weightSum;
+    return true;
+}
+
+// BLENDS THIS FRAME'S PREVIEW WITH THE REPROJECTED HISTORY AND WRITES THE DISPLAY IMAGE
+void main()
+{
+    uint width = u_renderWidth;
+    uint height = u_renderHeight;
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x >= int(width) || pixel.y >= int(height)) return;
+
+    vec3 current = imageLoad(renderImage, pixel).xyz;
+    // WORLD POSITION OF THE FIRST HIT ALONG THE PIXEL'S CENTRE RAY
+    float depth = LoadFirstHit(pixel).distance;
+    vec3 pixelDir = normalize(PixelRayPos(pixel.x, pixel.y, width, height, 0, false) - cameraInfo.pos);
+    vec3 worldPos = cameraInfo.pos + pixelDir * depth;
+
+    // MEAN AND SPREAD OF THE 3x3 NEIGHBOURHOOD BOUND WHAT THE HISTORY MAY STILL CONTRIBUTE
+    vec3 mean = vec3(0.0f);
+    vec3 meanSquared = vec3(0.0f);
+    for (int y=-1; y<=1; y++) for (int x=-1; x<=1; x++)
+    {
+        ivec2 tap = clamp(pixel + ivec2(x, y), ivec2(0), ivec2(width - 1, height - 1));
+        vec3 colour = imageLoad(renderImage, tap).xyz;
+        mean += colour;
+        meanSquared += colour * colour;
+    }
+    mean /= 9.0f;
+    vec3 sigma = sqrt(max(meanSquared / 9.0f - mean * mean, 0.0f));
+
+    // DISOCCLUDED OR OFF SCREEN PIXELS START A NEW HISTORY
+    vec3 resolved = current;
+    float historyLength = 1.0f;
+    vec2 previousPixel;
+    vec4 history;
+    if (u_historyValid == 1 && ProjectToPrevious(worldPos, previousPixel) && SampleHistory(previousPixel, length(worldPos - u_prevPos), history))
+    {
+        vec3 clampedHistory = clamp(history.xyz, mean - sigma * CLAMP_GAMMA, mean + sigma * CLAMP_GAMMA);
+        historyLength = min(history.w + 1.0f, u_maxHistory);
+        resolved = mix(clampedHistory, current, 1.0f / historyLength);
+    }
+
+    imageStore(resolvedImage, pixel, vec4(resolved, historyLength));
+    imageStore(resolvedDepthImage, pixel, vec4(depth, 0.0f, 0.0f, 0.0f));
+    imageStore(displayImage, pixel, vec4(ACES(resolved), 1.0f));
+}
@@ -7,6 +7,13 @@ in vec3 FragPos;
 in vec3 FragNormal;
 in vec2 FragUV;
 
+// SEE TextureHandle IN include/scene.glsl
+#ifdef GL_ARB_bindless_texture
+#define TextureHandle uint64_t
+#else
+#define TextureHandle uvec2
+#endif
+
 struct Material
 {
     vec3 colour;
@@ -14,9 +21,9 @@ struct Material
     float emission;
     float IOR;
     int refractive;
-    uint64_t albedoHandle;
-    uint64_t normalHandle;
-    uint64_t roughnessHandle;
+    TextureHandle albedoHandle;
+    TextureHandle normalHandle;
+    TextureHandle roughnessHandle;
     uint textureFlags;
 };
 
@@ -45,10 +52,12 @@ void main()
 
     // SURFACE COLOUR
     vec3 surfaceColour = material.colour; 
+#ifdef GL_ARB_bindless_texture
     if ((material.textureFlags & (1 << 0)) != 0)
     {
         surfaceColour = material.colour * texture(sampler2D(material.albedoHandle), FragUV).xyz;
     }
+#endif
     
     // EMITTED LIGHT
     vec3 emittedLight = surfaceColour * material.emission;
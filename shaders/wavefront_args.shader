@@ -0,0 +1,33 @@
+#version 440 core
+
+layout (local_size_x = 1) in;
+
+#include "include/wavefront.glsl"
+
+// 0 PREPARES THE QUEUE u_queue FOR EXTEND/SHADE/COMPACT, 1 PREPARES THE SHADOW RAYS
+layout(location = 1) uniform uint u_argsMode;
+
+// TURNS QUEUE COUNTS INTO INDIRECT DISPATCH SIZES FOR 64 WIDE KERNELS
+void main()
+{
+    if (u_argsMode == 0)
+    {
+        uint count = min(queueCounts[u_queue], WAVEFRONT_PATH_CAPACITY);
+        queueCounts[u_queue] = count;
+        activeArgs[0] = (count + 63) / 64;
+        activeArgs[1] = 1;
+        activeArgs[2] = 1;
+
+        // THE OTHER QUEUE AND THE SHADOW RAYS ARE REFILLED THIS BOUNCE
+        queueCounts[1 - u_queue] = 0;
+        shadowCount = 0;
+    }
+    else
+    {
+        uint count = min(shadowCount, WAVEFRONT_PATH_CAPACITY * SHADOW_SLOTS);
+        shadowCount = count;
+        shadowArgs[0] = (count + 63) / 64;
+        shadowArgs[1] = 1;
+        shadowArgs[2] = 1;
+    }
+}
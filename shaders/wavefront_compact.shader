@@ -0,0 +1,46 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 64) in;
+
+#define SCENE_NO_GEOMETRY
+#define SCENE_NO_LIGHTS
+#include "include/scene.glsl"
+#include "include/accumulate.glsl"
+#include "include/wavefront.glsl"
+
+// ADDS UNBLOCKED DIRECT LIGHT, THEN MOVES LIVE PATHS TO THE NEXT QUEUE AND WRITES FINISHED ONES TO THE IMAGE
+void main()
+{
+    uint queueIndex = gl_GlobalInvocationID.x;
+    if (queueIndex >= queueCounts[u_queue]) return;
+
+    uint pathIndex = pathQueues[u_queue * WAVEFRONT_PATH_CAPACITY + queueIndex];
+    uint slot = pathIndex * SHADOW_SLOTS;
+
+    vec3 radiance = paths[pathIndex].radiance;
+    for (uint s=0; s<SHADOW_SLOTS; s++) radiance += shadowLight[slot + s].xyz;
+
+    if (paths[pathIndex].alive == 1)
+    {
+        paths[pathIndex].radiance = radiance;
+        uint nextQueue = 1 - u_queue;
+        uint nextIndex = atomicAdd(queueCounts[nextQueue], 1u);
+        pathQueues[nextQueue * WAVEFRONT_PATH_CAPACITY + nextIndex] = pathIndex;
+        return;
+    }
+
+    uint width = u_renderWidth;
+    uint pixelIndex = paths[pathIndex].pixelIndex;
+    uint pX = pixelIndex % width;
+    uint pY = pixelIndex / width;
+
+    vec3 colour = radiance * cameraInfo.exposure;
+    float luminance = Luminance(colour);
+    float error = AccumulatePixel(pX, pY, colour, luminance * luminance, 1.0f);
+
+    // WRITE GROUP ERROR FOR THE ADAPTIVE SCHEDULER
+    uint groupsX = (width + 32) / 32;
+    atomicMax(groupErrorBits[(pY / 32) * groupsX + (pX / 32)], floatBitsToUint(error));
+}
@@ -0,0 +1,36 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 64) in;
+
+#define SCENE_NO_LIGHTS
+#include "include/scene.glsl"
+#include "include/intersect.glsl"
+#include "include/wavefront.glsl"
+#include "include/stats.glsl"
+
+// FINDS THE NEXT HIT FOR EVERY PATH IN THE QUEUE
+void main()
+{
+    BeginRayStats();
+
+    uint queueIndex = gl_GlobalInvocationID.x;
+    if (queueIndex < queueCounts[u_queue])
+    {
+        uint pathIndex = pathQueues[u_queue * WAVEFRONT_PATH_CAPACITY + queueIndex];
+
+        Ray ray;
+        ray.origin = paths[pathIndex].origin;
+        ray.dir = paths[pathIndex].dir;
+        RayHit hit = CastRay(ray);
+
+        hits[pathIndex].pos = hit.pos;
+        hits[pathIndex].materialIndex = hit.materialIndex;
+        hits[pathIndex].normal = hit.normal;
+        hits[pathIndex].frontFace = hit.frontFace ? 1u : 0u;
+        hits[pathIndex].uv = hit.uv;
+        hits[pathIndex].hit = hit.hit ? 1u : 0u;
+    }
+    EndRayStats();
+}
@@ -0,0 +1,62 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 32, local_size_y = 32) in;
+
+#define SCENE_NO_GEOMETRY
+#define SCENE_NO_LIGHTS
+#include "include/scene.glsl"
+#include "include/random.glsl"
+#include "include/camera.glsl"
+#include "include/accumulate.glsl"
+#include "include/tiles.glsl"
+#include "include/wavefront.glsl"
+
+// FIRST TILE GROUP OF THIS CHUNK, BATCHES LARGER THAN THE PATH CAPACITY RUN IN CHUNKS
+layout(location = 2) uniform uint u_groupOffset;
+
+// WRITES A CAMERA PATH FOR EVERY PIXEL OF THE TILE GROUPS INTO QUEUE 0
+void main()
+{
+    // RENDERED AREA, THE IMAGES CAN BE LARGER WHILE NAVIGATING
+    uint width = u_renderWidth;
+    uint height = u_renderHeight;
+
+    // GET WORK GROUP FROM THE TILE LIST
+    uvec2 group = TileGroup(gl_WorkGroupID.x + u_groupOffset);
+
+    // GET PIXEL COORDINATES
+    uint pX = gl_LocalInvocationID.x + 32 * group.x;
+    uint pY = gl_LocalInvocationID.y + 32 * group.y;
+
+    // PATHS atomicMax THEIR PIXEL ERROR INTO THE GROUP WHEN THEY FINISH
+    if (gl_LocalInvocationIndex == 0)
+    {
+        uint groupsX = (width + 32) / 32;
+        groupErrorBits[group.y * groupsX + group.x] = 0;
+    }
+
+    if (pX >= width || pY >= height) return;
+
+    uint pixelIndex = pY * width + pX;
+
+    // GENERATE A PSEUDORANDOM SEED
+    uint seed = u_frameCount * width * height + pixelIndex;
+
+    // CREATE CAMERA RAY FOR THIS PIXEL
+    Ray camRay = CameraRay(pX, pY, width, height, seed);
+
+    uint pathIndex = atomicAdd(queueCounts[0], 1u);
+    if (pathIndex >= WAVEFRONT_PATH_CAPACITY) return;
+
+    paths[pathIndex].origin = camRay.origin;
+    paths[pathIndex].pixelIndex = pixelIndex;
+    paths[pathIndex].dir = camRay.dir;
+    paths[pathIndex].bounce = 0;
+    paths[pathIndex].throughput = vec3(1.0f, 1.0f, 1.0f);
+    paths[pathIndex].seed = seed;
+    paths[pathIndex].radiance = vec3(0.0f, 0.0f, 0.0f);
+    paths[pathIndex].alive = 1;
+    pathQueues[pathIndex] = pathIndex;
+}
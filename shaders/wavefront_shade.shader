@@ -0,0 +1,117 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 64) in;
+
+#define SCENE_NO_GEOMETRY
+#include "include/scene.glsl"
+#include "include/random.glsl"
+#include "include/lights.glsl"
+#include "include/surface.glsl"
+#include "include/wavefront.glsl"
+#include "include/gbuffer.glsl"
+
+// QUEUES A SHADOW RAY, THE LIGHT IS ADDED TO THE PATH BY THE COMPACT KERNEL UNLESS IT IS BLOCKED
+void EmitShadowRay(uint slot, Ray ray, float maxDist, vec3 light)
+{
+    uint shadowIndex = atomicAdd(shadowCount, 1u);
+    shadowRays[shadowIndex].origin = ray.origin;
+    shadowRays[shadowIndex].maxDist = maxDist;
+    shadowRays[shadowIndex].dir = ray.dir;
+    shadowRays[shadowIndex].slot = slot;
+    shadowLight[slot] = vec4(light, 0.0f);
+}
+
+// PICKS ONE LIGHT OF THE TYPE, SCALING BY THE COUNT KEEPS THE ESTIMATE UNBIASED
+int PickLight(uint count, uint seed)
+{
+    return int(min(uint(Random(seed) * float(count)), count - 1));
+}
+
+// APPLIES THE SURFACE AT EACH HIT, QUEUES DIRECT LIGHT SHADOW RAYS AND SCATTERS THE PATH
+void main()
+{
+    uint queueIndex = gl_GlobalInvocationID.x;
+    if (queueIndex >= queueCounts[u_queue]) return;
+
+    uint pathIndex = pathQueues[u_queue * WAVEFRONT_PATH_CAPACITY + queueIndex];
+    uint slot = pathIndex * SHADOW_SLOTS;
+    for (uint s=0; s<SHADOW_SLOTS; s++) shadowLight[slot + s] = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+
+    vec3 throughput = paths[pathIndex].throughput;
+    uint b = paths[pathIndex].bounce;
+    uint seed = paths[pathIndex].seed;
+
+    // CAMERA RAYS RECORD WHERE THEY LANDED
+    uint pixelIndex = paths[pathIndex].pixelIndex;
+    uint pX = pixelIndex % u_renderWidth;
+    uint pY = pixelIndex / u_renderWidth;
+
+    // SKY ENDS THE PATH
+    if (hits[pathIndex].hit == 0)
+    {
+        if (b == 0) StoreFirstHit(pX, pY, PackSkyHit());
+        paths[pathIndex].radiance += throughput * u_skyColour * u_skyBrightness;
+        paths[pathIndex].alive = 0;
+        return;
+    }
+
+    vec3 hitPos = hits[pathIndex].pos;
+    vec3 hitNormal = hits[pathIndex].normal;
+    bool frontFace = hits[pathIndex].frontFace == 1;
+
+    const Material material = materials[hits[pathIndex].materialIndex];
+    SurfaceSample surface = EvaluateSurface(material, hits[pathIndex].uv);
+    if (b == 0) StoreFirstHit(pX, pY, PackFirstHit(length(hitPos - cameraInfo.pos), hitNormal, surface.colour));
+
+    // ACCUMULATE EMITTED LIGHT
+    throughput *= surface.colour;
+    paths[pathIndex].radiance += throughput * surface.emission;
+
+    // PREPARE FOR NEXT BOUNCE
+    Ray ray;
+    ray.origin = paths[pathIndex].origin;
+    ray.dir = paths[pathIndex].dir;
+    bool refracted = ScatterRay(ray, hitPos, hitNormal, frontFace, material, surface.roughness, seed, b);
+
+    // CALCULATE EXPLICIT LIGHT CONTRIBUTIONS
+    if (frontFace && !refracted)
+    {
+        uint lightSeed = seed + b * 10;
+        Ray shadowRay;
+        float lightDist;
+        vec3 light;
+
+        if (u_directionalLightCount > 0)
+        {
+            int d = PickLight(u_directionalLightCount, lightSeed);
+            if (SampleDirectionalLight(d, hitPos, hitNormal, surface.roughness, lightSeed, shadowRay, lightDist, light))
+                EmitShadowRay(slot + 0, shadowRay, lightDist, throughput * light * float(u_directionalLightCount));
+        }
+
+        if (u_pointLightCount > 0)
+        {
+            int p = PickLight(u_pointLightCount, lightSeed + 1);
+            if (SamplePointLight(p, hitPos, hitNormal, surface.roughness, lightSeed, shadowRay, lightDist, light))
+                EmitShadowRay(slot + 1, shadowRay, lightDist, throughput * light * float(u_pointLightCount));
+        }
+
+        if (u_spotlightCount > 0)
+        {
+            int s = PickLight(u_spotlightCount, lightSeed + 2);
+            if (SampleSpotlight(s, hitPos, hitNormal, surface.roughness, lightSeed, shadowRay, lightDist, light))
+                EmitShadowRay(slot + 2, shadowRay, lightDist, throughput * light * float(u_spotlightCount));
+        }
+    }
+
+    // PATHS THAT CAN NO LONGER CARRY LIGHT STOP EARLY
+    uint maxBounce = u_debugMode == 1 ? 0 : u_bounces;
+    bool carriesLight = max(max(throughput.x, throughput.y), throughput.z) > 0.0f;
+
+    paths[pathIndex].origin = ray.origin;
+    paths[pathIndex].dir = ray.dir;
+    paths[pathIndex].throughput = throughput;
+    paths[pathIndex].bounce = b + 1;
+    paths[pathIndex].alive = (b < maxBounce && carriesLight) ? 1u : 0u;
+}
@@ -0,0 +1,29 @@
+#version 440 core
+#extension GL_ARB_bindless_texture : enable
+#extension GL_NV_gpu_shader5 : enable
+
+layout (local_size_x = 64) in;
+
+#define SCENE_NO_LIGHTS
+#include "include/scene.glsl"
+#include "include/intersect.glsl"
+#include "include/wavefront.glsl"
+#include "include/stats.glsl"
+
+// CLEARS THE LIGHT OF EVERY QUEUED SHADOW RAY THAT IS BLOCKED
+void main()
+{
+    BeginRayStats();
+
+    uint shadowIndex = gl_GlobalInvocationID.x;
+    if (shadowIndex < shadowCount)
+    {
+        Ray ray;
+        ray.origin = shadowRays[shadowIndex].origin;
+        ray.dir = shadowRays[shadowIndex].dir;
+        vec3 lightPos = ray.origin + ray.dir * shadowRays[shadowIndex].maxDist;
+
+        if (ShadowCast(ray, lightPos)) shadowLight[shadowRays[shadowIndex].slot] = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    EndRayStats();
+}
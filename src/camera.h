@@ -1,12 +1,28 @@
 #pragma once
 #include <GL/glew.h>
 #include "../lib/glm/glm.hpp"
+#include <cstdint>
+
+// CAMERA PART OF THE FRAME CONSTANTS BLOCK, MATCHES CameraInfo IN THE SHADERS (STD140)
+struct CameraConstants
+{
+    alignas(16) glm::vec3 pos;
+    alignas(16) glm::vec3 forward;
+    alignas(16) glm::vec3 right;
+    alignas(16) glm::vec3 up;
+    float FOV;
+    uint32_t DOF;
+    float focusDistance;
+    float aperture;
+    uint32_t antiAliasing;
+    float exposure;
+};
 
 class Camera
 {
 public:
 
-    Camera(unsigned int _pathtraceShader) : pathtraceShader(_pathtraceShader)
+    Camera()
     {
         pos      = glm::vec3(0.0f, 0.0f, 0.0f);
         rotation = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -21,44 +37,49 @@ public:
         exposure = 1.0f;
     }
 
-    void UpdatePathtracerUniforms()
+    CameraConstants GetShaderConstants()
     {
         // RECALCULATE DIRECTION VECTORS
         UpdateCameraVectors();
 
-        // UPDATE UNIFORMS
-        glUniform3f(camInfoPosLocation, pos.x, pos.y, pos.z);
-        glUniform3f(camInfoForwardLocation, forward.x, forward.y, forward.z);
-        glUniform3f(camInfoRightLocation, right.x, right.y, right.z);
-        glUniform3f(camInfoUpLocation, up.x, up.y, up.z);
-        glUniform1f(camInfoFOVLocation, fov);
-        glUniform1ui(cameraInfoDOFLocation, dof? 1 : 0);
-        glUniform1f(cameraInfoFocusDistanceLocation, focus_distance);
-        glUniform1f(cameraInfoApertureLocation, (1 / fov) / fStop);
-        glUniform1ui(cameraInfoAntiAliasingLocation, anti_aliasing);
-        glUniform1f(cameraInfoExposureLocation, exposure);
+        CameraConstants constants;
+        constants.pos = pos;
+        constants.forward = forward;
+        constants.right = right;
+        constants.up = up;
+        constants.FOV = fov;
+        constants.DOF = dof ? 1 : 0;
+        constants.focusDistance = focus_distance;
+        constants.aperture = (1 / fov) / fStop;
+        constants.antiAliasing = anti_aliasing ? 1 : 0;
+        constants.exposure = exposure;
+        return constants;
     }
-
-    void UpdateRaycasterUniforms(unsigned int shader)
+    
+    // FNV-1A HASH OF EVERYTHING THE CAMERA CONTRIBUTES TO THE IMAGE, ACCUMULATED SAMPLES
+    // STAY VALID WHILE IT MATCHES
+    uint64_t GetPoseHash()
     {
-        // RECALCULATE DIRECTION VECTORS
-        UpdateCameraVectors();
-        
-        // GET RAYCASTER SHADER UNIFORM LOCATIONS
-        unsigned int camInfoPosLocation_raycast = glGetUniformLocation(shader, "cameraInfo.pos");
-        unsigned int camInfoForwardLocation_raycast = glGetUniformLocation(shader, "cameraInfo.forward");
-        unsigned int camInfoRightLocation_raycast = glGetUniformLocation(shader, "cameraInfo.right");
-        unsigned int camInfoUpLocation_raycast= glGetUniformLocation(shader, "cameraInfo.up");
-        unsigned int camInfoFOVLocation_raycast = glGetUniformLocation(shader, "cameraInfo.FOV");
+        CameraConstants constants = GetShaderConstants();
+        float values[] = {
+            constants.pos.x, constants.pos.y, constants.pos.z,
+            constants.forward.x, constants.forward.y, constants.forward.z,
+            constants.right.x, constants.right.y, constants.right.z,
+            constants.up.x, constants.up.y, constants.up.z,
+            constants.FOV, static_cast<float>(constants.DOF), constants.focusDistance,
+            constants.aperture, static_cast<float>(constants.antiAliasing), constants.exposure
+        };
 
-        // SET RAYCAST SHADER UNIFORMS
-        glUniform3f(camInfoPosLocation_raycast, pos.x, pos.y, pos.z);
-        glUniform3f(camInfoForwardLocation_raycast, forward.x, forward.y, forward.z);
-        glUniform3f(camInfoRightLocation_raycast, right.x, right.y, right.z);
-        glUniform3f(camInfoUpLocation_raycast, up.x, up.y, up.z);
-        glUniform1f(camInfoFOVLocation_raycast, fov);
+        uint64_t hash = 14695981039346656037ull;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+        for (size_t i=0; i<sizeof(values); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
     }
-    
+
     void UpdateCameraVectors()
     {
         float rotationX = glm::radians(rotation.x);
@@ -114,22 +135,4 @@ public:
     float prev_fov;
     float prev_focus_distance;
     float prev_fStop;
-
-
-private:
-
-    // PATH TRACING SHADER ID
-    unsigned int pathtraceShader;
-
-    // PATH TRACING SHADER CAMERA UNIFORM LOCATIONS
-    unsigned int camInfoPosLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.pos");
-    unsigned int camInfoForwardLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.forward");
-    unsigned int camInfoRightLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.right");
-    unsigned int camInfoUpLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.up");
-    unsigned int camInfoFOVLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.FOV");
-    unsigned int cameraInfoDOFLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.DOF");
-    unsigned int cameraInfoFocusDistanceLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.focusDistance");
-    unsigned int cameraInfoApertureLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.aperture");
-    unsigned int cameraInfoAntiAliasingLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.antiAliasing");
-    unsigned int cameraInfoExposureLocation = glGetUniformLocation(pathtraceShader, "cameraInfo.exposure");
 };
@@ -0,0 +1,255 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+
+// STANDARD LIBRARY
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+// PROJECT HEADERS
+#include "memory_tracker.h"
+
+#define CHECKPOINT_MAGIC 0x4B43524Cu // "LRCK"
+#define CHECKPOINT_VERSION 1
+
+// FILE LAYOUT: THIS HEADER, THEN width * height COLOURS (RGBA32F), MOMENTS (RG32F), FIRST HITS
+// (RGBA32UI) AND DISPLAY PIXELS (RGBA8), THEN groupCount GROUP ERRORS (FLOAT) AND GROUP SAMPLE
+// COUNTS (UINT32). ROWS RUN BOTTOM TO TOP LIKE THE TEXTURES
+struct CheckpointHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key; // SCENE, CAMERA AND RENDER SETTINGS THE SAMPLES BELONG TO
+    int32_t width;
+    int32_t height;
+    uint32_t accumulationFrame;
+    uint32_t frameCount;
+    uint32_t groupCount;
+    uint32_t padding;
+};
+
+// FNV-1A, CHAINED THROUGH hash SO SEVERAL VALUES CAN BE FOLDED INTO ONE KEY
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i=0; i<size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// TEXTURES AND BUFFERS OF THE ACCUMULATION A CHECKPOINT IS TAKEN FROM
+struct CheckpointSources
+{
+    unsigned int renderTexture;
+    unsigned int momentTexture;
+    unsigned int firstHitTexture;
+    unsigned int displayTexture;
+    unsigned int groupErrorBuffer;
+};
+
+// WRITES CHECKPOINTS WITHOUT STALLING THE RENDER LOOP. THE GPU COPIES THE IMAGES INTO A
+// PERSISTENTLY MAPPED PACK BUFFER BEHIND THE WORK ALREADY QUEUED, A FENCE SAYS WHEN THE COPY HAS
+// LANDED AND A THREAD WRITES IT STRAIGHT FROM THE MAPPING TO A TEMPORARY FILE THAT THEN REPLACES
+// THE OLD CHECKPOINT, SO A NODE PRE-EMPTED MID-WRITE STILL LEAVES THE LAST COMPLETE ONE
+class CheckpointWriter
+{
+public:
+
+    ~CheckpointWriter()
+    {
+        Finish();
+        if (packBuffer != 0)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            MemoryTracker::Release("checkpoints", packBuffer);
+            glDeleteBuffers(1, &packBuffer);
+        }
+    }
+
+    // A CAPTURE IS IN FLIGHT ON THE GPU OR BEING WRITTEN
+    bool Busy() const
+    {
+        return fence != nullptr || writing;
+    }
+
+    // QUEUES THE COPIES BEHIND THE PASS THAT JUST ENDED, groupSampleCounts IS COPIED NOW
+    void Capture(const std::string& _path, const CheckpointHeader& _header, const CheckpointSources& sources, const std::vector<uint32_t>& groupSampleCounts)
+    {
+        if (Busy()) return;
+        JoinWriter();
+        path = _path;
+        header = _header;
+        sampleCounts.assign(groupSampleCounts.begin(), groupSampleCounts.end());
+        sampleCounts.resize(header.groupCount, 0);
+
+        size_t pixels = static_cast<size_t>(header.width) * header.height;
+        colourBytes = pixels * 16;
+        momentBytes = pixels * 8;
+        firstHitBytes = pixels * 16;
+        displayBytes = pixels * 4;
+        groupErrorBytes = static_cast<size_t>(header.groupCount) * sizeof(float);
+        AllocatePackBuffer(ImageBytes() + groupErrorBytes);
+
+        // IMAGE STORES OF THE PASS MUST LAND BEFORE THE COPIES READ THEM
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, sources.renderTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, reinterpret_cast<void*>(0));
+        glBindTexture(GL_TEXTURE_2D, sources.momentTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, reinterpret_cast<void*>(colourBytes));
+        glBindTexture(GL_TEXTURE_2D, sources.firstHitTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, reinterpret_cast<void*>(colourBytes + momentBytes));
+        glBindTexture(GL_TEXTURE_2D, sources.displayTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(colourBytes + momentBytes + firstHitBytes));
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, sources.groupErrorBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, packBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, ImageBytes(), groupErrorBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+    }
+
+    // CALLED EVERY FRAME, STARTS THE WRITE ONCE THE GPU HAS FINISHED THE COPIES
+    void Poll()
+    {
+        if (fence == nullptr) return;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+        StartWriter();
+    }
+
+    // BLOCKS UNTIL THE LAST CAPTURE IS ON DISK
+    void Finish()
+    {
+        if (fence != nullptr)
+        {
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+            StartWriter();
+        }
+        JoinWriter();
+    }
+
+    // FALSE IF THE FILE IS MISSING, TRUNCATED OR NOT A CHECKPOINT. payload HOLDS EVERYTHING
+    // AFTER THE HEADER
+    static bool Load(const std::string& filepath, CheckpointHeader& fileHeader, std::vector<uint8_t>& payload)
+    {
+        std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+        std::streamsize fileSize = file.tellg();
+        if (fileSize < static_cast<std::streamsize>(sizeof(CheckpointHeader))) return false;
+
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+        if (fileHeader.magic != CHECKPOINT_MAGIC || fileHeader.version != CHECKPOINT_VERSION || fileHeader.width <= 0 || fileHeader.height <= 0) return false;
+
+        size_t pixels = static_cast<size_t>(fileHeader.width) * fileHeader.height;
+        size_t payloadSize = pixels * (16 + 8 + 16 + 4) + static_cast<size_t>(fileHeader.groupCount) * (sizeof(float) + sizeof(uint32_t));
+        if (static_cast<size_t>(fileSize) != sizeof(CheckpointHeader) + payloadSize) return false;
+
+        payload.resize(payloadSize);
+        file.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payloadSize));
+        return static_cast<bool>(file);
+    }
+
+private:
+    unsigned int packBuffer = 0;
+    size_t packBufferSize = 0;
+    uint8_t* mappedBytes = nullptr;
+    GLsync fence = nullptr;
+    std::thread writer;
+    std::atomic<bool> writing { false };
+
+    std::string path;
+    CheckpointHeader header;
+    std::vector<uint32_t> sampleCounts;
+    size_t colourBytes = 0;
+    size_t momentBytes = 0;
+    size_t firstHitBytes = 0;
+    size_t displayBytes = 0;
+    size_t groupErrorBytes = 0;
+
+    size_t ImageBytes() const
+    {
+        return colourBytes + momentBytes + firstHitBytes + displayBytes;
+    }
+
+    // IMMUTABLE STORAGE, MAPPED ONCE AND REALLOCATED ONLY WHEN THE TARGETS GROW
+    void AllocatePackBuffer(size_t size)
+    {
+        if (size <= packBufferSize) return;
+        if (packBuffer != 0)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            MemoryTracker::Release("checkpoints", packBuffer);
+            glDeleteBuffers(1, &packBuffer);
+        }
+
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &packBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags);
+        mappedBytes = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), flags));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        packBufferSize = size;
+        MemoryTracker::Track("checkpoints", packBuffer, size, size);
+    }
+
+    void StartWriter()
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+        writing = true;
+        writer = std::thread([this]() { Write(); writing = false; });
+    }
+
+    void JoinWriter()
+    {
+        if (writer.joinable()) writer.join();
+    }
+
+    // RUNS ON THE WRITER THREAD, THE MAPPING STAYS UNTOUCHED BY THE GPU UNTIL IT RETURNS
+    void Write()
+    {
+        std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                std::cerr << "[CheckpointWriter] Failed! Could not write checkpoint to: " << temporaryPath << std::endl;
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(mappedBytes), static_cast<std::streamsize>(ImageBytes() + groupErrorBytes));
+            file.write(reinterpret_cast<const char*>(sampleCounts.data()), static_cast<std::streamsize>(sampleCounts.size() * sizeof(uint32_t)));
+            if (!file)
+            {
+                std::cerr << "[CheckpointWriter] Failed! Could not write checkpoint to: " << temporaryPath << std::endl;
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) std::cerr << "[CheckpointWriter] Failed! Could not replace checkpoint: " << path << std::endl;
+    }
+};
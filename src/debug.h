@@ -13,10 +13,11 @@ void PrintGLErrors()
 {
     GLenum error;
     while ((error = glGetError()) != GL_NO_ERROR) {
-        std::cout << "OpenGL Error: " << error << std::endl;
+        std::cerr << "OpenGL Error: " << error << std::endl;
     }
 }
 
+// DIAGNOSTICS GO TO stderr, THE HEADLESS RENDERER KEEPS stdout FOR ITS ONE LINE JSON RESULT
 namespace Debug
 {
     double processTime;
@@ -34,7 +35,7 @@ namespace Debug
     {
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        std::cout << "Duration: " << duration.count() << " microseconds" << std::endl;
+        std::cerr << "Duration: " << duration.count() << " microseconds" << std::endl;
     }
 
     void ResetAccum()
@@ -56,6 +57,6 @@ namespace Debug
 
     void PrintAccum()
     {
-        std::cout << "Accumulated time: " << accumulatedTime / 1e6 << "ms" << std::endl;
+        std::cerr << "Accumulated time: " << accumulatedTime / 1e6 << "ms" << std::endl;
     }
 };
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+// STANDARD LIBRARY
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// EXTERNAL LIBRARIES
+#include "../lib/glm/glm.hpp"
+
+// WHERE THE DISPLAYED IMAGE IS DENOISED, CPU IS USED FOR EXPORTS AND HEADLESS RENDERS
+enum class DenoiseMode
+{
+    Off,
+    GPU,
+    CPU
+};
+
+// COLOUR AND FIRST HIT GUIDES OF ONE IMAGE, EACH CHANNEL IS ITS OWN ROW MAJOR PLANE SO THE
+// FILTER LOOPS RUN OVER CONTIGUOUS FLOATS AND VECTORISE
+struct DenoiseImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> colour[3];
+    std::vector<float> albedo[3];
+    std::vector<float> normal[3];
+    std::vector<float> depth;
+    std::vector<float> variance; // VARIANCE OF THE PIXEL MEAN'S LUMINANCE
+    std::vector<uint8_t> hit;
+
+    void Resize(int imageWidth, int imageHeight)
+    {
+        width = imageWidth;
+        height = imageHeight;
+        size_t pixels = static_cast<size_t>(width) * height;
+        for (int c=0; c<3; c++)
+        {
+            colour[c].assign(pixels, 0.0f);
+            albedo[c].assign(pixels, 1.0f);
+            normal[c].assign(pixels, 0.0f);
+        }
+        depth.assign(pixels, 0.0f);
+        variance.assign(pixels, 0.0f);
+        hit.assign(pixels, 0);
+    }
+};
+
+// CPU VERSION OF shaders/denoise.shader, THE SAME EDGE AVOIDING A-TROUS FILTER ON ALBEDO
+// DEMODULATED ILLUMINATION. ROWS ARE SPLIT ACROSS OPENMP THREADS
+class Denoiser
+{
+public:
+
+    int iterations = 5;
+    float colourSigma = 4.0f;
+    float normalPower = 64.0f;
+    float depthSigma = 0.02f;
+
+    // REPLACES image.colour WITH THE DENOISED COLOUR
+    void Denoise(DenoiseImage& image)
+    {
+        int width = image.width;
+        int height = image.height;
+        size_t pixels = static_cast<size_t>(width) * height;
+        if (pixels == 0) return;
+
+        // DIVIDE OUT THE ALBEDO SO TEXTURE DETAIL ISN'T BLURRED
+        for (int c=0; c<3; c++)
+        {
+            illumination[c].resize(pixels);
+            filtered[c].resize(pixels);
+            float* input = image.colour[c].data();
+            float* albedo = image.albedo[c].data();
+            float* output = illumination[c].data();
+            #pragma omp parallel for simd
+            for (long long i=0; i<static_cast<long long>(pixels); i++) output[i] = input[i] / std::max(albedo[i], 0.01f);
+        }
+        variance = image.variance;
+        filteredVariance.resize(pixels);
+
+        for (int iteration=0; iteration<iterations; iteration++)
+        {
+            FilterPass(image, 1 << iteration);
+            for (int c=0; c<3; c++) illumination[c].swap(filtered[c]);
+            variance.swap(filteredVariance);
+        }
+
+        for (int c=0; c<3; c++)
+        {
+            float* output = image.colour[c].data();
+            float* albedo = image.albedo[c].data();
+            float* input = illumination[c].data();
+            #pragma omp parallel for simd
+            for (long long i=0; i<static_cast<long long>(pixels); i++) output[i] = input[i] * std::max(albedo[i], 0.01f);
+        }
+    }
+
+private:
+    std::vector<float> illumination[3];
+    std::vector<float> filtered[3];
+    std::vector<float> variance;
+    std::vector<float> filteredVariance;
+
+    static float Luminance(float r, float g, float b)
+    {
+        return r * 0.2126f + g * 0.7152f + b * 0.0722f;
+    }
+
+    void FilterPass(const DenoiseImage& image, int stepSize)
+    {
+        static const float kernel[3] = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+        int width = image.width;
+        int height = image.height;
+
+        #pragma omp parallel for schedule(dynamic, 4)
+        for (int y=0; y<height; y++)
+        {
+            for (int x=0; x<width; x++)
+            {
+                size_t centre = static_cast<size_t>(y) * width + x;
+                float centreLuminance = Luminance(illumination[0][centre], illumination[1][centre], illumination[2][centre]);
+                float luminanceScale = colourSigma * std::sqrt(variance[centre]) + 0.0001f;
+                float centreDepth = image.depth[centre];
+
+                float sumR = 0.0f;
+                float sumG = 0.0f;
+                float sumB = 0.0f;
+                float varianceSum = 0.0f;
+                float weightSum = 0.0f;
+                for (int ky=-2; ky<=2; ky++)
+                {
+                    int tapY = y + ky * stepSize;
+                    if (tapY < 0 || tapY >= height) continue;
+
+                    // TAPS OUTSIDE THE ROW GET ZERO WEIGHT INSTEAD OF A BRANCH SO THE LOOP VECTORISES
+                    #pragma omp simd reduction(+:sumR, sumG, sumB, varianceSum, weightSum)
+                    for (int kx=-2; kx<=2; kx++)
+                    {
+                        int tapX = std::clamp(x + kx * stepSize, 0, width - 1);
+                        float inside = (x + kx * stepSize == tapX) ? 1.0f : 0.0f;
+                        size_t tap = static_cast<size_t>(tapY) * width + tapX;
+
+                        float normalDot = image.normal[0][centre] * image.normal[0][tap] + image.normal[1][centre] * image.normal[1][tap] + image.normal[2][centre] * image.normal[2][tap];
+                        float normalWeight = image.hit[centre] ? std::pow(std::max(normalDot, 0.0f), normalPower) : 1.0f;
+                        float sameSurface = image.hit[centre] == image.hit[tap] ? 1.0f : 0.0f;
+                        float tapDistance = static_cast<float>(std::max(std::abs(kx), std::abs(ky)) * stepSize);
+                        float depthWeight = std::exp(-std::abs(centreDepth - image.depth[tap]) / (depthSigma * centreDepth * tapDistance + 0.0001f));
+                        float tapLuminance = Luminance(illumination[0][tap], illumination[1][tap], illumination[2][tap]);
+                        float colourWeight = std::exp(-std::abs(centreLuminance - tapLuminance) / luminanceScale);
+
+                        float weight = inside * sameSurface * kernel[std::abs(kx)] * kernel[std::abs(ky)] * normalWeight * depthWeight * colourWeight;
+                        sumR += illumination[0][tap] * weight;
+                        sumG += illumination[1][tap] * weight;
+                        sumB += illumination[2][tap] * weight;
+                        varianceSum += variance[tap] * weight * weight;
+                        weightSum += weight;
+                    }
+                }
+
+                // THE CENTRE TAP ALWAYS HAS FULL WEIGHT SO THE SUM IS NEVER ZERO
+                filtered[0][centre] = sumR / weightSum;
+                filtered[1][centre] = sumG / weightSum;
+                filtered[2][centre] = sumB / weightSum;
+                filteredVariance[centre] = varianceSum / (weightSum * weightSum);
+            }
+        }
+    }
+};
+
+// SIMPLIFIED ACES TONE MAPPING, MATCHES ACES IN shaders/include/accumulate.glsl
+inline glm::vec3 ToneMapACES(glm::vec3 colour)
+{
+    glm::vec3 numerator = colour * (2.51f * colour + 0.03f);
+    glm::vec3 denominator = colour * (2.43f * colour + 0.59f) + 0.14f;
+    return glm::clamp(numerator / denominator, 0.0f, 1.0f);
+}
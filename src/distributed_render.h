@@ -0,0 +1,558 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+#include "../lib/glm/glm.hpp"
+
+// STANDARD LIBRARY
+#include <deque>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <initializer_list>
+
+// PROJECT HEADERS
+#include "socket.h"
+#include "camera.h"
+#include "material.h"
+#include "denoiser.h"
+#include "render_system.h"
+#include "image_export.h"
+
+// ONE FINAL FRAME SPLIT ACROSS WORKER PROCESSES. THE COORDINATOR CUTS THE IMAGE INTO REGIONS OF
+// WORK GROUPS (AND OPTIONALLY SAMPLE SLICES), HANDS THEM TO WHICHEVER WORKER IS IDLE AND MERGES
+// THE ACCUMULATED FLOATS THEY SEND BACK. WORKERS SEED FROM THE ABSOLUTE SAMPLE INDEX AND THE FULL
+// FRAME SIZE, SO A REGION RENDERS THE SAME BITS ON ANY WORKER, AND ON A RETRY, AS IT WOULD ON ONE
+// MACHINE. ALL PROCESSES ARE ASSUMED TO SHARE BYTE ORDER, GPU DRIVER AND THE SCENE'S FILES
+
+#define DISTRIBUTED_MESSAGE_MAGIC 0x314C5252u // "RRL1"
+#define DISTRIBUTED_MAX_MESSAGE_SIZE (1ull << 32)
+#define DISTRIBUTED_MAX_ATTEMPTS 3 // A JOB THAT FAILS ON THIS MANY WORKERS FAILS THE FRAME
+#define DISTRIBUTED_RECEIVE_TIMEOUT 60000 // MILLISECONDS A MESSAGE MAY STALL PART WAY THROUGH
+#define DISTRIBUTED_GROUP_SIZE 32 // PIXELS PER WORK GROUP SIDE, MATCHES shaders/pathtrace.shader
+
+enum class DistributedMessage : uint32_t
+{
+    Frame = 1, // COORDINATOR -> WORKER, DistributedFrame THEN THE SCENE PATH
+    Tile = 2, // COORDINATOR -> WORKER, DistributedTile
+    TileResult = 3, // WORKER -> COORDINATOR, DistributedTileResult THEN THE PIXELS
+    Failed = 4, // WORKER -> COORDINATOR, THE ERROR TEXT
+    Finished = 5 // COORDINATOR -> WORKER, NO PAYLOAD
+};
+
+struct DistributedMessageHeader
+{
+    uint32_t magic;
+    uint32_t type;
+    uint64_t size;
+};
+
+// SETTINGS EVERY WORKER RENDERS THE FRAME WITH
+struct DistributedFrame
+{
+    int32_t width;
+    int32_t height;
+    int32_t bounces;
+};
+
+// SAMPLES [firstSample, firstSample + sampleCount) OF A RECTANGLE OF WORK GROUPS
+struct DistributedTile
+{
+    uint32_t jobID;
+    int32_t groupX;
+    int32_t groupY;
+    int32_t groupsWide;
+    int32_t groupsHigh;
+    uint32_t firstSample;
+    uint32_t sampleCount;
+};
+
+// PIXEL RECTANGLE OF A FINISHED TILE, FOLLOWED BY width * height COLOURS (vec4) AND MOMENTS (vec2)
+struct DistributedTileResult
+{
+    uint32_t jobID;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+// ONE PART OF A MESSAGE PAYLOAD
+struct MessagePart
+{
+    const void* data;
+    size_t size;
+};
+
+// HEADER AND PAYLOAD PARTS, SENT BACK TO BACK WITHOUT COPYING THEM INTO ONE BUFFER
+inline bool SendDistributedMessage(Socket& connection, DistributedMessage type, std::initializer_list<MessagePart> parts = {})
+{
+    DistributedMessageHeader header = { DISTRIBUTED_MESSAGE_MAGIC, static_cast<uint32_t>(type), 0 };
+    for (const MessagePart& part : parts) header.size += part.size;
+    if (!connection.SendAll(&header, sizeof(header))) return false;
+    for (const MessagePart& part : parts)
+    {
+        if (part.size > 0 && !connection.SendAll(part.data, part.size)) return false;
+    }
+    return true;
+}
+
+// FALSE ON A CLOSED CONNECTION, A TIMEOUT OR A STREAM THAT ISN'T THIS PROTOCOL
+inline bool ReceiveDistributedMessage(Socket& connection, DistributedMessage& type, std::vector<uint8_t>& payload)
+{
+    DistributedMessageHeader header;
+    if (!connection.ReceiveAll(&header, sizeof(header))) return false;
+    if (header.magic != DISTRIBUTED_MESSAGE_MAGIC || header.size > DISTRIBUTED_MAX_MESSAGE_SIZE) return false;
+
+    type = static_cast<DistributedMessage>(header.type);
+    payload.resize(static_cast<size_t>(header.size));
+    return header.size == 0 || connection.ReceiveAll(payload.data(), payload.size());
+}
+
+class RenderCoordinator
+{
+public:
+
+    // ONE SAMPLE SLICE MERGES TO EXACTLY THE SINGLE MACHINE IMAGE. MORE SLICES SPREAD SMALL FRAMES
+    // OVER MORE WORKERS AND MERGE IN SLICE ORDER, SO THE RESULT STILL NEVER DEPENDS ON WHICH
+    // WORKER FINISHED FIRST
+    RenderCoordinator(const DistributedFrame& _frame, const std::string& _scenePath, uint32_t samples, int tileGroups, int sampleSlices, float _jobTimeout) :
+    frame(_frame),
+    scenePath(_scenePath),
+    jobTimeout(_jobTimeout)
+    {
+        int groupsX = (frame.width + DISTRIBUTED_GROUP_SIZE - 1) / DISTRIBUTED_GROUP_SIZE;
+        int groupsY = (frame.height + DISTRIBUTED_GROUP_SIZE - 1) / DISTRIBUTED_GROUP_SIZE;
+        tileGroups = std::max(tileGroups, 1);
+        slices = std::clamp(sampleSlices, 1, static_cast<int>(std::max(samples, 1u)));
+        totalSamples = std::max(samples, 1u);
+        uint32_t sliceSamples = (totalSamples + slices - 1) / slices;
+        slices = static_cast<int>((totalSamples + sliceSamples - 1) / sliceSamples); // NO EMPTY SLICES
+
+        // SLICES OF ONE REGION ARE ADJACENT SO THE REGION MERGES, AND ITS BUFFERS ARE FREED, EARLY
+        for (int y=0; y<groupsY; y+=tileGroups) for (int x=0; x<groupsX; x+=tileGroups)
+        {
+            for (int s=0; s<slices; s++)
+            {
+                DistributedJob job;
+                job.tile.jobID = static_cast<uint32_t>(jobs.size());
+                job.tile.groupX = x;
+                job.tile.groupY = y;
+                job.tile.groupsWide = std::min(tileGroups, groupsX - x);
+                job.tile.groupsHigh = std::min(tileGroups, groupsY - y);
+                job.tile.firstSample = sliceSamples * s;
+                job.tile.sampleCount = std::min(sliceSamples, totalSamples - sliceSamples * s);
+                jobs.push_back(job);
+                pending.push_back(job.tile.jobID);
+            }
+        }
+
+        size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+        colour.assign(pixels, glm::vec4(0.0f));
+        moments.assign(pixels, glm::vec2(0.0f));
+    }
+
+    // SERVES JOBS UNTIL EVERY REGION IS MERGED, FALSE IF A JOB FAILED ON TOO MANY WORKERS.
+    // WORKERS MAY CONNECT AT ANY POINT, EVEN PART WAY THROUGH THE FRAME
+    bool Run(uint16_t port)
+    {
+        Socket listener = Socket::Listen(port);
+        start = std::chrono::steady_clock::now();
+
+        std::vector<SocketHandle> handles;
+        std::vector<uint8_t> ready;
+        while (completedJobs < jobs.size() && !failed)
+        {
+            // HAND OUT WORK TO IDLE WORKERS
+            for (DistributedWorker& worker : workers)
+            {
+                if (worker.job < 0 && !pending.empty()) AssignJob(worker);
+            }
+
+            // WAIT FOR RESULTS OR NEW WORKERS
+            handles.assign(1, listener.Handle());
+            for (DistributedWorker& worker : workers) handles.push_back(worker.socket.Handle());
+            Socket::WaitReadable(handles, ready, 100);
+
+            if (ready[0]) AcceptWorker(listener);
+            for (size_t i=0; i<workers.size() && i + 1 < ready.size(); i++)
+            {
+                if (ready[i + 1] && workers[i].socket.Valid()) ReadWorker(workers[i]);
+            }
+
+            // A WORKER HOLDING A JOB TOO LONG IS PRESUMED HUNG
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            for (DistributedWorker& worker : workers)
+            {
+                if (worker.job >= 0 && std::chrono::duration<float>(now - worker.jobStart).count() > jobTimeout) DropWorker(worker, "timed out");
+            }
+
+            workers.erase(std::remove_if(workers.begin(), workers.end(), [](const DistributedWorker& worker) { return !worker.socket.Valid(); }), workers.end());
+        }
+
+        // LET THE WORKERS EXIT CLEANLY
+        for (DistributedWorker& worker : workers) SendDistributedMessage(worker.socket, DistributedMessage::Finished);
+        workers.clear();
+        elapsedTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        return !failed;
+    }
+
+    // ACES TONE MAPPED LIKE THE DISPLAY IMAGE, FLIPPED SO ROW 0 IS THE TOP
+    // WORKERS SEND NO GUIDES, SO LINEAR EXPORTS OF A DISTRIBUTED FRAME ONLY HOLD ITS COLOUR
+    bool Save(const std::string& path, const HDRExportOptions& options)
+    {
+        if (IsHDRImagePath(path))
+        {
+            HDRImage image;
+            image.width = frame.width;
+            image.height = frame.height;
+            image.colour.resize(colour.size());
+            for (size_t i=0; i<colour.size(); i++) image.colour[i] = glm::vec3(colour[i].x, colour[i].y, colour[i].z);
+            HDRExportOptions colourOnly = options;
+            colourOnly.aovs = false;
+            return SaveHDRImage(image, path, colourOnly);
+        }
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(frame.width) * frame.height * 4);
+        for (int y=0; y<frame.height; y++) for (int x=0; x<frame.width; x++)
+        {
+            const glm::vec4& linear = colour[static_cast<size_t>(frame.height - 1 - y) * frame.width + x];
+            glm::vec3 mapped = ToneMapACES(glm::vec3(linear.x, linear.y, linear.z));
+            size_t pixel = (static_cast<size_t>(y) * frame.width + x) * 4;
+            pixels[pixel + 0] = static_cast<uint8_t>(mapped.x * 255.0f + 0.5f);
+            pixels[pixel + 1] = static_cast<uint8_t>(mapped.y * 255.0f + 0.5f);
+            pixels[pixel + 2] = static_cast<uint8_t>(mapped.z * 255.0f + 0.5f);
+            pixels[pixel + 3] = 255;
+        }
+
+        int written = stbi_write_png(path.c_str(), frame.width, frame.height, 4, pixels.data(), frame.width * 4);
+        if (!written) std::cerr << "[RenderCoordinator::Save] Failed! Could not write image to: " << path << std::endl;
+        return written != 0;
+    }
+
+    // LARGEST RELATIVE ERROR OF ANY PIXEL, THE SAME ESTIMATE THE PATH TRACER WRITES PER GROUP
+    float GetMaxError() const
+    {
+        float maxError = 0.0f;
+        for (size_t i=0; i<colour.size(); i++)
+        {
+            float sampleCount = moments[i].y;
+            float error = 1.0f;
+            if (sampleCount >= 2.0f)
+            {
+                float mean = colour[i].x * 0.2126f + colour[i].y * 0.7152f + colour[i].z * 0.0722f;
+                float variance = std::max(moments[i].x - mean * mean, 0.0f) * sampleCount / (sampleCount - 1.0f);
+                error = std::sqrt(variance / sampleCount) / (mean + 0.05f);
+            }
+            maxError = std::max(maxError, error);
+        }
+        return maxError;
+    }
+
+    uint32_t GetSampleCount() const
+    {
+        return totalSamples;
+    }
+
+    float GetElapsedTime() const
+    {
+        return elapsedTime;
+    }
+
+    int GetJobCount() const
+    {
+        return static_cast<int>(jobs.size());
+    }
+
+    // WORKERS THAT CONNECTED OVER THE WHOLE FRAME
+    int GetWorkerCount() const
+    {
+        return workersSeen;
+    }
+
+    // JOBS HANDED OUT AGAIN AFTER A WORKER FAILED, DISCONNECTED OR TIMED OUT
+    int GetRetryCount() const
+    {
+        return retries;
+    }
+
+private:
+
+    struct DistributedJob
+    {
+        DistributedTile tile;
+        int attempts = 0;
+        bool done = false;
+        DistributedTileResult rect {};
+        std::vector<glm::vec4> colour;
+        std::vector<glm::vec2> moments;
+    };
+
+    struct DistributedWorker
+    {
+        Socket socket;
+        int job = -1;
+        std::chrono::steady_clock::time_point jobStart;
+    };
+
+    DistributedFrame frame;
+    std::string scenePath;
+    float jobTimeout;
+    int slices = 1;
+    uint32_t totalSamples = 0;
+
+    std::vector<DistributedJob> jobs;
+    std::deque<uint32_t> pending;
+    std::vector<DistributedWorker> workers;
+    size_t completedJobs = 0;
+    bool failed = false;
+    int workersSeen = 0;
+    int retries = 0;
+
+    std::chrono::steady_clock::time_point start;
+    float elapsedTime = 0.0f;
+
+    // MERGED FRAME, ROW 0 AT THE BOTTOM LIKE THE RENDER TEXTURE
+    std::vector<glm::vec4> colour;
+    std::vector<glm::vec2> moments;
+
+    void AcceptWorker(Socket& listener)
+    {
+        DistributedWorker worker;
+        worker.socket = listener.Accept();
+        if (!worker.socket.Valid()) return;
+        worker.socket.SetReceiveTimeout(DISTRIBUTED_RECEIVE_TIMEOUT);
+
+        if (!SendDistributedMessage(worker.socket, DistributedMessage::Frame, { { &frame, sizeof(frame) }, { scenePath.data(), scenePath.size() } })) return;
+        workers.push_back(std::move(worker));
+        workersSeen++;
+    }
+
+    void AssignJob(DistributedWorker& worker)
+    {
+        uint32_t jobID = pending.front();
+        pending.pop_front();
+        DistributedJob& job = jobs[jobID];
+        job.attempts++;
+        worker.job = static_cast<int>(jobID);
+        worker.jobStart = std::chrono::steady_clock::now();
+        if (!SendDistributedMessage(worker.socket, DistributedMessage::Tile, { { &job.tile, sizeof(job.tile) } })) DropWorker(worker, "disconnected");
+    }
+
+    // THE WORKER'S JOB GOES BACK TO THE FRONT OF THE QUEUE FOR THE NEXT IDLE WORKER
+    void DropWorker(DistributedWorker& worker, const std::string& reason)
+    {
+        std::cerr << "[RenderCoordinator] Dropped a worker: " << reason << std::endl;
+        worker.socket.Close();
+        if (worker.job < 0) return;
+
+        DistributedJob& job = jobs[worker.job];
+        worker.job = -1;
+        if (job.attempts >= DISTRIBUTED_MAX_ATTEMPTS)
+        {
+            std::cerr << "[RenderCoordinator] Failed! Job " << job.tile.jobID << " failed on " << job.attempts << " workers" << std::endl;
+            failed = true;
+            return;
+        }
+        pending.push_front(job.tile.jobID);
+        retries++;
+    }
+
+    void ReadWorker(DistributedWorker& worker)
+    {
+        DistributedMessage type;
+        std::vector<uint8_t> payload;
+        if (!ReceiveDistributedMessage(worker.socket, type, payload))
+        {
+            DropWorker(worker, "disconnected");
+            return;
+        }
+
+        if (type == DistributedMessage::Failed)
+        {
+            DropWorker(worker, std::string(payload.begin(), payload.end()));
+            return;
+        }
+
+        if (type != DistributedMessage::TileResult || worker.job < 0 || payload.size() < sizeof(DistributedTileResult))
+        {
+            DropWorker(worker, "unexpected message");
+            return;
+        }
+
+        DistributedTileResult rect {};
+        memcpy(&rect, payload.data(), sizeof(rect));
+        size_t pixels = static_cast<size_t>(std::max(rect.width, 0)) * std::max(rect.height, 0);
+        bool inside = rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= frame.width && rect.y + rect.height <= frame.height;
+        if (rect.jobID != static_cast<uint32_t>(worker.job) || !inside || payload.size() != sizeof(rect) + pixels * (sizeof(glm::vec4) + sizeof(glm::vec2)))
+        {
+            DropWorker(worker, "malformed tile result");
+            return;
+        }
+
+        DistributedJob& job = jobs[worker.job];
+        worker.job = -1;
+        job.rect = rect;
+        job.colour.resize(pixels);
+        job.moments.resize(pixels);
+        memcpy(job.colour.data(), payload.data() + sizeof(rect), pixels * sizeof(glm::vec4));
+        memcpy(job.moments.data(), payload.data() + sizeof(rect) + pixels * sizeof(glm::vec4), pixels * sizeof(glm::vec2));
+        job.done = true;
+        completedJobs++;
+
+        MergeRegion(job.tile.jobID - job.tile.jobID % static_cast<uint32_t>(slices));
+    }
+
+    // ONCE EVERY SLICE OF A REGION IS IN, COMBINE THEM IN SLICE ORDER. ONE SLICE IS COPIED SO THE
+    // FRAME MATCHES A SINGLE MACHINE RENDER BIT FOR BIT
+    void MergeRegion(uint32_t firstJob)
+    {
+        uint32_t lastJob = std::min(firstJob + static_cast<uint32_t>(slices), static_cast<uint32_t>(jobs.size()));
+        for (uint32_t j=firstJob; j<lastJob; j++) if (!jobs[j].done) return;
+
+        const DistributedTileResult& rect = jobs[firstJob].rect;
+        for (int y=0; y<rect.height; y++) for (int x=0; x<rect.width; x++)
+        {
+            size_t source = static_cast<size_t>(y) * rect.width + x;
+            size_t target = static_cast<size_t>(rect.y + y) * frame.width + (rect.x + x);
+            if (lastJob - firstJob == 1)
+            {
+                colour[target] = jobs[firstJob].colour[source];
+                moments[target] = jobs[firstJob].moments[source];
+                continue;
+            }
+
+            // SUMS ARE KEPT IN DOUBLES, THE FIXED ORDER IS WHAT MAKES THEM REPEATABLE
+            double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double sampleCount = 0.0;
+            for (uint32_t j=firstJob; j<lastJob; j++)
+            {
+                const glm::vec4& sliceColour = jobs[j].colour[source];
+                double samples = jobs[j].moments[source].y;
+                sums[0] += sliceColour.x * samples;
+                sums[1] += sliceColour.y * samples;
+                sums[2] += sliceColour.z * samples;
+                sums[3] += jobs[j].moments[source].x * samples;
+                sampleCount += samples;
+            }
+            if (sampleCount <= 0.0) continue;
+            colour[target] = glm::vec4(static_cast<float>(sums[0] / sampleCount), static_cast<float>(sums[1] / sampleCount), static_cast<float>(sums[2] / sampleCount), 1.0f);
+            moments[target] = glm::vec2(static_cast<float>(sums[3] / sampleCount), static_cast<float>(sampleCount));
+        }
+
+        for (uint32_t j=firstJob; j<lastJob; j++)
+        {
+            std::vector<glm::vec4>().swap(jobs[j].colour);
+            std::vector<glm::vec2>().swap(jobs[j].moments);
+        }
+    }
+};
+
+class RenderWorker
+{
+public:
+
+    RenderWorker(Socket& _connection) : connection(_connection)
+    {
+
+    }
+
+    // THE COORDINATOR SENDS THE FRAME SETTINGS AS SOON AS IT ACCEPTS THE CONNECTION
+    bool ReceiveFrame(DistributedFrame& frame, std::string& scenePath)
+    {
+        DistributedMessage type;
+        std::vector<uint8_t> payload;
+        if (!ReceiveDistributedMessage(connection, type, payload) || type != DistributedMessage::Frame || payload.size() < sizeof(DistributedFrame)) return false;
+
+        memcpy(&frame, payload.data(), sizeof(frame));
+        scenePath.assign(payload.begin() + sizeof(frame), payload.end());
+        frameWidth = frame.width;
+        frameHeight = frame.height;
+        return frame.width > 0 && frame.height > 0 && frame.bounces > 0;
+    }
+
+    // THE COORDINATOR HANDS THE WORKER'S JOB TO ANOTHER WORKER
+    void ReportFailure(const std::string& message)
+    {
+        SendDistributedMessage(connection, DistributedMessage::Failed, { { message.data(), message.size() } });
+    }
+
+    // RENDERS TILES UNTIL THE COORDINATOR FINISHES THE FRAME, FALSE IF IT WENT AWAY FIRST
+    bool Serve(RenderSystem& renderSystem, unsigned int pathtraceShader, Camera& camera)
+    {
+        // SAMPLE COUNTS MUST NOT DEPEND ON THE NOISE OF NEIGHBOURING REGIONS
+        renderSystem.adaptiveSampling = false;
+
+        DistributedMessage type;
+        std::vector<uint8_t> payload;
+        std::vector<glm::vec4> colour;
+        std::vector<glm::vec2> moments;
+        while (ReceiveDistributedMessage(connection, type, payload))
+        {
+            if (type == DistributedMessage::Finished) return true;
+
+            DistributedTile tile;
+            if (type != DistributedMessage::Tile || payload.size() != sizeof(tile))
+            {
+                ReportFailure("[RenderWorker] <Error> Unexpected message");
+                return false;
+            }
+            memcpy(&tile, payload.data(), sizeof(tile));
+
+            // PIXELS OF THE REGION, THE LAST GROUPS OF A ROW OR COLUMN CAN HANG OVER THE FRAME
+            DistributedTileResult rect;
+            rect.jobID = tile.jobID;
+            rect.x = tile.groupX * DISTRIBUTED_GROUP_SIZE;
+            rect.y = tile.groupY * DISTRIBUTED_GROUP_SIZE;
+            rect.width = std::min(tile.groupsWide * DISTRIBUTED_GROUP_SIZE, frameWidth - rect.x);
+            rect.height = std::min(tile.groupsHigh * DISTRIBUTED_GROUP_SIZE, frameHeight - rect.y);
+            if (rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0 || tile.sampleCount == 0)
+            {
+                ReportFailure("[RenderWorker] <Error> Tile " + std::to_string(tile.jobID) + " is outside the frame");
+                return false;
+            }
+
+            RenderTile region;
+            region.x = tile.groupX;
+            region.y = tile.groupY;
+            region.width = tile.groupsWide;
+            region.height = tile.groupsHigh;
+            renderSystem.SetRenderRegion(region);
+            renderSystem.firstSample = tile.firstSample;
+
+            RenderJob job;
+            job.targetSamples = tile.sampleCount;
+            job.autoExport = false;
+            RenderJobResult result;
+            renderSystem.StartRenderJob(job);
+            while (!renderSystem.PollRenderJobComplete(result))
+            {
+                renderSystem.PathtraceFrame(pathtraceShader, camera);
+                glFlush();
+            }
+
+            renderSystem.ReadFinalPixels(rect.x, rect.y, rect.width, rect.height, colour, moments);
+            MessagePart colourPart = { colour.data(), colour.size() * sizeof(glm::vec4) };
+            MessagePart momentPart = { moments.data(), moments.size() * sizeof(glm::vec2) };
+            if (!SendDistributedMessage(connection, DistributedMessage::TileResult, { { &rect, sizeof(rect) }, colourPart, momentPart })) return false;
+            tilesRendered++;
+        }
+        return false;
+    }
+
+    int GetTilesRendered() const
+    {
+        return tilesRendered;
+    }
+
+private:
+    Socket& connection;
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int tilesRendered = 0;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+// STANDARD LIBRARY
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// RESOLUTION SCALES ARE KEPT ON A GRID SO SMALL TIMING NOISE CAN'T CAUSE A RESIZE
+#define DYNAMIC_SCALE_STEP 0.0625f
+
+// CLOSED LOOP CONTROL OF NAVIGATION QUALITY. GPU TIMES OF DYNAMIC FRAMES ARE SMOOTHED AND
+// COMPARED TO THE FRAME BUDGET. OVER BUDGET DROPS SAMPLES, THEN BOUNCES, THEN RESOLUTION AND
+// UNDER BUDGET RAISES THEM IN REVERSE. A DEAD BAND AROUND THE BUDGET AND A SETTLE PERIOD AFTER
+// EVERY CHANGE STOP IT OSCILLATING BETWEEN TWO SETTINGS
+class DynamicResolutionController
+{
+public:
+
+    float targetFrameRate = 60.0f;
+    float gpuBudgetFraction = 0.8f; // REST OF THE FRAME IS LEFT FOR THE UI AND PRESENT
+    float minScale = 0.125f;
+    float maxScale = 1.0f;
+    bool adjustBounces = true;
+    bool adjustSamples = false;
+
+    float Scale() const
+    {
+        return scale;
+    }
+
+    uint32_t Bounces() const
+    {
+        return bounces;
+    }
+
+    uint32_t Samples() const
+    {
+        return samples;
+    }
+
+    // SMOOTHED GPU TIME OF RECENT DYNAMIC FRAMES (MILLISECONDS)
+    float FrameTime() const
+    {
+        return smoothedTime;
+    }
+
+    float FrameBudget() const
+    {
+        return 1000.0f / std::max(targetFrameRate, 1.0f) * gpuBudgetFraction;
+    }
+
+    // GPU TIME OF A FRAME RENDERED WITH THE GIVEN SETTINGS, FRAMES FROM OLDER SETTINGS ARE IGNORED
+    void AddFrameTime(float milliseconds, float frameScale, uint32_t frameBounces, uint32_t frameSamples)
+    {
+        if (frameScale != scale || frameBounces != bounces || frameSamples != samples) return;
+        smoothedTime = frameTimeCount == 0 ? milliseconds : smoothedTime + (milliseconds - smoothedTime) * 0.25f;
+        frameTimeCount++;
+    }
+
+    // MOVES ONE SETTING TOWARD THE BUDGET, TRUE WHEN THE RESOLUTION SCALE CHANGED
+    bool Update(uint32_t maxBounces, uint32_t maxSamples)
+    {
+        // USER LIMITS CAN DROP BELOW THE CURRENT SETTINGS AT ANY TIME
+        maxBounces = std::max(maxBounces, 1u);
+        maxSamples = std::max(maxSamples, 1u);
+        ApplySettings(scale, std::min(bounces, maxBounces), std::min(samples, maxSamples));
+        if (!adjustBounces) ApplySettings(scale, maxBounces, samples);
+        if (!adjustSamples) ApplySettings(scale, bounces, 1);
+
+        float clampedScale = Quantize(std::clamp(scale, minScale, maxScale));
+        if (clampedScale != scale)
+        {
+            ApplySettings(clampedScale, bounces, samples);
+            return true;
+        }
+
+        if (frameTimeCount < SETTLE_FRAMES) return false;
+
+        // OVER BUDGET
+        float load = smoothedTime / FrameBudget();
+        if (load > 1.1f)
+        {
+            if (adjustSamples && samples > 1) ApplySettings(scale, bounces, samples / 2);
+            else if (adjustBounces && bounces > 1) ApplySettings(scale, bounces - 1, samples);
+            else return ApplyScale(load, -1.0f);
+        }
+
+        // UNDER BUDGET, THE GAP TO 1.1 IS THE DEAD BAND
+        else if (load < 0.75f)
+        {
+            if (scale < maxScale) return ApplyScale(load, 1.0f);
+            else if (adjustBounces && bounces < maxBounces) ApplySettings(scale, bounces + 1, samples);
+            else if (adjustSamples && samples < maxSamples) ApplySettings(scale, bounces, std::min(samples * 2, maxSamples));
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint32_t SETTLE_FRAMES = 8;
+
+    float scale = 0.25f;
+    uint32_t bounces = 1;
+    uint32_t samples = 1;
+    float smoothedTime = 0.0f;
+    uint32_t frameTimeCount = 0;
+
+    float Quantize(float value)
+    {
+        return std::max(DYNAMIC_SCALE_STEP, std::round(value / DYNAMIC_SCALE_STEP) * DYNAMIC_SCALE_STEP);
+    }
+
+    // NEW SETTINGS START A NEW MEASUREMENT
+    void ApplySettings(float newScale, uint32_t newBounces, uint32_t newSamples)
+    {
+        if (newScale == scale && newBounces == bounces && newSamples == samples) return;
+        scale = newScale;
+        bounces = newBounces;
+        samples = newSamples;
+        frameTimeCount = 0;
+    }
+
+    // FRAME TIME GROWS WITH PIXEL COUNT, SO THE SCALE MOVES BY THE SQUARE ROOT OF THE LOAD. AT
+    // LEAST ONE STEP IN THE REQUESTED DIRECTION AND AT MOST A DOUBLING OR HALVING
+    bool ApplyScale(float load, float direction)
+    {
+        float target = scale * std::clamp(1.0f / std::sqrt(std::max(load, 0.0001f)), 0.5f, 2.0f);
+        float newScale = Quantize(std::clamp(target, minScale, maxScale));
+        if (direction < 0.0f && newScale >= scale) newScale = Quantize(std::max(scale - DYNAMIC_SCALE_STEP, minScale));
+        if (direction > 0.0f && newScale <= scale) newScale = Quantize(std::min(scale + DYNAMIC_SCALE_STEP, maxScale));
+        if (newScale == scale) return false;
+
+        ApplySettings(newScale, bounces, samples);
+        return true;
+    }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+
+// STANDARD LIBRARY
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+// SELECTS WHERE BUFFER STORAGE LIVES, HEADLESS KEEPS EVERYTHING IN CPU MEMORY
+// SO THE MEMORY MANAGERS CAN RUN WITHOUT A GL CONTEXT
+namespace GPUBackend
+{
+    inline bool headless = false;
+
+    // DRIVER LIMITS USED WHEN RUNNING HEADLESS
+    inline uint64_t headlessMaxBlockSize = 1ull << 31;
+    inline uint32_t headlessMaxComputeBlocks = 16;
+    inline uint32_t headlessMaxBindings = 96;
+
+    // LARGEST SSBO THE DRIVER WILL BIND
+    inline uint64_t MaxStorageBlockSize()
+    {
+        if (headless) return headlessMaxBlockSize;
+        GLint64 maxBlockSize = 0;
+        glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+        return static_cast<uint64_t>(maxBlockSize);
+    }
+
+    // STORAGE BLOCKS ONE COMPUTE SHADER MAY DECLARE
+    inline uint32_t MaxComputeStorageBlocks()
+    {
+        if (headless) return headlessMaxComputeBlocks;
+        GLint maxBlocks = 0;
+        glGetIntegerv(GL_MAX_COMPUTE_SHADER_STORAGE_BLOCKS, &maxBlocks);
+        return static_cast<uint32_t>(maxBlocks);
+    }
+
+    // STORAGE BUFFER BINDING POINTS
+    inline uint32_t MaxStorageBindings()
+    {
+        if (headless) return headlessMaxBindings;
+        GLint maxBindings = 0;
+        glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &maxBindings);
+        return static_cast<uint32_t>(maxBindings);
+    }
+}
+
+// FIXED SIZE STORAGE BUFFER, GROWING IS DONE BY ALLOCATING A NEW ONE AND COPYING
+class GPUBuffer
+{
+public:
+    virtual ~GPUBuffer() {}
+
+    virtual void CopyFrom(GPUBuffer* source, uint64_t readOffset, uint64_t writeOffset, uint64_t size) = 0;
+    virtual void* Map(uint64_t offset, uint64_t size) = 0;
+    virtual void Unmap() = 0;
+    virtual void Bind(int binding) = 0;
+
+    uint64_t Size()
+    {
+        return bufferSize;
+    }
+
+protected:
+    uint64_t bufferSize = 0;
+};
+
+class GLBuffer : public GPUBuffer
+{
+public:
+
+    GLBuffer(uint64_t size)
+    {
+        bufferSize = size;
+        glGenBuffers(1, &bufferID);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(bufferSize), nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    }
+
+    ~GLBuffer()
+    {
+        glDeleteBuffers(1, &bufferID);
+    }
+
+    void CopyFrom(GPUBuffer* source, uint64_t readOffset, uint64_t writeOffset, uint64_t size) override
+    {
+        if (size == 0) return;
+        glBindBuffer(GL_COPY_READ_BUFFER, static_cast<GLBuffer*>(source)->bufferID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(readOffset), static_cast<GLintptr>(writeOffset), static_cast<GLsizeiptr>(size));
+    }
+
+    void* Map(uint64_t offset, uint64_t size) override
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+        return glMapBufferRange(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT);
+    }
+
+    void Unmap() override
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    }
+
+    void Bind(int binding) override
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, bufferID);
+    }
+
+private:
+    unsigned int bufferID;
+};
+
+class CPUBuffer;
+
+namespace GPUBackend
+{
+    // HEADLESS BUFFERS BY BINDING POINT, WHAT A SHADER WOULD READ FROM EACH
+    inline std::unordered_map<int, CPUBuffer*> boundCPUBuffers;
+
+    inline CPUBuffer* BoundCPUBuffer(int binding)
+    {
+        auto it = boundCPUBuffers.find(binding);
+        return it == boundCPUBuffers.end() ? nullptr : it->second;
+    }
+}
+
+class CPUBuffer : public GPUBuffer
+{
+public:
+
+    CPUBuffer(uint64_t size) : data(size, 0)
+    {
+        bufferSize = size;
+    }
+
+    ~CPUBuffer()
+    {
+        if (boundBinding != -1 && GPUBackend::BoundCPUBuffer(boundBinding) == this) GPUBackend::boundCPUBuffers.erase(boundBinding);
+    }
+
+    void CopyFrom(GPUBuffer* source, uint64_t readOffset, uint64_t writeOffset, uint64_t size) override
+    {
+        if (size == 0) return;
+        CPUBuffer* cpuSource = static_cast<CPUBuffer*>(source);
+        if (readOffset + size > cpuSource->bufferSize || writeOffset + size > bufferSize)
+            throw std::runtime_error("[CPUBuffer::CopyFrom] <Error> Copy out of range");
+        memmove(data.data() + writeOffset, cpuSource->data.data() + readOffset, size);
+    }
+
+    void* Map(uint64_t offset, uint64_t size) override
+    {
+        if (offset + size > bufferSize)
+            throw std::runtime_error("[CPUBuffer::Map] <Error> Mapped range out of range");
+        return data.data() + offset;
+    }
+
+    void Unmap() override {}
+
+    void Bind(int binding) override
+    {
+        boundBinding = binding;
+        GPUBackend::boundCPUBuffers[binding] = this;
+    }
+
+    // RAW BYTES, WHAT THE GPU WOULD SEE AT THIS BINDING
+    const uint8_t* Data()
+    {
+        return data.data();
+    }
+
+    int BoundBinding()
+    {
+        return boundBinding;
+    }
+
+private:
+    std::vector<uint8_t> data;
+    int boundBinding = -1;
+};
+
+inline GPUBuffer* CreateGPUBuffer(uint64_t size)
+{
+    if (GPUBackend::headless) return new CPUBuffer(size);
+    return new GLBuffer(size);
+}
@@ -1,17 +1,19 @@
 #pragma once 
 
 // EXTERNAL LIBRARIES
-#include <GL/glew.h>
 #include "../lib/glm/gtc/type_ptr.hpp"
 
 // STANDARD LIBRARY
 #include <vector>
 #include <string>
 #include <algorithm> 
+#include <cstdint>
+#include <stdexcept>
 
 // PROJECT HEADERS
+#include "gpu_buffer.h"
+#include "memory_tracker.h"
 #include "mesh.h"
-#include "model_manager.h"
 #include "light.h"
 #include "debug.h"
 
@@ -21,86 +23,80 @@ public:
 
     struct ItemPartition
     {
-        uint32_t start;
-        uint32_t size;
+        uint64_t start;
+        uint64_t size;
         uint32_t id;
     };
 
-    DynamicPoolBuffer(int binding = 0, uint32_t allocatedSpace = 0) : _binding(binding)
+    DynamicPoolBuffer(int binding = 0, uint64_t allocatedSpace = 0, uint64_t maxSize = UINT64_MAX, const char* _memoryTag = "unnamed pool") : _binding(binding), maxBufferSize(maxSize), memoryTag(_memoryTag)
     {
         // SET BUFFER SIZE
         bufferSize = allocatedSpace;
 
         // CREATE EMPTY BUFFER
-        glGenBuffers(1, &bufferID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);  
+        buffer = CreateGPUBuffer(bufferSize);
 
         // SET BINDING POINT
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, bufferID);
+        buffer->Bind(_binding);
+        ReportMemory();
     }
 
     ~DynamicPoolBuffer()
     {
-        glDeleteBuffers(1, &bufferID);
+        delete buffer;
+        MemoryTracker::Release(memoryTag, this);
     }
 
-    void GrowBuffer(uint32_t addSize)
+    DynamicPoolBuffer(const DynamicPoolBuffer&) = delete;
+    DynamicPoolBuffer& operator=(const DynamicPoolBuffer&) = delete;
+
+    void GrowBuffer(uint64_t addSize)
     {
-        // INCREASE BUFFER SIZE
-        uint32_t oldBufferSize = bufferSize;
-        bufferSize = std::max(bufferSize + addSize, bufferSize * 2);
+        // INCREASE BUFFER SIZE (NEVER PAST THE DRIVER LIMIT)
+        uint64_t oldBufferSize = bufferSize;
+        bufferSize = std::min(std::max(bufferSize + addSize, bufferSize * 2), maxBufferSize);
 
         // CREATE A NEW LARGER BUFFER
-        unsigned int newBufferID;
-        glGenBuffers(1, &newBufferID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, newBufferID);
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);  
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, newBufferID);
+        GPUBuffer* newBuffer = CreateGPUBuffer(bufferSize);
 
         // COPY CURRENT DATA INTO LARGER BUFFER
-        glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
-        glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
-        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBufferSize);
+        newBuffer->CopyFrom(buffer, 0, 0, oldBufferSize);
 
         // DELETE CURRENT BUFFER
-        glDeleteBuffers(1, &bufferID);
+        delete buffer;
 
         // UPDATE CURRENT BUFFER
-        bufferID = newBufferID;
+        buffer = newBuffer;
 
         // SET BINDING POINT OF NEW LARGER BUFFER
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, bufferID);
+        buffer->Bind(_binding);
+        ReportMemory();
     }
 
-    void OccupyRegion(uint32_t size, uint32_t id, bool print=false)
+    int64_t OccupyRegion(uint64_t size, uint32_t id, bool print=false)
     {
         ItemPartition itemPartition;
         itemPartition.start = FindAvailableSpace(size);
         itemPartition.size = size;
         itemPartition.id = id;
 
-        if (itemPartitions.size() == 0)
-        {
-            itemPartitions.push_back(itemPartition);
-            return;
-        }
-
         // INSERT ITEM PARTITION IN CORRECT SPOT
+        int insertIndex = itemPartitions.size();
         for (int i=0; i<itemPartitions.size(); i++)
         {
             if (itemPartition.start < itemPartitions[i].start)
             {
-                // INSERT BEFORE
-                itemPartitions.insert(itemPartitions.begin() + i, itemPartition);
-                return;
+                insertIndex = i;
+                break;
             }
         }
+        itemPartitions.insert(itemPartitions.begin() + insertIndex, itemPartition);
 
-        itemPartitions.push_back(itemPartition);
+        ReportMemory();
+        return itemPartition.start;
     }
 
-    int FindAvailableSpace(uint32_t size)
+    int64_t FindAvailableSpace(uint64_t size)
     {
         if (size > bufferSize) return -1;
 
@@ -111,22 +107,28 @@ public:
             ItemPartition &item = itemPartitions[i];
             ItemPartition &nextItem = itemPartitions[i + 1];
 
-            uint32_t itemGap = nextItem.start - (item.start + item.size);
+            uint64_t itemGap = nextItem.start - (item.start + item.size);
 
             if (size <= itemGap)
             {
-                return item.start + item.size;  
+                return static_cast<int64_t>(item.start + item.size);  
             }
         }
 
-        ItemPartition &lastItem = itemPartitions[itemPartitions.size()-1];
-        uint32_t nextSpace = lastItem.start + lastItem.size; 
+        uint64_t nextSpace = UsedEnd(); 
 
         if (nextSpace + size > bufferSize) 
         {
             return -1;
         }
-        return nextSpace;
+        return static_cast<int64_t>(nextSpace);
+    }
+
+    // TRUE IF THE REGION FITS NOW OR AFTER GROWING WITHIN THE DRIVER LIMIT
+    bool CanFit(uint64_t size)
+    {
+        if (FindAvailableSpace(size) != -1) return true;
+        return UsedEnd() + size <= maxBufferSize;
     }
 
     void DeleteItem(uint32_t id)
@@ -138,26 +140,34 @@ public:
                 itemPartitions.erase(itemPartitions.begin() + i);
             }
         }
+        ReportMemory();
     }
 
-    void* GetMappedBuffer(int offset, int size)
+    bool ContainsItem(uint32_t id)
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        return glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset, size, GL_MAP_WRITE_BIT);
+        for (const ItemPartition& item : itemPartitions)
+        {
+            if (item.id == id) return true;
+        }
+        return false;
+    }
+
+    void* GetMappedBuffer(uint64_t offset, uint64_t size)
+    {
+        return buffer->Map(offset, size);
     }
 
     void UnmapBuffer()
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER); 
+        buffer->Unmap();
     }
 
-    void DeleteBuffer()
+    GPUBuffer* Buffer()
     {
-        glDeleteBuffers(1, &bufferID);
+        return buffer;
     }
 
-    uint32_t BufferSize()
+    uint64_t BufferSize()
     {
         return bufferSize;
     }
@@ -166,35 +176,119 @@ public:
 
 private:
     int _binding;
-    unsigned int bufferID;
-    uint32_t bufferSize;
+    GPUBuffer* buffer;
+    uint64_t bufferSize;
+    uint64_t maxBufferSize;
+    const char* memoryTag;
+
+    uint64_t UsedEnd()
+    {
+        if (itemPartitions.size() == 0) return 0;
+        ItemPartition &lastItem = itemPartitions[itemPartitions.size()-1];
+        return lastItem.start + lastItem.size;
+    }
+
+    void ReportMemory()
+    {
+        uint64_t usedSize = 0;
+        for (const ItemPartition& item : itemPartitions) usedSize += item.size;
+        MemoryTracker::Track(memoryTag, this, usedSize, bufferSize);
+    }
+};
+
+// SPLITS ONE LOGICAL POOL ACROSS SEVERAL SSBOs SO NO SINGLE BUFFER EXCEEDS THE DRIVER LIMIT
+// PAGE p IS BOUND TO firstBinding + p, MATCHING A BLOCK ARRAY IN THE SHADER
+class PagedPoolBuffer
+{
+public:
+
+    PagedPoolBuffer(int firstBinding, uint32_t pageCount, uint64_t maxPageSize, const char* memoryTag = "unnamed pool")
+    {
+        for (uint32_t p=0; p<pageCount; p++)
+        {
+            pages.push_back(new DynamicPoolBuffer(firstBinding + p, 0, maxPageSize, memoryTag));
+        }
+    }
+
+    ~PagedPoolBuffer()
+    {
+        for (DynamicPoolBuffer* page : pages) delete page;
+    }
+
+    PagedPoolBuffer(const PagedPoolBuffer&) = delete;
+    PagedPoolBuffer& operator=(const PagedPoolBuffer&) = delete;
+
+    bool CanFit(uint32_t page, uint64_t size)
+    {
+        return pages[page]->CanFit(size);
+    }
+
+    uint64_t OccupyRegion(uint32_t page, uint64_t size, uint32_t id)
+    {
+        DynamicPoolBuffer* pool = pages[page];
+        if (pool->FindAvailableSpace(size) == -1) pool->GrowBuffer(size);
+        return static_cast<uint64_t>(pool->OccupyRegion(size, id));
+    }
+
+    void DeleteItem(uint32_t id)
+    {
+        for (DynamicPoolBuffer* page : pages) page->DeleteItem(id);
+    }
+
+    void* GetMappedBuffer(uint32_t page, uint64_t offset, uint64_t size)
+    {
+        return pages[page]->GetMappedBuffer(offset, size);
+    }
+
+    void UnmapBuffer(uint32_t page)
+    {
+        pages[page]->UnmapBuffer();
+    }
+
+    uint32_t PageCount()
+    {
+        return static_cast<uint32_t>(pages.size());
+    }
+
+    uint64_t BufferSize()
+    {
+        uint64_t totalSize = 0;
+        for (DynamicPoolBuffer* page : pages) totalSize += page->BufferSize();
+        return totalSize;
+    }
+
+private:
+    std::vector<DynamicPoolBuffer*> pages;
 };
 
 class DynamicContiguousBuffer
 {
 public:
 
-    DynamicContiguousBuffer(int binding = 0, uint32_t allocatedSpace = 0) : _binding(binding)
+    DynamicContiguousBuffer(int binding = 0, uint64_t allocatedSpace = 0, const char* _memoryTag = "unnamed buffer") : _binding(binding), memoryTag(_memoryTag)
     {
         // SET BUFFER SIZE
         bufferSize = allocatedSpace;
         usedCapacity = 0;
 
         // CREATE EMPTY BUFFER
-        glGenBuffers(1, &bufferID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);  
+        buffer = CreateGPUBuffer(bufferSize);
 
         // SET BINDING POINT
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, bufferID);
+        buffer->Bind(_binding);
+        MemoryTracker::Track(memoryTag, this, usedCapacity, bufferSize);
     }
 
     ~DynamicContiguousBuffer()
     {
-        glDeleteBuffers(1, &bufferID);
+        delete buffer;
+        MemoryTracker::Release(memoryTag, this);
     }
 
-    void GrowBuffer(uint32_t addSize)
+    DynamicContiguousBuffer(const DynamicContiguousBuffer&) = delete;
+    DynamicContiguousBuffer& operator=(const DynamicContiguousBuffer&) = delete;
+
+    void GrowBuffer(uint64_t addSize)
     {
         // GROW BUFFER (ALLOCATE LARGER BUFFER)
         if (usedCapacity + addSize > bufferSize)
@@ -203,87 +297,77 @@ public:
             bufferSize = std::max(bufferSize + addSize, bufferSize * 2);
 
             // CREATE A NEW LARGER BUFFER
-            unsigned int newBufferID;
-            glGenBuffers(1, &newBufferID);
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, newBufferID);
-            glBufferStorage(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);  
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, newBufferID);
+            GPUBuffer* newBuffer = CreateGPUBuffer(bufferSize);
 
             // COPY CURRENT DATA INTO LARGER BUFFER
-            glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
-            glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
-            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedCapacity);
+            newBuffer->CopyFrom(buffer, 0, 0, usedCapacity);
 
             // DELETE CURRENT BUFFER
-            glDeleteBuffers(1, &bufferID);
+            delete buffer;
 
             // UPDATE CURRENT BUFFER
-            bufferID = newBufferID;
+            buffer = newBuffer;
 
             // SET BINDING POINT OF NEW LARGER BUFFER
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, bufferID);
+            buffer->Bind(_binding);
         }
         usedCapacity += addSize;
+        MemoryTracker::Track(memoryTag, this, usedCapacity, bufferSize);
     }
 
-    void DeleteShift(uint32_t start, uint32_t size)
+    void DeleteShift(uint64_t start, uint64_t size)
     {
         // CREATE A NEW BUFFER
-        unsigned int newBufferID;
-        glGenBuffers(1, &newBufferID);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, newBufferID);
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _binding, newBufferID);
+        GPUBuffer* newBuffer = CreateGPUBuffer(bufferSize);
 
         // COPY FIRST PARTITION OF CURRENT DATA INTO NEW BUFFER
-        glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
-        glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
-        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, start);
+        newBuffer->CopyFrom(buffer, 0, 0, start);
 
         // COPY SECOND PARTITION OF CURRENT DATA INTO NEW BUFFER
-        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, start + size, start, usedCapacity - start - size);
+        newBuffer->CopyFrom(buffer, start + size, start, usedCapacity - start - size);
 
         // DELETE CURRENT BUFFER
-        glDeleteBuffers(1, &bufferID);
+        delete buffer;
 
         // UPDATE CURRENT BUFFER
-        bufferID = newBufferID;
+        buffer = newBuffer;
+        buffer->Bind(_binding);
 
         // DECREASE USAGE
         usedCapacity -= size;
+        MemoryTracker::Track(memoryTag, this, usedCapacity, bufferSize);
     }
 
-    void* GetMappedBuffer(int offset, int size)
+    void* GetMappedBuffer(uint64_t offset, uint64_t size)
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        return glMapBufferRange(GL_SHADER_STORAGE_BUFFER, offset, size, GL_MAP_WRITE_BIT);
+        return buffer->Map(offset, size);
     }
 
     void UnmapBuffer()
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID);
-        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER); 
+        buffer->Unmap();
     }
 
-    void DeleteBuffer()
+    GPUBuffer* Buffer()
     {
-        glDeleteBuffers(1, &bufferID);
+        return buffer;
     }
 
-    uint32_t BufferSize()
+    uint64_t BufferSize()
     {
         return bufferSize;
     }
 
-    uint32_t UsedCapacity()
+    uint64_t UsedCapacity()
     {
         return usedCapacity;
     }
 
 private:
     int _binding;
-    unsigned int bufferID;
-    uint32_t bufferSize;
-    uint32_t usedCapacity;
+    GPUBuffer* buffer;
+    uint64_t bufferSize;
+    uint64_t usedCapacity;
+    const char* memoryTag;
 };
 
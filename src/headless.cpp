@@ -0,0 +1,476 @@
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "../lib/glm/glm.hpp"
+#include "../lib/tinyfiledialogs/tinyfiledialogs.h"
+
+// STANDARD LIBRARY
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <filesystem>
+
+// PROJECT HEADERS
+#include "render_system.h"
+#include "shader.h"
+#include "model_manager.h"
+#include "light_manager.h"
+#include "material_manager.h"
+#include "scene_file.h"
+#include "debug.h"
+#include "camera.h"
+#include "material.h"
+#include "distributed_render.h"
+
+// BATCH RENDERER FOR MACHINES WITHOUT A DISPLAY. RENDERS ONE SCENE FILE TO A PNG THROUGH AN
+// OFFSCREEN EGL CONTEXT AND PRINTS ONE JSON LINE OF STATS TO STDOUT. RUN FROM THE BUILD FOLDER
+// SO ./shaders AND ./thumbnail RESOLVE:
+//
+//   rayleak_headless <scene file> [--output render.png] [--width 1920] [--height 1080]
+//                    [--samples 256] [--time <seconds>] [--error <max tile error>]
+//                    [--bounces 3] [--budget <batch milliseconds>] [--denoise] [--wavefront]
+//                    [--checkpoint <file>] [--checkpoint-interval <seconds>]
+//                    [--exr-float] [--exr-compression zip|none] [--no-aovs]
+//
+// AN .exr OR .pfm OUTPUT HOLDS THE LINEAR, UNDENOISED ACCUMULATION WITH ALBEDO, NORMAL, DEPTH
+// AND SAMPLE COUNT AOVS INSTEAD OF THE TONE MAPPED IMAGE
+//
+// WITH --checkpoint THE ACCUMULATION IS SAVED EVERY INTERVAL, AND A RENDER STARTED AGAIN WITH THE
+// SAME ARGUMENTS AFTER BEING KILLED CARRIES ON FROM IT AND FINISHES WITH THE SAME IMAGE
+//
+// ONE FRAME CAN BE SPLIT ACROSS MACHINES. THE COORDINATOR NEEDS NO GPU, WORKERS CONNECT TO IT
+// AND RENDER REGIONS UNTIL THE FRAME IS DONE. EVERY WORKER MUST REACH THE SCENE AT THE SAME PATH:
+//
+//   rayleak_headless <scene file> --coordinator <port> [--output] [--width] [--height] [--samples]
+//                    [--bounces] [--tile <work groups>] [--slices <sample slices>] [--job-timeout <seconds>]
+//   rayleak_headless --worker <host>:<port> [--budget <batch milliseconds>]
+
+// EXIT CODES
+#define EXIT_RENDERED 0
+#define EXIT_BAD_ARGUMENTS 1
+#define EXIT_NO_CONTEXT 2
+#define EXIT_BAD_SCENE 3
+#define EXIT_WRITE_FAILED 4
+#define EXIT_WORKERS_FAILED 5
+#define EXIT_NO_COORDINATOR 6
+
+// WITHOUT A UI TO KEEP RESPONSIVE ONE BATCH MAY KEEP THE GPU BUSY FOR THIS LONG
+#define HEADLESS_RENDER_BUDGET 250.0f
+
+// WORKERS MAY START BEFORE THE COORDINATOR, THEY KEEP TRYING FOR THIS MANY SECONDS
+#define WORKER_CONNECT_TIMEOUT 30.0f
+
+struct HeadlessOptions
+{
+    std::string scenePath;
+    std::string outputPath = "render.png";
+    int width = 1920;
+    int height = 1080;
+    int bounces = 3;
+    float budget = HEADLESS_RENDER_BUDGET;
+    bool denoise = false;
+    bool wavefront = false;
+    RenderJob job;
+
+    // LINEAR EXPORTS
+    HDRExportOptions hdr;
+
+    // CHECKPOINT / RESUME
+    std::string checkpointPath;
+    float checkpointInterval = 300.0f;
+
+    // DISTRIBUTED RENDERING
+    int coordinatorPort = 0;
+    std::string workerAddress;
+    int tileGroups = 8;
+    int sampleSlices = 1;
+    float jobTimeout = 600.0f;
+};
+
+const char* StopReasonName(RenderJobStopReason reason)
+{
+    switch (reason)
+    {
+        case RenderJobStopReason::TargetSamples: return "samples";
+        case RenderJobStopReason::TimeBudget: return "time";
+        case RenderJobStopReason::TargetError: return "error";
+        case RenderJobStopReason::Cancelled: return "cancelled";
+        default: return "none";
+    }
+}
+
+// PATHS MAY HOLD QUOTES, BACKSLASHES (WINDOWS SHARES) OR CONTROL CHARACTERS
+std::string JsonString(const std::string& text)
+{
+    std::string escaped = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\') escaped += std::string("\\") + c;
+        else if (c == '\n') escaped += "\\n";
+        else if (c == '\r') escaped += "\\r";
+        else if (c == '\t') escaped += "\\t";
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+            escaped += code;
+        }
+        else escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// ONE LINE, FLAT KEYS SO RENDER FARM SCRIPTS CAN PARSE IT WITHOUT A JSON LIBRARY
+void PrintResult(const char* status, const HeadlessOptions& options, const RenderJobResult* result, float raysPerSecond, const RenderCoordinator* coordinator = nullptr)
+{
+    std::cout << "{\"status\":\"" << status << "\"";
+    std::cout << ",\"scene\":" << JsonString(options.scenePath);
+    std::cout << ",\"output\":" << JsonString(options.outputPath);
+    std::cout << ",\"width\":" << options.width << ",\"height\":" << options.height;
+    if (result)
+    {
+        std::cout << ",\"reason\":\"" << StopReasonName(result->reason) << "\"";
+        std::cout << ",\"samples\":" << result->samples;
+        std::cout << ",\"seconds\":" << result->elapsedTime;
+        std::cout << ",\"maxError\":" << result->maxError;
+        std::cout << ",\"raysPerSecond\":" << raysPerSecond;
+    }
+    if (coordinator)
+    {
+        std::cout << ",\"workers\":" << coordinator->GetWorkerCount();
+        std::cout << ",\"jobs\":" << coordinator->GetJobCount();
+        std::cout << ",\"retries\":" << coordinator->GetRetryCount();
+    }
+    std::cout << "}" << std::endl;
+}
+
+bool ParseArguments(int argc, char** argv, HeadlessOptions& options)
+{
+    options.job.targetSamples = 0;
+    options.job.autoExport = false;
+    for (int i=1; i<argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--denoise") options.denoise = true;
+        else if (argument == "--wavefront") options.wavefront = true;
+        else if (argument == "--output" && hasValue) options.outputPath = argv[++i];
+        else if (argument == "--width" && hasValue) options.width = std::atoi(argv[++i]);
+        else if (argument == "--height" && hasValue) options.height = std::atoi(argv[++i]);
+        else if (argument == "--samples" && hasValue) options.job.targetSamples = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (argument == "--time" && hasValue) options.job.timeBudget = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--error" && hasValue) options.job.targetError = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--bounces" && hasValue) options.bounces = std::atoi(argv[++i]);
+        else if (argument == "--budget" && hasValue) options.budget = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--coordinator" && hasValue) options.coordinatorPort = std::atoi(argv[++i]);
+        else if (argument == "--worker" && hasValue) options.workerAddress = argv[++i];
+        else if (argument == "--tile" && hasValue) options.tileGroups = std::atoi(argv[++i]);
+        else if (argument == "--slices" && hasValue) options.sampleSlices = std::atoi(argv[++i]);
+        else if (argument == "--exr-float") options.hdr.pixelType = EXRPixelType::Float;
+        else if (argument == "--exr-compression" && hasValue)
+        {
+            std::string compression = argv[++i];
+            if (compression != "zip" && compression != "none") return false;
+            options.hdr.compression = compression == "zip" ? EXRCompression::Zip : EXRCompression::None;
+        }
+        else if (argument == "--no-aovs") options.hdr.aovs = false;
+        else if (argument == "--checkpoint" && hasValue) options.checkpointPath = argv[++i];
+        else if (argument == "--checkpoint-interval" && hasValue) options.checkpointInterval = static_cast<float>(std::atof(argv[++i]));
+        else if (argument == "--job-timeout" && hasValue) options.jobTimeout = static_cast<float>(std::atof(argv[++i]));
+        else if (argument.rfind("--", 0) != 0 && options.scenePath.empty()) options.scenePath = argument;
+        else return false;
+    }
+
+    // A JOB WITHOUT ANY TARGET WOULD NEVER FINISH
+    if (options.job.targetSamples == 0 && options.job.timeBudget <= 0.0f && options.job.targetError <= 0.0f) options.job.targetSamples = 256;
+    options.job.exportPath = options.outputPath;
+
+    // CHECKPOINTS BELONG TO A SINGLE PROCESS RENDER
+    if (!options.checkpointPath.empty() && (options.coordinatorPort != 0 || !options.workerAddress.empty() || options.checkpointInterval < 0.0f)) return false;
+
+    // WORKERS TAKE EVERYTHING ELSE FROM THE COORDINATOR
+    if (!options.workerAddress.empty()) return options.scenePath.empty() && options.coordinatorPort == 0 && options.workerAddress.find(':') != std::string::npos;
+
+    // TIME AND NOISE TARGETS DEPEND ON HOW FAST AND IN WHAT ORDER WORKERS FINISH, A DISTRIBUTED
+    // FRAME ONLY STOPS AT A SAMPLE COUNT
+    if (options.coordinatorPort != 0)
+    {
+        bool deterministic = options.job.timeBudget <= 0.0f && options.job.targetError <= 0.0f && !options.denoise;
+        if (!deterministic || options.coordinatorPort < 0 || options.coordinatorPort > 65535 || options.tileGroups <= 0 || options.sampleSlices <= 0 || options.jobTimeout <= 0.0f) return false;
+    }
+    return !options.scenePath.empty() && options.width > 0 && options.height > 0 && options.bounces > 0;
+}
+
+// SURFACELESS CONTEXT, WORKS ON MESA LLVMPIPE AS WELL AS GPU DRIVERS. MESA'S SURFACELESS PLATFORM
+// NEEDS NO X SERVER, OTHER DRIVERS FALL BACK TO THEIR DEFAULT DISPLAY
+bool CreateOffscreenContext(EGLDisplay& display, EGLContext& context)
+{
+    display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        std::cerr << "[CreateOffscreenContext] Failed! No EGL display" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "[CreateOffscreenContext] Failed! No desktop OpenGL config" << std::endl;
+        return false;
+    }
+
+    // COMPUTE SHADERS, SSBOS AND glClearTexImage NEED 4.4
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 4,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cerr << "[CreateOffscreenContext] Failed! Could not create an OpenGL 4.4 context" << std::endl;
+        return false;
+    }
+
+    // GLEW LOOKS FOR A GLX DISPLAY AFTER LOADING THE CORE FUNCTIONS, THERE IS NONE HERE
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && glewStatus != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        std::cerr << "[CreateOffscreenContext] Failed to initialize GLEW!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DestroyOffscreenContext(EGLDisplay display, EGLContext context)
+{
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+// NO GPU WORK HERE, THE COORDINATOR ONLY SPLITS, COLLECTS AND MERGES
+int RunCoordinator(HeadlessOptions& options)
+{
+    DistributedFrame frame = { options.width, options.height, options.bounces };
+    std::string scenePath = std::filesystem::absolute(options.scenePath).string();
+    RenderCoordinator coordinator(frame, scenePath, options.job.targetSamples, options.tileGroups, options.sampleSlices, options.jobTimeout);
+
+    bool rendered = false;
+    try
+    {
+        rendered = coordinator.Run(static_cast<uint16_t>(options.coordinatorPort));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
+    RenderJobResult result;
+    result.job = options.job;
+    result.reason = rendered ? RenderJobStopReason::TargetSamples : RenderJobStopReason::None;
+    result.samples = rendered ? coordinator.GetSampleCount() : 0;
+    result.elapsedTime = coordinator.GetElapsedTime();
+    result.maxError = rendered ? coordinator.GetMaxError() : 0.0f;
+    if (!rendered)
+    {
+        PrintResult("workers_failed", options, &result, 0.0f, &coordinator);
+        return EXIT_WORKERS_FAILED;
+    }
+    if (!coordinator.Save(options.outputPath, options.hdr))
+    {
+        PrintResult("write_failed", options, &result, 0.0f, &coordinator);
+        return EXIT_WRITE_FAILED;
+    }
+    PrintResult("rendered", options, &result, 0.0f, &coordinator);
+    return EXIT_RENDERED;
+}
+
+// RENDERS REGIONS FOR A COORDINATOR UNTIL ITS FRAME IS DONE
+int RunWorker(HeadlessOptions& options)
+{
+    std::string host = options.workerAddress.substr(0, options.workerAddress.find_last_of(':'));
+    int port = std::atoi(options.workerAddress.substr(options.workerAddress.find_last_of(':') + 1).c_str());
+
+    Socket connection;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (!connection.Valid())
+    {
+        try
+        {
+            connection = Socket::Connect(host, static_cast<uint16_t>(port));
+        }
+        catch (const std::exception& e)
+        {
+            if (std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() > WORKER_CONNECT_TIMEOUT)
+            {
+                std::cerr << e.what() << std::endl;
+                PrintResult("no_coordinator", options, nullptr, 0.0f);
+                return EXIT_NO_COORDINATOR;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+    }
+
+    RenderWorker worker(connection);
+    DistributedFrame frame;
+    if (!worker.ReceiveFrame(frame, options.scenePath))
+    {
+        PrintResult("no_coordinator", options, nullptr, 0.0f);
+        return EXIT_NO_COORDINATOR;
+    }
+    options.width = frame.width;
+    options.height = frame.height;
+    options.bounces = frame.bounces;
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!CreateOffscreenContext(display, context))
+    {
+        worker.ReportFailure("[RenderWorker] <Error> No OpenGL context");
+        PrintResult("no_context", options, nullptr, 0.0f);
+        return EXIT_NO_CONTEXT;
+    }
+    glViewport(0, 0, options.width, options.height);
+
+    SetShaderDefine("GEOMETRY_PAGES", std::to_string(GeometryPageCount()));
+    unsigned int pathtraceShader = CreateComputeShader(LoadShaderFromFile("./shaders/pathtrace.shader"));
+
+    Camera camera;
+    RenderSystem renderSystem(options.width, options.height);
+    renderSystem.SetRenderBudget(options.budget);
+    renderSystem.bounces = options.bounces;
+    ModelManager modelManager;
+    LightManager lightManager;
+    MaterialManager materialManager(pathtraceShader);
+
+    try
+    {
+        SceneFileReader reader(camera, renderSystem, modelManager, lightManager, materialManager);
+        reader.Load(options.scenePath);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        worker.ReportFailure(e.what());
+        PrintResult("bad_scene", options, nullptr, 0.0f);
+        DestroyOffscreenContext(display, context);
+        return EXIT_BAD_SCENE;
+    }
+
+    bool finished = worker.Serve(renderSystem, pathtraceShader, camera);
+    std::cerr << "[RunWorker] Rendered " << worker.GetTilesRendered() << " tiles" << std::endl;
+    PrintResult(finished ? "served" : "no_coordinator", options, nullptr, 0.0f);
+    DestroyOffscreenContext(display, context);
+    return finished ? EXIT_RENDERED : EXIT_NO_COORDINATOR;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        std::cerr << "usage: rayleak_headless <scene file> [--output render.png] [--width N] [--height N] [--samples N] [--time SECONDS] [--error E] [--bounces N] [--budget MS] [--denoise] [--wavefront] [--checkpoint FILE] [--checkpoint-interval SECONDS] [--exr-float] [--exr-compression zip|none] [--no-aovs]" << std::endl;
+        std::cerr << "       rayleak_headless <scene file> --coordinator PORT [--output render.png] [--width N] [--height N] [--samples N] [--bounces N] [--tile GROUPS] [--slices N] [--job-timeout SECONDS]" << std::endl;
+        std::cerr << "       rayleak_headless --worker HOST:PORT [--budget MS]" << std::endl;
+        PrintResult("bad_arguments", options, nullptr, 0.0f);
+        return EXIT_BAD_ARGUMENTS;
+    }
+    if (options.coordinatorPort != 0) return RunCoordinator(options);
+    if (!options.workerAddress.empty()) return RunWorker(options);
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!CreateOffscreenContext(display, context))
+    {
+        PrintResult("no_context", options, nullptr, 0.0f);
+        return EXIT_NO_CONTEXT;
+    }
+    glViewport(0, 0, options.width, options.height);
+
+    // THE PREVIEW SHADERS NEVER RUN, THE WAVEFRONT KERNELS ONLY WHEN ASKED FOR
+    SetShaderDefine("GEOMETRY_PAGES", std::to_string(GeometryPageCount()));
+    unsigned int pathtraceShader = CreateComputeShader(LoadShaderFromFile("./shaders/pathtrace.shader"));
+
+    Camera camera;
+    RenderSystem renderSystem(options.width, options.height);
+    if (options.wavefront)
+    {
+        WavefrontPrograms wavefrontPrograms;
+        wavefrontPrograms.generate = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_generate.shader"));
+        wavefrontPrograms.extend = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_extend.shader"));
+        wavefrontPrograms.shade = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_shade.shader"));
+        wavefrontPrograms.shadow = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_shadow.shader"));
+        wavefrontPrograms.compact = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_compact.shader"));
+        wavefrontPrograms.args = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_args.shader"));
+        renderSystem.SetWavefrontShaders(wavefrontPrograms);
+        renderSystem.wavefront = true;
+    }
+    renderSystem.SetRenderBudget(options.budget);
+    renderSystem.bounces = options.bounces;
+    renderSystem.adaptiveSampling = options.job.targetError > 0.0f;
+    renderSystem.denoiseMode = options.denoise ? DenoiseMode::CPU : DenoiseMode::Off;
+    ModelManager modelManager;
+    LightManager lightManager;
+    MaterialManager materialManager(pathtraceShader);
+
+    uint64_t sceneHash = 0;
+    try
+    {
+        SceneFileReader reader(camera, renderSystem, modelManager, lightManager, materialManager);
+        reader.Load(options.scenePath);
+        sceneHash = reader.GetSceneHash();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        PrintResult("bad_scene", options, nullptr, 0.0f);
+        DestroyOffscreenContext(display, context);
+        return EXIT_BAD_SCENE;
+    }
+
+    // RENDER UNTIL THE JOB REPORTS A TARGET WAS MET, THE CPU DENOISER RUNS AS IT FINISHES
+    RenderJobResult result;
+    renderSystem.StartRenderJob(options.job);
+    if (!options.checkpointPath.empty())
+    {
+        renderSystem.SetCheckpoint(options.checkpointPath, options.checkpointInterval, sceneHash);
+        if (renderSystem.ResumeFromCheckpoint(camera)) std::cerr << "[main] Resumed from " << options.checkpointPath << std::endl;
+    }
+    while (!renderSystem.PollRenderJobComplete(result))
+    {
+        renderSystem.PathtraceFrame(pathtraceShader, camera);
+        glFlush();
+    }
+    renderSystem.FinishCheckpoints();
+    float raysPerSecond = renderSystem.GetRenderJobRaysPerSecond();
+
+    renderSystem.RenderToViewport();
+    glFinish();
+    bool written = IsHDRImagePath(options.outputPath) ? renderSystem.SaveFinalImage(options.outputPath, options.hdr) : SaveRender(renderSystem.GetFrameBufferTextureID(), options.outputPath.c_str());
+    if (!written)
+    {
+        PrintResult("write_failed", options, &result, raysPerSecond);
+        DestroyOffscreenContext(display, context);
+        return EXIT_WRITE_FAILED;
+    }
+    PrintResult("rendered", options, &result, raysPerSecond);
+
+    DestroyOffscreenContext(display, context);
+    return EXIT_RENDERED;
+}
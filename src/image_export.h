@@ -0,0 +1,314 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include "../lib/glm/glm.hpp"
+
+// STANDARD LIBRARY
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+// DEFLATE FROM stb_image_write, COMPILED WITH ITS IMPLEMENTATION IN material.h
+extern "C" unsigned char* stbi_zlib_compress(unsigned char* data, int data_len, int* out_len, int quality);
+
+// LINEAR FINAL IMAGE AND ITS AOVS. ROWS RUN BOTTOM TO TOP LIKE THE GL TEXTURES
+struct HDRImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<glm::vec3> colour; // MEAN RADIANCE, BEFORE EXPOSURE AND TONE MAPPING
+    std::vector<glm::vec3> albedo;
+    std::vector<glm::vec3> normal;
+    std::vector<float> depth; // DISTANCE FROM THE CAMERA, SKY PIXELS SIT FAR AWAY
+    std::vector<float> samples;
+};
+
+enum class EXRPixelType
+{
+    Half = 1,
+    Float = 2
+};
+
+enum class EXRCompression
+{
+    None = 0,
+    Zip = 3 // DEFLATE OVER BLOCKS OF 16 SCANLINES
+};
+
+struct HDRExportOptions
+{
+    EXRPixelType pixelType = EXRPixelType::Half;
+    EXRCompression compression = EXRCompression::Zip;
+    bool aovs = true; // EXR CHANNELS, OR SIBLING render.<aov>.pfm FILES
+};
+
+// LOWER CASE, EMPTY WITHOUT ONE
+inline std::string FileExtension(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find_first_of("/\\", dot) != std::string::npos) return "";
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+// .exr AND .pfm ARE WRITTEN FROM THE LINEAR ACCUMULATION, ANYTHING ELSE IS A TONE MAPPED PNG
+inline bool IsHDRImagePath(const std::string& path)
+{
+    std::string extension = FileExtension(path);
+    return extension == "exr" || extension == "pfm";
+}
+
+// ROUND TO NEAREST EVEN, OVERFLOW GOES TO INFINITY AND TINY VALUES TO DENORMALS OR ZERO
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if (magnitude >= 0x7F800000u) return static_cast<uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    if (magnitude >= 0x477FF000u) return static_cast<uint16_t>(sign | 0x7C00u);
+    if (magnitude < 0x33000001u) return static_cast<uint16_t>(sign);
+
+    if (magnitude < 0x38800000u)
+    {
+        uint32_t shift = 113 - (magnitude >> 23);
+        uint32_t mantissa = (magnitude & 0x007FFFFFu) | 0x00800000u;
+        uint32_t half = mantissa >> (shift + 13);
+        uint32_t remainder = mantissa & ((1u << (shift + 13)) - 1u);
+        uint32_t midpoint = 1u << (shift + 12);
+        if (remainder > midpoint || (remainder == midpoint && (half & 1u))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    uint32_t remainder = magnitude & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+// SINGLE PART SCANLINE OPENEXR. CHUNKS ARE CONVERTED AND COMPRESSED IN PARALLEL, THEN WRITTEN IN ORDER
+class EXRWriter
+{
+public:
+
+    static bool Write(const HDRImage& image, const std::string& path, const HDRExportOptions& options)
+    {
+        std::vector<Channel> channels = Channels(image, options.aovs);
+        int bytesPerValue = options.pixelType == EXRPixelType::Half ? 2 : 4;
+        int linesPerChunk = options.compression == EXRCompression::Zip ? 16 : 1;
+        int chunkCount = (image.height + linesPerChunk - 1) / linesPerChunk;
+        size_t lineBytes = static_cast<size_t>(image.width) * channels.size() * bytesPerValue;
+
+        std::vector<std::vector<uint8_t>> chunks(chunkCount);
+        bool failed = false;
+        #pragma omp parallel for schedule(dynamic) reduction(||:failed)
+        for (int chunk=0; chunk<chunkCount; chunk++)
+        {
+            int firstLine = chunk * linesPerChunk;
+            int lines = std::min(linesPerChunk, image.height - firstLine);
+            std::vector<uint8_t> raw(lineBytes * lines);
+            uint8_t* out = raw.data();
+
+            // EXR ROWS RUN TOP TO BOTTOM, EACH LINE HOLDS ONE CHANNEL AFTER ANOTHER
+            for (int line=0; line<lines; line++)
+            {
+                size_t row = static_cast<size_t>(image.height - 1 - (firstLine + line)) * image.width;
+                for (const Channel& channel : channels)
+                {
+                    for (int x=0; x<image.width; x++)
+                    {
+                        float value = channel.source[(row + x) * channel.stride];
+                        if (bytesPerValue == 2)
+                        {
+                            uint16_t half = FloatToHalf(value);
+                            memcpy(out, &half, 2);
+                        }
+                        else memcpy(out, &value, 4);
+                        out += bytesPerValue;
+                    }
+                }
+            }
+
+            if (options.compression == EXRCompression::Zip && !Compress(raw, chunks[chunk])) failed = true;
+            if (options.compression == EXRCompression::None) chunks[chunk].swap(raw);
+        }
+        if (failed) return false;
+
+        std::vector<uint8_t> header = Header(image, channels, options);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+        // OFFSET TABLE, THEN EACH CHUNK AS ITS FIRST LINE, ITS SIZE AND ITS DATA
+        uint64_t offset = header.size() + static_cast<uint64_t>(chunkCount) * sizeof(uint64_t);
+        for (int chunk=0; chunk<chunkCount; chunk++)
+        {
+            file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            offset += 2 * sizeof(int32_t) + chunks[chunk].size();
+        }
+        for (int chunk=0; chunk<chunkCount; chunk++)
+        {
+            int32_t line = chunk * linesPerChunk;
+            int32_t size = static_cast<int32_t>(chunks[chunk].size());
+            file.write(reinterpret_cast<const char*>(&line), sizeof(line));
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(reinterpret_cast<const char*>(chunks[chunk].data()), size);
+        }
+        return static_cast<bool>(file);
+    }
+
+private:
+
+    struct Channel
+    {
+        std::string name;
+        const float* source;
+        size_t stride;
+    };
+
+    // EXR NEEDS THE CHANNELS SORTED BY NAME, IN THE HEADER AND IN EVERY LINE
+    static std::vector<Channel> Channels(const HDRImage& image, bool aovs)
+    {
+        std::vector<Channel> channels;
+        const char* rgb[3] = { "R", "G", "B" };
+        const char* xyz[3] = { "X", "Y", "Z" };
+        for (int c=0; c<3; c++) channels.push_back({ rgb[c], &image.colour[0].x + c, 3 });
+        if (aovs)
+        {
+            for (int c=0; c<3; c++) channels.push_back({ std::string("albedo.") + rgb[c], &image.albedo[0].x + c, 3 });
+            for (int c=0; c<3; c++) channels.push_back({ std::string("normal.") + xyz[c], &image.normal[0].x + c, 3 });
+            channels.push_back({ "depth.Z", image.depth.data(), 1 });
+            channels.push_back({ "samples.Y", image.samples.data(), 1 });
+        }
+        std::sort(channels.begin(), channels.end(), [](const Channel& a, const Channel& b) { return a.name < b.name; });
+        return channels;
+    }
+
+    static std::vector<uint8_t> Header(const HDRImage& image, const std::vector<Channel>& channels, const HDRExportOptions& options)
+    {
+        std::vector<uint8_t> header = { 0x76, 0x2F, 0x31, 0x01, 2, 0, 0, 0 };
+
+        std::vector<uint8_t> channelList;
+        for (const Channel& channel : channels)
+        {
+            channelList.insert(channelList.end(), channel.name.begin(), channel.name.end());
+            channelList.push_back(0);
+            int32_t values[4] = { static_cast<int32_t>(options.pixelType), 0, 1, 1 }; // TYPE, LINEAR + RESERVED, X AND Y SAMPLING
+            Append(channelList, values, sizeof(values));
+        }
+        channelList.push_back(0);
+        Attribute(header, "channels", "chlist", channelList.data(), channelList.size());
+
+        uint8_t compression = static_cast<uint8_t>(options.compression);
+        Attribute(header, "compression", "compression", &compression, 1);
+        int32_t window[4] = { 0, 0, image.width - 1, image.height - 1 };
+        Attribute(header, "dataWindow", "box2i", window, sizeof(window));
+        Attribute(header, "displayWindow", "box2i", window, sizeof(window));
+        uint8_t lineOrder = 0; // INCREASING Y
+        Attribute(header, "lineOrder", "lineOrder", &lineOrder, 1);
+        float aspect = 1.0f;
+        Attribute(header, "pixelAspectRatio", "float", &aspect, sizeof(aspect));
+        float centre[2] = { 0.0f, 0.0f };
+        Attribute(header, "screenWindowCenter", "v2f", centre, sizeof(centre));
+        float screenWidth = 1.0f;
+        Attribute(header, "screenWindowWidth", "float", &screenWidth, sizeof(screenWidth));
+        header.push_back(0);
+        return header;
+    }
+
+    static void Append(std::vector<uint8_t>& bytes, const void* data, size_t size)
+    {
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+
+    static void Attribute(std::vector<uint8_t>& header, const char* name, const char* type, const void* value, size_t size)
+    {
+        Append(header, name, strlen(name) + 1);
+        Append(header, type, strlen(type) + 1);
+        int32_t valueSize = static_cast<int32_t>(size);
+        Append(header, &valueSize, sizeof(valueSize));
+        Append(header, value, size);
+    }
+
+    // SPLIT THE BYTES INTO EVEN AND ODD HALVES AND DELTA ENCODE THEM BEFORE DEFLATE, READERS
+    // TAKE THE RAW LINES WHEN COMPRESSION DOESN'T MAKE THEM SMALLER
+    static bool Compress(std::vector<uint8_t>& raw, std::vector<uint8_t>& compressed)
+    {
+        size_t size = raw.size();
+        std::vector<uint8_t> reordered(size);
+        uint8_t* even = reordered.data();
+        uint8_t* odd = reordered.data() + (size + 1) / 2;
+        for (size_t i=0; i<size; i++) *((i & 1) ? odd++ : even++) = raw[i];
+
+        int previous = reordered[0];
+        for (size_t i=1; i<size; i++)
+        {
+            int current = reordered[i];
+            reordered[i] = static_cast<uint8_t>(current - previous + 128 + 256);
+            previous = current;
+        }
+
+        int compressedSize = 0;
+        unsigned char* deflated = stbi_zlib_compress(reordered.data(), static_cast<int>(size), &compressedSize, 5);
+        if (!deflated) return false;
+        if (static_cast<size_t>(compressedSize) < size) compressed.assign(deflated, deflated + compressedSize);
+        else compressed.swap(raw);
+        free(deflated);
+        return true;
+    }
+};
+
+// PORTABLE FLOAT MAP, THREE CHANNELS FOR COLOUR AND ONE FOR SCALARS. ROWS ARE STORED BOTTOM TO
+// TOP LIKE THE TEXTURES SO NO FLIP IS NEEDED
+inline bool WritePFM(const std::string& path, int width, int height, int channels, const float* data, size_t stride)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file << (channels == 3 ? "PF" : "Pf") << "\n" << width << " " << height << "\n-1.0\n";
+
+    std::vector<float> row(static_cast<size_t>(width) * channels);
+    for (int y=0; y<height; y++)
+    {
+        for (int x=0; x<width; x++) for (int c=0; c<channels; c++)
+        {
+            row[x * channels + c] = data[(static_cast<size_t>(y) * width + x) * stride + c];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(float)));
+    }
+    return static_cast<bool>(file);
+}
+
+// WRITES .exr OR .pfm BY EXTENSION. PFM HOLDS ONE LAYER, SO ITS AOVS GO TO render.albedo.pfm,
+// render.normal.pfm, render.depth.pfm AND render.samples.pfm NEXT TO render.pfm
+inline bool SaveHDRImage(const HDRImage& image, const std::string& path, const HDRExportOptions& options)
+{
+    bool written;
+    std::string stem = path.substr(0, path.find_last_of('.'));
+    if (FileExtension(path) == "exr")
+    {
+        written = !image.colour.empty() && EXRWriter::Write(image, path, options);
+    }
+    else
+    {
+        written = !image.colour.empty() && WritePFM(path, image.width, image.height, 3, &image.colour[0].x, 3);
+        if (written && options.aovs)
+        {
+            written = WritePFM(stem + ".albedo.pfm", image.width, image.height, 3, &image.albedo[0].x, 3) &&
+                      WritePFM(stem + ".normal.pfm", image.width, image.height, 3, &image.normal[0].x, 3) &&
+                      WritePFM(stem + ".depth.pfm", image.width, image.height, 1, image.depth.data(), 1) &&
+                      WritePFM(stem + ".samples.pfm", image.width, image.height, 1, image.samples.data(), 1);
+        }
+    }
+
+    if (!written) std::cerr << "[SaveHDRImage] Failed! Could not write image to: " << path << std::endl;
+    return written;
+}
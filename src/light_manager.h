@@ -21,11 +21,10 @@ public:
     std::vector<std::string> pointLightNames;
     std::vector<std::string> spotlightNames;
 
-    LightManager(unsigned int _pathtraceShader) : 
-    pathtraceShader(_pathtraceShader),
-    DirectionalLightBuffer(DynamicContiguousBuffer(7, 0)),
-    PointLightBuffer(DynamicContiguousBuffer(8, 0)),
-    SpotlightBuffer(DynamicContiguousBuffer(9, 0)) 
+    LightManager() : 
+    DirectionalLightBuffer(DynamicContiguousBuffer(7, 0, "directional lights")),
+    PointLightBuffer(DynamicContiguousBuffer(8, 0, "point lights")),
+    SpotlightBuffer(DynamicContiguousBuffer(9, 0, "spotlights")) 
     {
         
     }
@@ -67,9 +66,6 @@ public:
 
         // DELETE FROM GPU MEMORY
         DirectionalLightBuffer.DeleteShift(index * sizeof(DirectionalLight), sizeof(DirectionalLight));
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_directionalLightCount"), directionalLights.size());
     }
 
     void DeletePointLight(int index)
@@ -79,9 +75,6 @@ public:
 
         // DELETE FROM GPU MEMORY
         PointLightBuffer.DeleteShift(index * sizeof(PointLight), sizeof(PointLight));
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_pointLightCount"), pointLights.size());
     }
 
     void DeleteSpotlight(int index)
@@ -91,9 +84,6 @@ public:
 
         // DELETE FROM GPU MEMORY
         SpotlightBuffer.DeleteShift(index * sizeof(Spotlight), sizeof(Spotlight));
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_spotlightCount"), spotlights.size());
     }
 
     void UpdateDirectionalLight(int lightIndex)
@@ -164,13 +154,8 @@ private:
     DynamicContiguousBuffer PointLightBuffer;
     DynamicContiguousBuffer SpotlightBuffer;
 
-    // PATH TRACING SHADER ID
-    unsigned int pathtraceShader;
-
     void AddDirectionalLightToScene(DirectionalLight& directionalLight)
     {
-        glUseProgram(pathtraceShader);
-
         // GET DIRECTIONAL LIGHT SIZE
         uint32_t directionalLightSize = sizeof(DirectionalLight);
 
@@ -185,15 +170,10 @@ private:
 
         // UNMAP BUFFER
         DirectionalLightBuffer.UnmapBuffer();
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_directionalLightCount"), directionalLights.size());
     }
 
     void AddPointLightToScene(PointLight& pointLight)
     {
-        glUseProgram(pathtraceShader);
-
         // GET DIRECTIONAL LIGHT SIZE
         uint32_t pointLightSize = sizeof(PointLight);
 
@@ -208,14 +188,10 @@ private:
 
         // UNMAP BUFFER
         PointLightBuffer.UnmapBuffer();
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_pointLightCount"), pointLights.size());
     }
 
     void AddSpotlightToScene(Spotlight& spotlight)
     {
-        glUseProgram(pathtraceShader);
         
         // GET DIRECTIONAL LIGHT SIZE
         uint32_t spotlightSize = sizeof(Spotlight);
@@ -231,9 +207,6 @@ private:
 
         // UNMAP BUFFER
         SpotlightBuffer.UnmapBuffer();
-
-        // UPDATE UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_spotlightCount"), spotlights.size());
     }
 
     // GENERATE A DEFAULT DIRECTIONAL LIGHT NAME
@@ -23,6 +23,7 @@
 #include "gpu_memory_manager.h"
 #include "camera.h"
 #include "material.h"
+#include "profiler.h"
 
 int main() 
 {
@@ -75,28 +76,39 @@ int main()
     // OPENGL VIEWPORT
     glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
     
+    // GEOMETRY PAGES DEPEND ON THE DEVICE LIMITS, SHADERS NEED THE COUNT BEFORE THEY COMPILE
+    SetShaderDefine("GEOMETRY_PAGES", std::to_string(GeometryPageCount()));
+
     // PATH TRACING COMPUTE SHADER
     std::string pathtraceShaderSource = LoadShaderFromFile("./shaders/pathtrace.shader");
     unsigned int pathtraceShader = CreateComputeShader(pathtraceShaderSource);
 
-    // RAYCASTING COMPUTE SHADER
-    std::string raycastShaderSource = LoadShaderFromFile("./shaders/raycast.shader");
-    unsigned int raycastShader = CreateComputeShader(raycastShaderSource);
+    // WAVEFRONT PATH TRACING KERNELS
+    WavefrontPrograms wavefrontPrograms;
+    wavefrontPrograms.generate = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_generate.shader"));
+    wavefrontPrograms.extend = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_extend.shader"));
+    wavefrontPrograms.shade = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_shade.shader"));
+    wavefrontPrograms.shadow = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_shadow.shader"));
+    wavefrontPrograms.compact = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_compact.shader"));
+    wavefrontPrograms.args = CreateComputeShader(LoadShaderFromFile("./shaders/wavefront_args.shader"));
 
     // CREATE CAMERA
-    Camera camera(pathtraceShader);
+    Camera camera;
 
     // CREATE RENDER SYSTEM
     RenderSystem renderSystem(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    renderSystem.SetWavefrontShaders(wavefrontPrograms);
+    renderSystem.SetTemporalShader(CreateComputeShader(LoadShaderFromFile("./shaders/temporal.shader")));
+    renderSystem.SetDenoiseShader(CreateComputeShader(LoadShaderFromFile("./shaders/denoise.shader")));
 
     // CREATE USER INTERFACE OBJECT
     UserInterface UI(pathtraceShader);
 
     // CREATE A MODEL MANAGER
-    ModelManager modelManager(pathtraceShader);
+    ModelManager modelManager;
 
     // CREATE A LIGHT MANAGER
-    LightManager lightManager(pathtraceShader);
+    LightManager lightManager;
 
     // CREATE A MATERIAL MANAGER
     MaterialManager materialManager(pathtraceShader); 
@@ -106,6 +118,8 @@ int main()
     while (!glfwWindowShouldClose(window))
     {
         auto start = std::chrono::high_resolution_clock::now();
+        Profiler::BeginFrame();
+        Profiler::BeginStage("input");
         glfwPollEvents();
 
         // }----------{ HANDLE WINDOW RESIZING }----------{
@@ -223,21 +237,46 @@ int main()
                 renderSystem.SetRendererDynamic();
             }
         }
+        Profiler::EndStage("input");
         // }----------{ VIEWPORT CONTROLS }----------{
 
 
 
         // }----------{ INVOKE PATH TRACER }----------{
+        Profiler::BeginStage("pathtrace", true);
+        renderSystem.SetSceneCounts(modelManager.meshCount, static_cast<uint32_t>(lightManager.directionalLights.size()), static_cast<uint32_t>(lightManager.pointLights.size()), static_cast<uint32_t>(lightManager.spotlights.size()));
         renderSystem.PathtraceFrame(pathtraceShader, camera);
+        Profiler::EndStage("pathtrace");
+        Profiler::SetCounter("tiles", static_cast<float>(renderSystem.GetTilesLastFrame()));
+        Profiler::SetCounter("samples_per_sec", renderSystem.GetSamplesPerSecond());
+        Profiler::SetCounter("rays_per_sec", renderSystem.GetRaysPerSecond());
+        Profiler::SetCounter("progress", renderSystem.GetAccumulationProgress());
         // }----------{ PATH TRACER ENDS }----------{
 
 
         // }----------{ RENDER THE QUAD TO THE FRAME BUFFER }----------{
+        Profiler::BeginStage("viewport", true);
         renderSystem.RenderToViewport();
+        Profiler::EndStage("viewport");
         // }----------{ RENDER THE QUAD TO THE FRAME BUFFER }----------{
 
 
+        // }----------{ RENDER JOB COMPLETION }----------{
+        RenderJobResult jobResult;
+        if (renderSystem.PollRenderJobComplete(jobResult))
+        {
+            std::cout << "[RenderJob] Finished after " << jobResult.samples << " samples, " << jobResult.elapsedTime << "s, max error " << jobResult.maxError << std::endl;
+            if (jobResult.job.autoExport && jobResult.reason != RenderJobStopReason::Cancelled)
+            {
+                if (IsHDRImagePath(jobResult.job.exportPath)) renderSystem.SaveFinalImageAsync(jobResult.job.exportPath, HDRExportOptions());
+                else SaveRenderAsync(renderSystem.readback, renderSystem.GetFrameBufferTextureID(), jobResult.job.exportPath);
+            }
+        }
+        // }----------{ RENDER JOB COMPLETION ENDS }----------{
+
+
         // }----------{ APP LAYOUT }----------{
+        Profiler::BeginStage("ui_layout");
         UI.BeginAppLayout();
         UI.RenderViewportPanel(
             VIEWPORT_WIDTH, 
@@ -247,8 +286,7 @@ int main()
             renderSystem.GetFrameBufferTextureID(),
             camera, 
             modelManager, 
-            renderSystem, 
-            raycastShader
+            renderSystem
         );
 
         UI.BeginSidebar(VIEWPORT_HEIGHT);
@@ -268,11 +306,16 @@ int main()
         UI.RenderTexturesPanel(materialManager);
         UI.EndAppLayout();
         glViewport(0, 0, VIEWPORT_WIDTH, VIEWPORT_HEIGHT); // RESET GL VIEWPORT
+        Profiler::EndStage("ui_layout");
         // }----------{ APP LAYOUT ENDS   }----------{
         
 
+        Profiler::BeginStage("ui_draw", true);
         UI.RenderUI();
+        Profiler::EndStage("ui_draw");
+        Profiler::BeginStage("swap");
         glfwSwapBuffers(window);
+        Profiler::EndStage("swap");
 
         if (UI.restartRender)
         {
@@ -283,8 +326,11 @@ int main()
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::duration<float>>(end - start);
         frameTime = duration.count();
+        Profiler::EndFrame();
     }
 
+    Profiler::Shutdown();
+
     glfwDestroyWindow(window);
     glfwTerminate();
     exit(EXIT_SUCCESS);
@@ -8,6 +8,7 @@
 #include "../lib/stb_image.h"
 #include "../lib/stb_image_write.h"
 #include "debug.h"
+#include "memory_tracker.h"
 
 // STANDARD LIBRARY
 #include <iostream>
@@ -15,11 +16,35 @@
 #include <string>
 #include <string.h>
 #include <array>
+#include <vector>
+#include <memory>
 
 // PROJECT HEADERS
 #include "utils.h"
+#include "readback.h"
 
-void SaveRender(unsigned int textureID, const char* filename)
+// TEXTURED MATERIALS NEED BINDLESS TEXTURES, SOFTWARE DRIVERS ON RENDER NODES DON'T HAVE THEM
+bool BindlessTexturesSupported()
+{
+    return GLEW_ARB_bindless_texture == GL_TRUE;
+}
+
+// WRITES THE BOTTOM-UP RGBA8 PIXELS OF A TEXTURE AS A TOP-DOWN PNG
+bool WriteRenderPNG(const unsigned char* imageData, int width, int height, const char* filename)
+{
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> flippedImage(rowBytes * height);
+    for (int y=0; y<height; y++)
+    {
+        memcpy(&flippedImage[y * rowBytes], imageData + (height - y - 1) * rowBytes, rowBytes);
+    }
+
+    int written = stbi_write_png(filename, width, height, 4, flippedImage.data(), static_cast<int>(rowBytes));
+    if (!written) std::cerr << "[SaveRender] Failed! Could not write image to: " << filename << std::endl;
+    return written != 0;
+}
+
+bool SaveRender(unsigned int textureID, const char* filename)
 {
     int width = 0, height = 0;
 
@@ -29,29 +54,33 @@ void SaveRender(unsigned int textureID, const char* filename)
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
 
     // GET IMAGE DATA
-    unsigned char* imageData = new unsigned char[width * height * 4];
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
+    std::vector<unsigned char> imageData(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-    // FLIP IMAGE VERTICALLY
-    unsigned char* flippedImage = new unsigned char[width * height * 4];
+    return WriteRenderPNG(imageData.data(), width, height, filename);
+}
 
-    for (int y=0; y<height; y++)
+// SaveRender WITHOUT WAITING ON THE GPU, THE PIXELS ARRIVE A FRAME OR MORE LATER AND ARE
+// FLIPPED AND ENCODED ON THE READBACK WORKER
+void SaveRenderAsync(ReadbackService& readback, unsigned int textureID, const std::string& filename)
+{
+    int width = 0, height = 0;
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    size_t size = static_cast<size_t>(width) * height * 4;
+    readback.ReadTexture(textureID, GL_RGBA, GL_UNSIGNED_BYTE, size, [&readback, width, height, size, filename](const ReadbackBytes& bytes)
     {
-        for (int x=0; x<width; x++)
+        readback.RunInBackground([bytes, width, height, size, filename]()
         {
-            int flippedIndex = y * width + x;
-            int imageIndex = (height - y - 1) * width + x;
-            flippedImage[flippedIndex * 4] = imageData[imageIndex * 4];
-            flippedImage[flippedIndex * 4 + 1] = imageData[imageIndex * 4 + 1];
-            flippedImage[flippedIndex * 4 + 2] = imageData[imageIndex * 4 + 2];
-            flippedImage[flippedIndex * 4 + 3] = imageData[imageIndex * 4 + 3];
-        }
-    }
-
-    // SAVE IMAGE
-    stbi_write_png(filename, width, height, 4, flippedImage, width * 4);
-    delete[] flippedImage;
-    delete[] imageData;
+            if (bytes.size() != size) std::cerr << "[SaveRender] Failed! Could not read back the image for: " << filename << std::endl;
+            else WriteRenderPNG(bytes.data(), width, height, filename.c_str());
+        });
+    });
 }
 
 struct Texture
@@ -64,6 +93,7 @@ struct Texture
     void CleanUp() 
     {
         if (textureID) glDeleteTextures(1, &textureID);
+        MemoryTracker::Release("textures", textureID);
     }
 
     void LoadImage(const std::string filepath)
@@ -90,7 +120,11 @@ struct Texture
         glGenerateMipmap(GL_TEXTURE_2D); 
         stbi_image_free(localbuffer);
 
-        textureHandle = glGetTextureHandleARB(textureID);
+        // RGB8 IS PADDED TO 4 BYTES PER TEXEL BY THE DRIVER
+        uint64_t textureSize = MemoryTracker::TextureBytes(width, height, 4, true);
+        MemoryTracker::Track("textures", textureID, textureSize, textureSize);
+
+        textureHandle = BindlessTexturesSupported() ? glGetTextureHandleARB(textureID) : 0;
     }
 };
 
@@ -147,6 +181,10 @@ struct Material
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glBindTexture(GL_TEXTURE_2D, 0);
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        // COLOUR AND DEPTH STENCIL ATTACHMENTS
+        uint64_t thumbnailSize = MemoryTracker::TextureBytes(width, height, 8, false);
+        MemoryTracker::Track("thumbnails", FBO, thumbnailSize, thumbnailSize);
     }
         
     void CleanUp()
@@ -154,11 +192,20 @@ struct Material
         if (albedoID) glDeleteTextures(1, &albedoID);
         if (normalID) glDeleteTextures(1, &normalID);
         if (roughnessID) glDeleteTextures(1, &roughnessID);
+        MemoryTracker::Release("material textures", albedoID);
+        MemoryTracker::Release("material textures", normalID);
+        MemoryTracker::Release("material textures", roughnessID);
     }
 
 
     void LoadAlbedo(std::string filepath)
     {
+        if (!BindlessTexturesSupported())
+        {
+            std::cerr << "[LoadAlbedo] Failed! Bindless textures are not supported by this driver" << std::endl;
+            return;
+        }
+
         // UNLOAD EXISTING TEXTURE IF IT EXISTS
         if (data.albedoHandle != -1) glMakeTextureHandleNonResidentARB(data.albedoHandle);
 
@@ -180,6 +227,9 @@ struct Material
         glGenerateMipmap(GL_TEXTURE_2D); 
         stbi_image_free(localbuffer);
 
+        uint64_t textureSize = MemoryTracker::TextureBytes(width, height, 4, true);
+        MemoryTracker::Track("material textures", albedoID, textureSize, textureSize);
+
         data.albedoHandle = glGetTextureHandleARB(albedoID);
         data.textureFlags |= (1 << 0);
         glMakeTextureHandleResidentARB(data.albedoHandle);
@@ -187,6 +237,12 @@ struct Material
 
     void LoadNormal(std::string filepath)
     {
+        if (!BindlessTexturesSupported())
+        {
+            std::cerr << "[LoadNormal] Failed! Bindless textures are not supported by this driver" << std::endl;
+            return;
+        }
+
         // UNLOAD EXISTING TEXTURE IF IT EXISTS
         if (data.normalHandle != -1) glMakeTextureHandleNonResidentARB(data.normalHandle);
 
@@ -208,6 +264,9 @@ struct Material
         glGenerateMipmap(GL_TEXTURE_2D); 
         stbi_image_free(localbuffer);
 
+        uint64_t textureSize = MemoryTracker::TextureBytes(width, height, 4, true);
+        MemoryTracker::Track("material textures", normalID, textureSize, textureSize);
+
         data.normalHandle = glGetTextureHandleARB(normalID);
         data.textureFlags |= (1 << 1);
         glMakeTextureHandleResidentARB(data.normalHandle);
@@ -215,6 +274,12 @@ struct Material
 
     void LoadRoughness(std::string filepath)
     {
+        if (!BindlessTexturesSupported())
+        {
+            std::cerr << "[LoadRoughness] Failed! Bindless textures are not supported by this driver" << std::endl;
+            return;
+        }
+
         // UNLOAD EXISTING TEXTURE IF IT EXISTS
         if (data.roughnessHandle != -1) glMakeTextureHandleNonResidentARB(data.roughnessHandle);
 
@@ -241,13 +306,18 @@ struct Material
         glGenerateMipmap(GL_TEXTURE_2D); 
         stbi_image_free(localbuffer);
 
+        uint64_t textureSize = MemoryTracker::TextureBytes(width, height, 1, true);
+        MemoryTracker::Track("material textures", roughnessID, textureSize, textureSize);
+
         data.roughnessHandle = glGetTextureHandleARB(roughnessID);
         data.textureFlags |= (1 << 2);
         glMakeTextureHandleResidentARB(data.roughnessHandle);
     }
 
     void UpdateAlbedo(unsigned int newTextureID, uint64_t newTextureHandle)
-    {   
+    {
+        if (!BindlessTexturesSupported()) return;
+   
         // IF ALBEDO EXISTS
         if (data.albedoHandle != -1)
         {   
@@ -263,6 +333,8 @@ struct Material
 
     void UpdateNormal(unsigned int newTextureID, uint64_t newTextureHandle)
     {
+        if (!BindlessTexturesSupported()) return;
+
         // IF NORMAL EXISTS
         if (data.normalHandle != -1)
         {   
@@ -278,6 +350,8 @@ struct Material
     
     void UpdateRoughness(unsigned int newTextureID, uint64_t newTextureHandle)
     {
+        if (!BindlessTexturesSupported()) return;
+
         // IF ROUGHNESS EXISTS
         if (data.roughnessHandle != -1)
         {   
@@ -20,7 +20,7 @@ public:
 
     MaterialManager(unsigned int _pathtraceShader) : 
     pathtraceShader(_pathtraceShader),
-    MaterialBuffer(DynamicContiguousBuffer(4, 0))
+    MaterialBuffer(DynamicContiguousBuffer(4, 0, "materials"))
     {
         // CREATE DEFAULT MATERIAL
         Material defaultMat;
@@ -46,6 +46,20 @@ public:
         AddMaterialToScene(newMaterial.data);
     }
 
+    // MATERIALS FROM SCENE FILES, NO THUMBNAIL IS RENDERED
+    int AddMaterial(const MaterialData& materialData, const std::string& name)
+    {
+        Material newMaterial;
+        newMaterial.data = materialData;
+        strcpy_s(newMaterial.name, 32, name.substr(0, 31).c_str());
+        strcpy_s(newMaterial.tempName, 32, name.substr(0, 31).c_str());
+        materials.push_back(newMaterial);
+
+        // SEND TO GPU
+        AddMaterialToScene(newMaterial.data);
+        return static_cast<int>(materials.size()) - 1;
+    }
+
     void ImportTexture()
     {
         // ADAPTED FROM USER tinyfiledialogs https://stackoverflow.com/questions/6145910/cross-platform-native-open-save-file-dialogs
@@ -68,7 +82,7 @@ public:
         MaterialBuffer.GrowBuffer(materialDataSize);
 
         // GET MAPPED MATERIAL BUFFER
-        void* mappedMaterialBuffer = MaterialBuffer.GetMappedBuffer(MaterialBuffer.BufferSize() - materialDataSize, materialDataSize);
+        void* mappedMaterialBuffer = MaterialBuffer.GetMappedBuffer(MaterialBuffer.UsedCapacity() - materialDataSize, materialDataSize);
 
         // COPY MATERIAL TO THE GPU
         memcpy((char*)mappedMaterialBuffer, &materialData, materialDataSize);
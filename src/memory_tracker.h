@@ -0,0 +1,137 @@
+#pragma once
+
+// STANDARD LIBRARY
+#include <map>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+// TRACKS GPU BYTES PER SUBSYSTEM, EACH ALLOCATION SITE REPORTS USED AND ALLOCATED BYTES
+// UNDER A KEY (BUFFER ADDRESS OR GL OBJECT ID) AND RELEASES THE KEY WHEN IT FREES THE MEMORY
+namespace MemoryTracker
+{
+    struct Allocation
+    {
+        uint64_t used;
+        uint64_t allocated;
+    };
+
+    struct Subsystem
+    {
+        std::map<uint64_t, Allocation> allocations;
+        uint64_t used = 0;
+        uint64_t allocated = 0;
+        uint64_t highWaterMark = 0;
+    };
+
+    inline std::map<std::string, Subsystem> subsystems;
+    inline uint64_t totalHighWaterMark = 0;
+
+    inline uint64_t TotalUsed()
+    {
+        uint64_t total = 0;
+        for (const auto& [name, subsystem] : subsystems) total += subsystem.used;
+        return total;
+    }
+
+    inline uint64_t TotalAllocated()
+    {
+        uint64_t total = 0;
+        for (const auto& [name, subsystem] : subsystems) total += subsystem.allocated;
+        return total;
+    }
+
+    // FRACTION OF ALLOCATED BYTES THAT HOLD NO DATA
+    inline float Fragmentation(uint64_t used, uint64_t allocated)
+    {
+        if (allocated == 0) return 0.0f;
+        return 1.0f - static_cast<float>(used) / static_cast<float>(allocated);
+    }
+
+    inline void Track(const std::string& subsystemName, uint64_t key, uint64_t used, uint64_t allocated)
+    {
+        Subsystem& subsystem = subsystems[subsystemName];
+        Allocation& allocation = subsystem.allocations[key];
+
+        // REPLACE PREVIOUS FIGURES FOR THIS KEY
+        subsystem.used += used - allocation.used;
+        subsystem.allocated += allocated - allocation.allocated;
+        allocation.used = used;
+        allocation.allocated = allocated;
+
+        subsystem.highWaterMark = std::max(subsystem.highWaterMark, subsystem.allocated);
+        totalHighWaterMark = std::max(totalHighWaterMark, TotalAllocated());
+    }
+
+    inline void Track(const std::string& subsystemName, const void* owner, uint64_t used, uint64_t allocated)
+    {
+        Track(subsystemName, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)), used, allocated);
+    }
+
+    inline void Release(const std::string& subsystemName, uint64_t key)
+    {
+        auto subsystemIt = subsystems.find(subsystemName);
+        if (subsystemIt == subsystems.end()) return;
+
+        Subsystem& subsystem = subsystemIt->second;
+        auto allocationIt = subsystem.allocations.find(key);
+        if (allocationIt == subsystem.allocations.end()) return;
+
+        subsystem.used -= allocationIt->second.used;
+        subsystem.allocated -= allocationIt->second.allocated;
+        subsystem.allocations.erase(allocationIt);
+    }
+
+    inline void Release(const std::string& subsystemName, const void* owner)
+    {
+        Release(subsystemName, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)));
+    }
+
+    // BYTES FOR A 2D TEXTURE, A FULL MIP CHAIN ADDS A THIRD
+    inline uint64_t TextureBytes(int width, int height, int bytesPerPixel, bool mipmapped)
+    {
+        uint64_t bytes = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * static_cast<uint64_t>(bytesPerPixel);
+        if (mipmapped) bytes += bytes / 3;
+        return bytes;
+    }
+
+    inline std::string ToJSON()
+    {
+        std::string json = "{\n";
+        json += "  \"totalUsed\": " + std::to_string(TotalUsed()) + ",\n";
+        json += "  \"totalAllocated\": " + std::to_string(TotalAllocated()) + ",\n";
+        json += "  \"totalHighWaterMark\": " + std::to_string(totalHighWaterMark) + ",\n";
+        json += "  \"fragmentation\": " + std::to_string(Fragmentation(TotalUsed(), TotalAllocated())) + ",\n";
+        json += "  \"subsystems\": {";
+
+        bool first = true;
+        for (const auto& [name, subsystem] : subsystems)
+        {
+            json += first ? "\n" : ",\n";
+            first = false;
+            json += "    \"" + name + "\": {";
+            json += "\"used\": " + std::to_string(subsystem.used);
+            json += ", \"allocated\": " + std::to_string(subsystem.allocated);
+            json += ", \"highWaterMark\": " + std::to_string(subsystem.highWaterMark);
+            json += ", \"fragmentation\": " + std::to_string(Fragmentation(subsystem.used, subsystem.allocated));
+            json += ", \"allocations\": " + std::to_string(subsystem.allocations.size());
+            json += "}";
+        }
+        json += "\n  }\n}\n";
+        return json;
+    }
+
+    inline bool DumpJSON(const char* filepath)
+    {
+        std::ofstream file(filepath);
+        if (!file)
+        {
+            std::cerr << "[MemoryTracker::DumpJSON] Failed! Could not open: " << filepath << std::endl;
+            return false;
+        }
+        file << ToJSON();
+        return true;
+    }
+}
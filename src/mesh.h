@@ -14,6 +14,7 @@
 #include <unordered_map>
 #include <cmath>
 #include <chrono>
+#include <cstddef>
 #include <omp.h>
 
 // PROJECT HEADERS
@@ -28,16 +29,26 @@ struct MeshPartition
     uint32_t materialIndex;
     uint32_t bvhNodeStart;
     glm::mat4 inverseTransform;
+    glm::mat4 transform;
+    uint32_t page;
+    uint32_t padding[3];
 };
+static_assert(sizeof(MeshPartition) == 160, "MeshPartition must match the shader");
 
+// CHILDREN ARE ALLOCATED IN PAIRS, LEFT ON THE ODD INDEX AND RIGHT STRAIGHT AFTER IT. WITH THE
+// PARENT LINK AND SPLIT AXIS THE SHADERS WALK THE TREE WITHOUT A STACK. BOTH FIELDS SIT IN WHAT
+// WAS vec3 PADDING, SO THE NODE IS STILL 48 BYTES
 struct BVH_Node
 {
     alignas(16) glm::vec3 aabbMin;
+    uint32_t parent;
     alignas(16) glm::vec3 aabbMax;
     uint32_t leftChild, rightChild;
     uint32_t firstIndex, indexCount;
-    BVH_Node() : leftChild(0), rightChild(0), firstIndex(0), indexCount(0) {}
+    uint32_t splitAxis; // LEFT CHILD HOLDS THE LOWER SIDE OF THIS AXIS
+    BVH_Node() : parent(0), leftChild(0), rightChild(0), firstIndex(0), indexCount(0), splitAxis(0) {}
 };
+static_assert(sizeof(BVH_Node) == 48 && offsetof(BVH_Node, parent) == 12 && offsetof(BVH_Node, splitAxis) == 44, "BVH_Node must match the shader");
 
 
 struct Vertex
@@ -67,6 +78,7 @@ struct Mesh
     glm::vec3 rotation;
     glm::vec3 scale;
     glm::mat4 inverseTransform;
+    glm::mat4 transform;
 
     std::string name;
 
@@ -222,9 +234,12 @@ struct Mesh
         bvhNodes[leftChildIndex].indexCount = leftIndexCount;
         bvhNodes[rightChildIndex].firstIndex = i;
         bvhNodes[rightChildIndex].indexCount = node.indexCount - leftIndexCount;
+        bvhNodes[leftChildIndex].parent = nodeIndex;
+        bvhNodes[rightChildIndex].parent = nodeIndex;
         node.leftChild = leftChildIndex;
         node.rightChild = rightChildIndex;
         node.indexCount = 0;
+        node.splitAxis = static_cast<uint32_t>(axis);
 
         // RECURSIVE CALL FOT LEFT AND RIGHT SUB NODES
         UpdateNodeBounds(leftChildIndex);
@@ -233,9 +248,10 @@ struct Mesh
         SubdivideNode(rightChildIndex, recurse+1);
     }
 
+    // KEEPS BOTH DIRECTIONS, THE SHADERS MOVE HITS BACK TO WORLD SPACE WITHOUT INVERTING
     void UpdateInverseTransformMat()
     {
-        glm::mat4 transform = glm::mat4(1.0f); 
+        transform = glm::mat4(1.0f); 
         transform = glm::translate(transform, position);
         transform = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1, 0, 0));  
         transform = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0, 1, 0));
@@ -3,10 +3,35 @@
 // STANDARD LIBRARY
 #include <vector>
 #include <string>
+#include <algorithm>
 
 // PROJECT HEADERS
 #include "mesh.h"
 #include "gpu_memory_manager.h"
+#include "scene_query.h"
+
+// GEOMETRY IS SPLIT OVER SEVERAL SSBO PAGES SO SCENES CAN EXCEED THE MAX BLOCK SIZE. EACH PAGE
+// COSTS A VERTEX, INDEX AND BVH BLOCK IN EVERY TRACING KERNEL, SO THE PAGE COUNT IS WHAT THE
+// DRIVER'S PER SHADER BLOCK LIMIT LEAVES AFTER THE OTHER BLOCKS OF THE BUSIEST KERNEL
+// (wavefront_extend), AND WHAT ITS BINDING POINTS LEAVE ABOVE GEOMETRY_PAGE_BINDING. WITH THE
+// COMMON LIMIT OF 16 BLOCKS THAT IS 2 PAGES, SO GEOMETRY IS CAPPED AT 2 x THE MAX BLOCK SIZE PER
+// POOL. THE SHADERS GET THE COUNT AS GEOMETRY_PAGES THROUGH SetShaderDefine
+#define GEOMETRY_MAX_PAGES 8
+#define GEOMETRY_PAGE_BINDING 27
+#define TRACING_KERNEL_OTHER_BLOCKS 10
+
+inline uint32_t GeometryPageCount()
+{
+    static const uint32_t pageCount = []()
+    {
+        uint32_t maxBlocks = GPUBackend::MaxComputeStorageBlocks();
+        uint32_t maxBindings = GPUBackend::MaxStorageBindings();
+        uint32_t blockPages = maxBlocks > TRACING_KERNEL_OTHER_BLOCKS ? (maxBlocks - TRACING_KERNEL_OTHER_BLOCKS) / 3 : 0;
+        uint32_t bindingPages = maxBindings > GEOMETRY_PAGE_BINDING ? (maxBindings - GEOMETRY_PAGE_BINDING) / 3 : 0;
+        return std::max(1u, std::min({ blockPages, bindingPages, static_cast<uint32_t>(GEOMETRY_MAX_PAGES) }));
+    }();
+    return pageCount;
+}
 
 struct Model
 {
@@ -23,13 +48,14 @@ class ModelManager
 {
 public:
 
-    ModelManager(unsigned int _pathtraceShader) : 
-        pathtraceShader(_pathtraceShader),
-        VertexBuffer(DynamicPoolBuffer(2, 0)),
-        IndexBuffer(DynamicPoolBuffer(3, 0)),
-        BvhBuffer(DynamicPoolBuffer(5, 0)),
-        PartitionBuffer(DynamicContiguousBuffer(6, 0)),
-        meshCount(0)
+    ModelManager() : 
+        pageCount(GeometryPageCount()),
+        VertexBuffer(GEOMETRY_PAGE_BINDING, pageCount, GPUBackend::MaxStorageBlockSize(), "geometry vertices"),
+        IndexBuffer(GEOMETRY_PAGE_BINDING + pageCount, pageCount, GPUBackend::MaxStorageBlockSize(), "geometry indices"),
+        BvhBuffer(GEOMETRY_PAGE_BINDING + 2 * pageCount, pageCount, GPUBackend::MaxStorageBlockSize(), "bvh nodes"),
+        PartitionBuffer(DynamicContiguousBuffer(6, 0, "mesh partitions")),
+        meshCount(0),
+        nextMeshID(0)
     {
 
     }
@@ -38,6 +64,9 @@ public:
     std::vector<Model> models;
     std::vector<Model> modelInstances;
 
+    // CPU COPY OF THE PLACED MESHES FOR PICKING, INDEXED LIKE THE PARTITIONS
+    SceneQuery sceneQuery;
+
     void LoadModel(const char* filepath)
     {
         tinyobj::attrib_t attrib;
@@ -129,16 +158,20 @@ public:
 
         // DELETE MESH PARTITION DATA
         PartitionBuffer.DeleteShift(meshIndex * sizeof(MeshPartition), sizeof(MeshPartition));
+        sceneQuery.RemoveInstance(meshIndex);
 
         // DELETE SUBMESH 
         modelInstance.submeshPtrs.erase(modelInstance.submeshPtrs.begin() + submeshIndex);
         modelInstance.meshIDs.erase(modelInstance.meshIDs.begin() + submeshIndex);
         if (modelInstance.submeshPtrs.size() == 0) modelInstances.erase(modelInstances.begin() + instanceIndex);
         meshCount--;
+    }
 
-        // UPDATE MESH COUNT UNIFORM
-        glUseProgram(pathtraceShader);
-        glUniform1i(glGetUniformLocation(pathtraceShader, "u_meshCount"), meshCount);
+    // DROPS THE MOST RECENT INSTANCE WHEN IT NEVER MADE IT INTO THE SCENE
+    void DiscardModelInstance(int instanceIndex)
+    {
+        meshCount -= static_cast<int>(modelInstances[instanceIndex].meshIDs.size());
+        modelInstances.erase(modelInstances.begin() + instanceIndex);
     }
 
     int CreateModelInstance(int modelIndex)
@@ -150,7 +183,8 @@ public:
         for (int i=0; i<models[modelIndex].submeshPtrs.size(); i++)
         {
             instance.submeshPtrs.push_back(models[modelIndex].submeshPtrs[i]);
-            instance.meshIDs.push_back(meshCount++);
+            instance.meshIDs.push_back(nextMeshID++);
+            meshCount++;
         }
         modelInstances.push_back(instance);
         return modelInstances.size() - 1;
@@ -158,111 +192,83 @@ public:
 
     void AddModelToScene(Model* model)
     {
-        glUseProgram(pathtraceShader);
         model->inScene = true;
-        glUniform1i(glGetUniformLocation(pathtraceShader, "u_meshCount"), meshCount);
-        
 
-        // CALCULATE BUFFER SIZES
-        uint32_t appendVertexBufferSize = 0;
-        uint32_t appendIndexBufferSize = 0;
-        uint32_t appendBvhBufferSize = 0;
-        uint32_t appendPartitionBufferSize = model->submeshPtrs.size() * sizeof(MeshPartition);
-        for (Mesh* mesh : model->submeshPtrs) 
-        {
-            // ACCUMULATE BUFFER SPACE USED
-            appendVertexBufferSize += mesh->vertices.size() * sizeof(Vertex);
-            appendIndexBufferSize += mesh->indices.size() * sizeof(uint32_t);
-            appendBvhBufferSize += mesh->nodesUsed * sizeof(BVH_Node);
-        }
+        // GET PARTITION BUFFER MAPPING
+        uint64_t appendPartitionBufferSize = model->submeshPtrs.size() * sizeof(MeshPartition);
+        PartitionBuffer.GrowBuffer(appendPartitionBufferSize);
+        void* mappedPartitionBuffer = PartitionBuffer.GetMappedBuffer(PartitionBuffer.UsedCapacity() - appendPartitionBufferSize, appendPartitionBufferSize);
 
-        // ENSURE THERE IS SPACE AVAILABLE
-        if (VertexBuffer.FindAvailableSpace(appendVertexBufferSize) == -1) VertexBuffer.GrowBuffer(appendVertexBufferSize);
-        if (IndexBuffer.FindAvailableSpace(appendIndexBufferSize) == -1) IndexBuffer.GrowBuffer(appendIndexBufferSize);
-        if (BvhBuffer.FindAvailableSpace(appendBvhBufferSize) == -1) BvhBuffer.GrowBuffer(appendBvhBufferSize);
-        
-        // GET BUFFER OFFSETS
-        Mesh* firstMesh = model->submeshPtrs[0];
-        uint32_t firstID = model->meshIDs[0];
-        int vertexBufferOffset = VertexBuffer.FindAvailableSpace(firstMesh->vertices.size() * sizeof(Vertex));
-        int indexBufferOffset = IndexBuffer.FindAvailableSpace(firstMesh->indices.size() * sizeof(uint32_t));
-        int bvhBufferOffset = BvhBuffer.FindAvailableSpace(firstMesh->nodesUsed * sizeof(BVH_Node));
-
-        // CREATE BUFFER PARTITION ITEMS
+        uint64_t partitionOffset = 0;
         for (int i=0; i<model->meshIDs.size(); i++)
         {   
             Mesh* mesh = model->submeshPtrs[i];
             uint32_t id = model->meshIDs[i];
-            VertexBuffer.OccupyRegion(mesh->vertices.size() * sizeof(Vertex), id);
-            IndexBuffer.OccupyRegion(mesh->indices.size() * sizeof(uint32_t), id);
-            BvhBuffer.OccupyRegion(mesh->nodesUsed * sizeof(BVH_Node), id);
-        }
 
-        // BUFFER MAPPINGS
-        void* mappedVertexBuffer;
-        void* mappedIndexBuffer;
-        void* mappedBvhBuffer;
-        void* mappedPartitionBuffer;
-        mappedVertexBuffer = VertexBuffer.GetMappedBuffer(vertexBufferOffset, appendVertexBufferSize);
-        mappedIndexBuffer = IndexBuffer.GetMappedBuffer(indexBufferOffset, appendIndexBufferSize);
-        mappedBvhBuffer = BvhBuffer.GetMappedBuffer(bvhBufferOffset, appendBvhBufferSize);
+            // CALCULATE BUFFER SIZES
+            uint64_t vertexBufferSize = mesh->vertices.size() * sizeof(Vertex);
+            uint64_t indexBufferSize = mesh->indices.size() * sizeof(uint32_t);
+            uint64_t bvhBufferSize = mesh->nodesUsed * sizeof(BVH_Node);
+
+            // FIND A PAGE WITH ROOM FOR ALL OF THE MESH DATA, OR TAKE THE WHOLE MODEL BACK OUT
+            uint32_t page = FindGeometryPage(vertexBufferSize, indexBufferSize, bvhBufferSize);
+            if (page == pageCount)
+            {
+                PartitionBuffer.UnmapBuffer();
+                for (int j=0; j<i; j++)
+                {
+                    VertexBuffer.DeleteItem(model->meshIDs[j]);
+                    IndexBuffer.DeleteItem(model->meshIDs[j]);
+                    BvhBuffer.DeleteItem(model->meshIDs[j]);
+                    sceneQuery.RemoveInstance(sceneQuery.InstanceCount() - 1);
+                }
+                PartitionBuffer.DeleteShift(PartitionBuffer.UsedCapacity() - appendPartitionBufferSize, appendPartitionBufferSize);
+                model->inScene = false;
+                throw std::runtime_error("[AddModelToScene] <Error> \"" + std::string(model->name) + "\" does not fit in the " + std::to_string(pageCount) + " geometry pages");
+            }
+
+            // CREATE BUFFER PARTITION ITEMS
+            uint64_t vertexBufferOffset = VertexBuffer.OccupyRegion(page, vertexBufferSize, id);
+            uint64_t indexBufferOffset = IndexBuffer.OccupyRegion(page, indexBufferSize, id);
+            uint64_t bvhBufferOffset = BvhBuffer.OccupyRegion(page, bvhBufferSize, id);
 
-        // GET PARTITION BUFFER MAPPING
-        PartitionBuffer.GrowBuffer(appendPartitionBufferSize);
-        mappedPartitionBuffer = PartitionBuffer.GetMappedBuffer(PartitionBuffer.UsedCapacity() - appendPartitionBufferSize, appendPartitionBufferSize);
-
-        // INIT MESH PARTITIONS
-        uint32_t vertexStart = static_cast<uint32_t>(vertexBufferOffset / sizeof(Vertex));
-        uint32_t indexStart = static_cast<uint32_t>(indexBufferOffset / sizeof(uint32_t));
-        uint32_t bvhStart = static_cast<uint32_t>(bvhBufferOffset / sizeof(BVH_Node));
-        std::vector<MeshPartition> meshPartitions;
-        for (Mesh* mesh : model->submeshPtrs) 
-        {
             // CREATE NEW MESH PARTITION
-            MeshPartition mPart;
-            mPart.verticesStart = vertexStart;
-            mPart.indicesStart = indexStart;
+            MeshPartition mPart{};
+            mPart.verticesStart = static_cast<uint32_t>(vertexBufferOffset / sizeof(Vertex));
+            mPart.indicesStart = static_cast<uint32_t>(indexBufferOffset / sizeof(uint32_t));
             mPart.materialIndex = 0;
-            mPart.bvhNodeStart = bvhStart;
+            mPart.bvhNodeStart = static_cast<uint32_t>(bvhBufferOffset / sizeof(BVH_Node));
             mesh->UpdateInverseTransformMat();
             mPart.inverseTransform = mesh->inverseTransform;
-            vertexStart += mesh->vertices.size();
-            indexStart += mesh->indices.size();
-            bvhStart += mesh->nodesUsed;
-            meshPartitions.push_back(mPart);
-        }
+            mPart.transform = mesh->transform;
+            mPart.page = page;
 
-        // COPY BUFFER DATA TO GPU
-        uint32_t vertexOffset = 0;
-        uint32_t indexOffset = 0;
-        uint32_t bvhOffset = 0;
-        uint32_t partitionOffset = 0;
-        for (const Mesh* mesh : model->submeshPtrs) 
-        {
-            memcpy((char*)mappedVertexBuffer + vertexOffset, mesh->vertices.data(), mesh->vertices.size() * sizeof(Vertex));
-            memcpy((char*)mappedIndexBuffer + indexOffset, mesh->indices.data(), mesh->indices.size() * sizeof(uint32_t));
-            memcpy((char*)mappedBvhBuffer + bvhOffset, mesh->bvhNodes, mesh->nodesUsed * sizeof(BVH_Node));
-            vertexOffset += mesh->vertices.size() * sizeof(Vertex);
-            indexOffset += mesh->indices.size() * sizeof(uint32_t);
-            bvhOffset += mesh->nodesUsed * sizeof(BVH_Node);
-        }
-        for (const MeshPartition& partition : meshPartitions)
-        {
-            memcpy((char*)mappedPartitionBuffer + partitionOffset, &partition, sizeof(MeshPartition));
+            // COPY BUFFER DATA TO GPU
+            void* mappedVertexBuffer = VertexBuffer.GetMappedBuffer(page, vertexBufferOffset, vertexBufferSize);
+            memcpy(mappedVertexBuffer, mesh->vertices.data(), vertexBufferSize);
+            VertexBuffer.UnmapBuffer(page);
+
+            void* mappedIndexBuffer = IndexBuffer.GetMappedBuffer(page, indexBufferOffset, indexBufferSize);
+            memcpy(mappedIndexBuffer, mesh->indices.data(), indexBufferSize);
+            IndexBuffer.UnmapBuffer(page);
+
+            void* mappedBvhBuffer = BvhBuffer.GetMappedBuffer(page, bvhBufferOffset, bvhBufferSize);
+            memcpy(mappedBvhBuffer, mesh->bvhNodes, bvhBufferSize);
+            BvhBuffer.UnmapBuffer(page);
+
+            memcpy((char*)mappedPartitionBuffer + partitionOffset, &mPart, sizeof(MeshPartition));
             partitionOffset += sizeof(MeshPartition);
+            sceneQuery.AddInstance(mesh);
         }
 
         // UNMAP BUFFERS
-        VertexBuffer.UnmapBuffer();
-        IndexBuffer.UnmapBuffer();
-        BvhBuffer.UnmapBuffer();
         PartitionBuffer.UnmapBuffer();
     }
     
     void UpdateMeshMaterial(uint32_t meshIndex, uint32_t materialIndex)
     {       
         // CALCULATE BUFFER OFFSET
-        uint32_t bufferOffset = meshIndex * sizeof(MeshPartition) + 2 * sizeof(uint32_t);
+        uint64_t bufferOffset = meshIndex * sizeof(MeshPartition) + 2 * sizeof(uint32_t);
 
         // GET MAPPED BUFFER
         void* mappedPartitionBuffer = PartitionBuffer.GetMappedBuffer(bufferOffset, sizeof(uint32_t));
@@ -277,27 +283,43 @@ public:
     void UpdateMeshTransform(Mesh* mesh, uint32_t meshIndex)
     {
         // CALCULATE BUFFER OFFSET
-        uint32_t bufferOffset = meshIndex * sizeof(MeshPartition) + 4 * sizeof(uint32_t);
+        uint64_t bufferOffset = meshIndex * sizeof(MeshPartition) + 4 * sizeof(uint32_t);
 
-        // GET MAPPED BUFFER
-        void* mappedPartitionBuffer = PartitionBuffer.GetMappedBuffer(bufferOffset, sizeof(glm::mat4));
+        // GET MAPPED BUFFER, INVERSE AND FORWARD TRANSFORM ARE ADJACENT
+        void* mappedPartitionBuffer = PartitionBuffer.GetMappedBuffer(bufferOffset, 2 * sizeof(glm::mat4));
 
         // COPY NEW PARTITION BUFFER DATA
         memcpy((char*)mappedPartitionBuffer, glm::value_ptr(mesh->inverseTransform), sizeof(glm::mat4));
+        memcpy((char*)mappedPartitionBuffer + sizeof(glm::mat4), glm::value_ptr(mesh->transform), sizeof(glm::mat4));
 
         // UNMAP BUFFER
         PartitionBuffer.UnmapBuffer();
+        sceneQuery.SetTransform(meshIndex, mesh->inverseTransform);
     }
 
     int meshCount;
 
 private:
+    uint32_t pageCount;
+
+    // POOL ITEM IDS ARE NEVER REUSED, meshCount DROPS ON DELETE AND WOULD HAND OUT A LIVE ID
+    uint32_t nextMeshID;
+
     // DYNAMIC SHADER STORAGE BUFFERS
-    DynamicPoolBuffer VertexBuffer;
-    DynamicPoolBuffer IndexBuffer;
-    DynamicPoolBuffer BvhBuffer;
+    PagedPoolBuffer VertexBuffer;
+    PagedPoolBuffer IndexBuffer;
+    PagedPoolBuffer BvhBuffer;
     DynamicContiguousBuffer PartitionBuffer;
 
-    // PATH TRACING SHADER ID
-    unsigned int pathtraceShader;
+    uint32_t FindGeometryPage(uint64_t vertexBufferSize, uint64_t indexBufferSize, uint64_t bvhBufferSize)
+    {
+        for (uint32_t page=0; page<pageCount; page++)
+        {
+            bool vertexFits = VertexBuffer.CanFit(page, vertexBufferSize);
+            bool indexFits = IndexBuffer.CanFit(page, indexBufferSize);
+            bool bvhFits = BvhBuffer.CanFit(page, bvhBufferSize);
+            if (vertexFits && indexFits && bvhFits) return page;
+        }
+        return pageCount;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,257 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+
+// STANDARD LIBRARY
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+// FRAMES KEPT FOR THE GRAPHS AND THE CSV EXPORT
+#define PROFILER_HISTORY 240
+
+// FRAMES A GPU TIMESTAMP MAY TAKE TO COME BACK BEFORE ITS STAGE SKIPS A SAMPLE
+#define PROFILER_QUERY_FRAMES 4
+
+// PER STAGE CPU TIMERS AND GPU TIMESTAMP PAIRS FOR THE FRAME LOOP, PLUS PER FRAME COUNTERS.
+// STAGES AND COUNTERS ARE CREATED THE FIRST TIME THEIR NAME IS SEEN AND KEEP THAT ORDER. GPU
+// TIMES ARE READ BACK WITHOUT WAITING AND FILED UNDER THE FRAME THAT ISSUED THEM. TIMESTAMPS
+// RATHER THAN GL_TIME_ELAPSED SO STAGES CAN NEST AND OVERLAP THE BATCH TIMER OF THE RENDERER.
+// NOTHING IS RECORDED WHILE DISABLED
+namespace Profiler
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Stage
+    {
+        std::string name;
+        bool gpu = false;
+        Clock::time_point cpuStart;
+        float cpuTime[PROFILER_HISTORY] = {}; // MILLISECONDS
+        float gpuTime[PROFILER_HISTORY] = {}; // MILLISECONDS, NEGATIVE UNTIL THE RESULT IS BACK
+
+        // TIMESTAMP PAIRS IN FLIGHT, ONE SLOT PER RECENT FRAME
+        unsigned int queries[PROFILER_QUERY_FRAMES][2] = {};
+        uint64_t queryFrame[PROFILER_QUERY_FRAMES] = {};
+        bool queryPending[PROFILER_QUERY_FRAMES] = {};
+        bool queryOpen = false;
+    };
+
+    struct Counter
+    {
+        std::string name;
+        float value[PROFILER_HISTORY] = {};
+    };
+
+    inline bool enabled = false;
+    inline uint64_t frameIndex = 0;
+    inline uint64_t firstFrame = 0;
+    inline Clock::time_point frameStart;
+    inline float frameTime[PROFILER_HISTORY] = {};
+    inline std::vector<Stage> stages;
+    inline std::vector<Counter> counters;
+
+    inline uint32_t Slot(uint64_t frame)
+    {
+        return static_cast<uint32_t>(frame % PROFILER_HISTORY);
+    }
+
+    // FRAMES HELD IN THE HISTORY, OLDEST IS frameIndex - FrameCount()
+    inline uint32_t FrameCount()
+    {
+        return static_cast<uint32_t>(std::min<uint64_t>(frameIndex - firstFrame, PROFILER_HISTORY));
+    }
+
+    inline Stage& FindStage(const char* name)
+    {
+        for (Stage& stage : stages) if (stage.name == name) return stage;
+        stages.emplace_back();
+        stages.back().name = name;
+        for (float& time : stages.back().gpuTime) time = -1.0f;
+        return stages.back();
+    }
+
+    inline Counter& FindCounter(const char* name)
+    {
+        for (Counter& counter : counters) if (counter.name == name) return counter;
+        counters.emplace_back();
+        counters.back().name = name;
+        return counters.back();
+    }
+
+    // FILES FINISHED TIMESTAMPS UNDER THEIR FRAME, DROPPED IF THE FRAME LEFT THE HISTORY
+    inline void CollectQueries()
+    {
+        for (Stage& stage : stages)
+        {
+            for (uint32_t i=0; i<PROFILER_QUERY_FRAMES; i++)
+            {
+                if (!stage.queryPending[i]) continue;
+                int available = 0;
+                glGetQueryObjectiv(stage.queries[i][1], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) continue;
+
+                uint64_t begin = 0, end = 0;
+                glGetQueryObjectui64v(stage.queries[i][0], GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(stage.queries[i][1], GL_QUERY_RESULT, &end);
+                stage.queryPending[i] = false;
+                if (frameIndex - stage.queryFrame[i] < PROFILER_HISTORY)
+                {
+                    stage.gpuTime[Slot(stage.queryFrame[i])] = static_cast<float>(end - begin) / 1000000.0f;
+                }
+            }
+        }
+    }
+
+    inline void BeginFrame()
+    {
+        if (!enabled) return;
+        CollectQueries();
+
+        // CLEAR THE SLOT THIS FRAME REUSES
+        uint32_t slot = Slot(frameIndex);
+        frameTime[slot] = 0.0f;
+        for (Stage& stage : stages)
+        {
+            stage.cpuTime[slot] = 0.0f;
+            stage.gpuTime[slot] = -1.0f;
+        }
+        for (Counter& counter : counters) counter.value[slot] = 0.0f;
+        frameStart = Clock::now();
+    }
+
+    inline void EndFrame()
+    {
+        if (!enabled) return;
+        frameTime[Slot(frameIndex)] = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+        frameIndex++;
+    }
+
+    // gpu ALSO BRACKETS THE COMMANDS ISSUED BETWEEN BEGIN AND END WITH TIMESTAMPS
+    inline void BeginStage(const char* name, bool gpu = false)
+    {
+        if (!enabled) return;
+        Stage& stage = FindStage(name);
+        stage.cpuStart = Clock::now();
+
+        if (!gpu) return;
+        stage.gpu = true;
+        uint32_t querySlot = static_cast<uint32_t>(frameIndex % PROFILER_QUERY_FRAMES);
+        if (stage.queryPending[querySlot]) return; // STILL WAITING ON AN OLDER FRAME, SKIP A SAMPLE
+        if (stage.queries[querySlot][0] == 0) glGenQueries(2, stage.queries[querySlot]);
+        glQueryCounter(stage.queries[querySlot][0], GL_TIMESTAMP);
+        stage.queryOpen = true;
+    }
+
+    inline void EndStage(const char* name)
+    {
+        if (!enabled) return;
+        Stage& stage = FindStage(name);
+        stage.cpuTime[Slot(frameIndex)] += std::chrono::duration<float, std::milli>(Clock::now() - stage.cpuStart).count();
+
+        if (!stage.queryOpen) return;
+        uint32_t querySlot = static_cast<uint32_t>(frameIndex % PROFILER_QUERY_FRAMES);
+        glQueryCounter(stage.queries[querySlot][1], GL_TIMESTAMP);
+        stage.queryOpen = false;
+        stage.queryPending[querySlot] = true;
+        stage.queryFrame[querySlot] = frameIndex;
+    }
+
+    inline void SetCounter(const char* name, float value)
+    {
+        if (!enabled) return;
+        FindCounter(name).value[Slot(frameIndex)] = value;
+    }
+
+    // STARTS THE GRAPHS AND EXPORT OVER FROM THE NEXT FRAME, TIMESTAMPS STILL IN FLIGHT ARE DROPPED
+    inline void Reset()
+    {
+        firstFrame = frameIndex;
+        for (Stage& stage : stages)
+        {
+            for (bool& pending : stage.queryPending) pending = false;
+            stage.queryOpen = false;
+        }
+    }
+
+    // MEAN OVER THE LAST frames FRAMES, GPU SLOTS STILL IN FLIGHT ARE LEFT OUT
+    inline float Average(const float* values, uint32_t frames)
+    {
+        frames = std::min(frames, FrameCount());
+        float total = 0.0f;
+        uint32_t count = 0;
+        for (uint32_t i=1; i<=frames; i++)
+        {
+            float value = values[Slot(frameIndex - i)];
+            if (value < 0.0f) continue;
+            total += value;
+            count++;
+        }
+        return count == 0 ? -1.0f : total / static_cast<float>(count);
+    }
+
+    // OLDEST TO NEWEST COPY OF A HISTORY FOR PLOTTING, MISSING GPU SAMPLES BECOME ZERO
+    inline std::vector<float> Ordered(const float* values)
+    {
+        uint32_t frames = FrameCount();
+        std::vector<float> ordered(frames);
+        for (uint32_t i=0; i<frames; i++) ordered[i] = std::max(values[Slot(frameIndex - frames + i)], 0.0f);
+        return ordered;
+    }
+
+    // ONE ROW PER FRAME IN THE HISTORY, GPU TIMES STILL IN FLIGHT ARE LEFT EMPTY
+    inline bool ExportCSV(const char* filepath)
+    {
+        std::ofstream file(filepath);
+        if (!file)
+        {
+            std::cerr << "[Profiler::ExportCSV] Failed! Could not open: " << filepath << std::endl;
+            return false;
+        }
+
+        file << "frame,frame_ms";
+        for (const Stage& stage : stages)
+        {
+            file << "," << stage.name << "_cpu_ms";
+            if (stage.gpu) file << "," << stage.name << "_gpu_ms";
+        }
+        for (const Counter& counter : counters) file << "," << counter.name;
+        file << "\n";
+
+        uint32_t frames = FrameCount();
+        for (uint32_t i=0; i<frames; i++)
+        {
+            uint64_t frame = frameIndex - frames + i;
+            uint32_t slot = Slot(frame);
+            file << frame << "," << frameTime[slot];
+            for (const Stage& stage : stages)
+            {
+                file << "," << stage.cpuTime[slot];
+                if (!stage.gpu) continue;
+                file << ",";
+                if (stage.gpuTime[slot] >= 0.0f) file << stage.gpuTime[slot];
+            }
+            for (const Counter& counter : counters) file << "," << counter.value[slot];
+            file << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+
+    inline void Shutdown()
+    {
+        for (Stage& stage : stages)
+        {
+            for (uint32_t i=0; i<PROFILER_QUERY_FRAMES; i++)
+            {
+                if (stage.queries[i][0] != 0) glDeleteQueries(2, stage.queries[i]);
+            }
+        }
+        stages.clear();
+        counters.clear();
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <GL/glew.h>
+#include "../lib/glm/glm.hpp"
 #include <string>
 #include "shader.h"
 
@@ -68,11 +69,13 @@ public:
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
     }
 
-    void RenderToViewport(const unsigned int& DisplayTexture)
+    // uvScale IS THE FRACTION OF THE TEXTURE HOLDING THE IMAGE, (1, 1) FOR THE WHOLE TEXTURE
+    void RenderToViewport(const unsigned int& DisplayTexture, const glm::vec2& uvScale)
     {
         glBindFramebuffer(GL_FRAMEBUFFER, FBO);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glUseProgram(quadShader);
+        glUniform2f(glGetUniformLocation(quadShader, "u_uvScale"), uvScale.x, uvScale.y);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, DisplayTexture);
         glBindVertexArray(quadVAO);
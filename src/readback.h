@@ -0,0 +1,329 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+
+// STANDARD LIBRARY
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+// PROJECT HEADERS
+#include "memory_tracker.h"
+
+// IMMUTABLE STORAGE, MAPPED ONCE FOR AS LONG AS IT LIVES
+struct ReadbackPackBuffer
+{
+    unsigned int buffer = 0;
+    size_t capacity = 0;
+    uint8_t* mapped = nullptr;
+};
+
+// PACK BUFFERS NO REQUEST IS USING. BYTES ARE DROPPED ON ANY THREAD, SO IT HAS ITS OWN LOCK
+struct ReadbackPool
+{
+    std::mutex mutex;
+    std::vector<ReadbackPackBuffer> idle;
+};
+
+struct ReadbackLease
+{
+    std::shared_ptr<ReadbackPool> pool;
+    ReadbackPackBuffer packBuffer;
+    size_t size = 0;
+
+    ~ReadbackLease()
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->idle.push_back(packBuffer);
+    }
+};
+
+// THE BYTES OF ONE READBACK, READ STRAIGHT FROM ITS MAPPED PACK BUFFER. COPIES SHARE THE BUFFER
+// AND THE LAST ONE DROPPED GIVES IT BACK TO THE POOL. EMPTY WHEN THE BUFFER COULD NOT BE MAPPED
+class ReadbackBytes
+{
+public:
+
+    const uint8_t* data() const { return lease ? lease->packBuffer.mapped : nullptr; }
+    size_t size() const { return lease ? lease->size : 0; }
+    bool empty() const { return size() == 0; }
+
+private:
+
+    friend class ReadbackService;
+    std::shared_ptr<ReadbackLease> lease;
+};
+
+// GPU TO CPU COPIES THAT NEVER WAIT ON THE GPU. EACH REQUEST COPIES INTO A PERSISTENTLY MAPPED PACK
+// BUFFER FROM A SMALL POOL BEHIND THE WORK ALREADY QUEUED AND FENCES IT, Poll HANDS THE MAPPED
+// BYTES TO THE CALLBACK ON THE GL THREAD A FRAME OR MORE LATER WITHOUT COPYING THEM. SLOW CPU WORK
+// LIKE FLIPPING AND ENCODING GOES TO RunInBackground, WHICH CAN KEEP THE BYTES UNTIL IT IS DONE
+class ReadbackService
+{
+public:
+
+    typedef std::function<void(const ReadbackBytes& bytes)> Callback;
+
+    // BYTES STILL HELD ELSEWHERE MUST BE DROPPED BEFORE THE SERVICE
+    ~ReadbackService()
+    {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            stopping = true;
+        }
+        taskAdded.notify_all();
+        if (worker.joinable()) worker.join();
+        completed.clear();
+
+        for (Request& request : requests)
+        {
+            glDeleteSync(request.fence);
+            DeletePackBuffer(request.packBuffer);
+        }
+        requests.clear();
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        for (ReadbackPackBuffer& packBuffer : pool->idle) DeletePackBuffer(packBuffer);
+        pool->idle.clear();
+    }
+
+    // LEVEL 0 OF texture, size MUST MATCH ITS DIMENSIONS IN format AND type
+    void ReadTexture(unsigned int texture, GLenum format, GLenum type, size_t size, Callback callback)
+    {
+        Request request = CreateRequest(size, std::move(callback));
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, request.packBuffer.buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGetTexImage(GL_TEXTURE_2D, 0, format, type, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        QueueRequest(request);
+    }
+
+    void ReadBuffer(unsigned int buffer, size_t offset, size_t size, Callback callback)
+    {
+        Request request = CreateRequest(size, std::move(callback));
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, request.packBuffer.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), 0, static_cast<GLsizeiptr>(size));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        QueueRequest(request);
+    }
+
+    // CALLED ONCE A FRAME. FENCES SIGNAL IN ISSUE ORDER, SO ONLY THE OLDEST REQUESTS ARE CHECKED
+    void Poll()
+    {
+        while (!requests.empty())
+        {
+            GLenum status = glClientWaitSync(requests.front().fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+            Deliver();
+        }
+        RunCompleted();
+        TrimPool();
+    }
+
+    // FIFO ON ONE WORKER THREAD, STARTED THE FIRST TIME IT IS NEEDED. then RUNS FROM A LATER Poll
+    // ON THE GL THREAD, FOR RESULTS THAT GO BACK TO THE GPU
+    void RunInBackground(std::function<void()> task, std::function<void()> then = nullptr)
+    {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            tasks.push_back({ std::move(task), std::move(then) });
+            if (!worker.joinable()) worker = std::thread([this]() { WorkerLoop(); });
+        }
+        taskAdded.notify_one();
+    }
+
+    // BLOCKS UNTIL EVERY READBACK HAS BEEN DELIVERED AND EVERY BACKGROUND TASK HAS RUN, FOR
+    // BATCH RENDERS THAT EXIT STRAIGHT AFTER AN EXPORT. CONTINUATIONS MAY QUEUE MORE WORK
+    void Finish()
+    {
+        while (true)
+        {
+            while (!requests.empty())
+            {
+                while (glClientWaitSync(requests.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+                Deliver();
+            }
+            {
+                std::unique_lock<std::mutex> lock(taskMutex);
+                taskDone.wait(lock, [this]() { return tasks.empty() && !taskRunning; });
+                if (completed.empty() && requests.empty()) return;
+            }
+            RunCompleted();
+        }
+    }
+
+private:
+
+    // IDLE BUFFERS KEPT FOR REUSE, ENOUGH FOR THE THREE IMAGES OF A FINAL EXPORT AND THE GROUP ERRORS
+    static constexpr size_t MaxIdlePackBuffers = 4;
+
+    struct Request
+    {
+        ReadbackPackBuffer packBuffer;
+        size_t size;
+        GLsync fence;
+        Callback callback;
+    };
+
+    struct Task
+    {
+        std::function<void()> task;
+        std::function<void()> then;
+    };
+
+    std::deque<Request> requests;
+    std::shared_ptr<ReadbackPool> pool = std::make_shared<ReadbackPool>();
+
+    std::thread worker;
+    std::mutex taskMutex;
+    std::condition_variable taskAdded;
+    std::condition_variable taskDone;
+    std::deque<Task> tasks;
+    std::deque<std::function<void()>> completed;
+    bool taskRunning = false;
+    bool stopping = false;
+
+    Request CreateRequest(size_t size, Callback callback)
+    {
+        Request request;
+        request.size = size;
+        request.callback = std::move(callback);
+        request.packBuffer = AcquirePackBuffer(size);
+        return request;
+    }
+
+    // THE SMALLEST IDLE BUFFER THAT FITS, OR A NEW ONE
+    ReadbackPackBuffer AcquirePackBuffer(size_t size)
+    {
+        ReadbackPackBuffer packBuffer;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            std::vector<ReadbackPackBuffer>& idle = pool->idle;
+            auto best = idle.end();
+            for (auto it = idle.begin(); it != idle.end(); it++)
+            {
+                if (it->capacity >= size && (best == idle.end() || it->capacity < best->capacity)) best = it;
+            }
+            if (best != idle.end())
+            {
+                packBuffer = *best;
+                idle.erase(best);
+            }
+        }
+        if (packBuffer.buffer != 0) return packBuffer;
+
+        // COHERENT, SO A SIGNALLED FENCE IS ALL THE CPU NEEDS BEFORE READING THE MAPPING
+        GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        packBuffer.capacity = std::max<size_t>(size, 1);
+        glGenBuffers(1, &packBuffer.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer.buffer);
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(packBuffer.capacity), nullptr, flags);
+        packBuffer.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(packBuffer.capacity), flags));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        MemoryTracker::Track("readback", packBuffer.buffer, packBuffer.capacity, packBuffer.capacity);
+        return packBuffer;
+    }
+
+    // BUFFERS ARE ONLY DELETED ON THE GL THREAD, AFTER A BURST OF READBACKS THE SMALLEST IDLE ONES GO FIRST
+    void TrimPool()
+    {
+        std::vector<ReadbackPackBuffer> evicted;
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            std::vector<ReadbackPackBuffer>& idle = pool->idle;
+            auto smaller = [](const ReadbackPackBuffer& a, const ReadbackPackBuffer& b) { return a.capacity < b.capacity; };
+            while (idle.size() > MaxIdlePackBuffers)
+            {
+                auto smallest = std::min_element(idle.begin(), idle.end(), smaller);
+                evicted.push_back(*smallest);
+                idle.erase(smallest);
+            }
+        }
+        for (ReadbackPackBuffer& packBuffer : evicted) DeletePackBuffer(packBuffer);
+    }
+
+    void DeletePackBuffer(ReadbackPackBuffer& packBuffer)
+    {
+        if (packBuffer.mapped)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        MemoryTracker::Release("readback", packBuffer.buffer);
+        glDeleteBuffers(1, &packBuffer.buffer);
+        packBuffer = ReadbackPackBuffer();
+    }
+
+    void QueueRequest(Request& request)
+    {
+        request.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        requests.push_back(std::move(request));
+    }
+
+    // THE COPY HAS LANDED IN THE MAPPING, THE CALLBACK GETS IT WITHOUT A COPY
+    void Deliver()
+    {
+        Request request = std::move(requests.front());
+        requests.pop_front();
+        glDeleteSync(request.fence);
+
+        // A FAILED MAP DELIVERS NO BYTES AND THE BUFFER IS NOT KEPT
+        ReadbackBytes bytes;
+        if (request.packBuffer.mapped)
+        {
+            bytes.lease = std::make_shared<ReadbackLease>();
+            bytes.lease->pool = pool;
+            bytes.lease->packBuffer = request.packBuffer;
+            bytes.lease->size = request.size;
+        }
+        else DeletePackBuffer(request.packBuffer);
+
+        request.callback(bytes);
+    }
+
+    void WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lock(taskMutex);
+        while (true)
+        {
+            taskAdded.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+            taskRunning = true;
+            lock.unlock();
+            task.task();
+            lock.lock();
+            if (task.then) completed.push_back(std::move(task.then));
+            taskRunning = false;
+            taskDone.notify_all();
+        }
+    }
+
+    // CONTINUATIONS OF FINISHED TASKS, RUN OUTSIDE THE LOCK SO THEY CAN QUEUE MORE WORK
+    void RunCompleted()
+    {
+        std::deque<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            ready.swap(completed);
+        }
+        for (std::function<void()>& then : ready) then();
+    }
+};
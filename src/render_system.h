@@ -4,54 +4,235 @@
 #include <GL/glew.h>
 
 // STANDARD LIBRARY
+#include <cmath>
 #include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <queue>
+#include <functional>
+#include <memory>
+#include <string>
 #include <iostream>
+#include <algorithm>
 
 // PROJECT HEADERS
 #include "debug.h"
+#include "memory_tracker.h"
 #include "camera.h"
+#include "tile_scheduler.h"
+#include "dynamic_resolution.h"
+#include "denoiser.h"
 #include "quad_renderer.h"
 #include "thumbnail_renderer.h"
+#include "checkpoint.h"
+#include "image_export.h"
+#include "readback.h"
+#include "profiler.h"
 
-struct RaycastHit
+
+// STOP CONDITIONS FOR AN UNATTENDED RENDER, A ZERO DISABLES THAT CONDITION
+struct RenderJob
 {
-    int meshIndex;
+    uint32_t targetSamples = 0;
+    float timeBudget = 0.0f; // SECONDS
+    float targetError = 0.0f; // LARGEST RELATIVE ERROR OF ANY TILE
+    bool autoExport = true;
+    std::string exportPath = "render.png";
 };
 
+enum class RenderJobStopReason
+{
+    None,
+    TargetSamples,
+    TimeBudget,
+    TargetError,
+    Cancelled
+};
 
-struct PathVertex
+struct RenderJobResult
 {
-    alignas(16) glm::vec3 surfacePosition;
-    alignas(16) glm::vec3 surfaceNormal;
-    alignas(16) glm::vec3 surfaceColour;
-    alignas(16) glm::vec3 incommingDir;
-    alignas(16) glm::vec3 directLight;
-    float surfaceRoughness;
-    float surfaceEmission;
-    int hitSky;
-    int inside;
-    int refracted;
+    RenderJob job;
+    RenderJobStopReason reason = RenderJobStopReason::None;
+    uint32_t samples = 0;
+    float elapsedTime = 0.0f;
+    float maxError = 0.0f;
 };
 
-struct RenderTile
+// PER FRAME SHADER STATE, MATCHES THE FrameConstants UNIFORM BLOCK (STD140)
+struct FrameConstants
 {
-    int x;
-    int y;
-    int width;
-    int height;
-    float estimatedTime;
+    CameraConstants cameraInfo;
+    alignas(16) glm::vec3 skyColour;
+    float skyBrightness;
+    uint32_t frameCount;
+    uint32_t accumulationFrame;
+    uint32_t bounces;
+    float resolutionScale;
+    int32_t meshCount;
+    uint32_t directionalLightCount;
+    uint32_t pointLightCount;
+    uint32_t spotlightCount;
+    uint32_t debugMode;
+    uint32_t statsSlot;
+    uint32_t samplesPerDispatch;
+    uint32_t renderWidth; // RENDERED AREA, THE TARGETS CAN BE ALLOCATED LARGER
+    uint32_t renderHeight;
+};
+static_assert(offsetof(FrameConstants, skyColour) == 96 && offsetof(FrameConstants, debugMode) == 144, "FrameConstants must follow std140 layout");
 
-    RenderTile()
-    {
-        x = 0;
-        y = 0;
-        width = 0;
-        height = 0;
-        estimatedTime = 0;
-    }
+struct DispatchIndirectCommand
+{
+    uint32_t numGroupsX;
+    uint32_t numGroupsY;
+    uint32_t numGroupsZ;
+};
+
+// GPU TIMER FOR ONE FRAME'S BATCH OF TILES, READ BACK A FRAME OR TWO AFTER ISSUE
+struct BatchTimerQuery
+{
+    unsigned int query;
+    std::vector<RenderTile> tiles;
+    uint32_t groupColumns; // WIDTH OF THE GRID THE TILES WERE CUT FROM, THE SETS DIFFER
+    float predictedTime;
+    uint32_t generation;
+    bool recordTiming;
+    bool pending;
+
+    // SETTINGS OF A NAVIGATION FRAME, FED BACK TO THE DYNAMIC RESOLUTION CONTROLLER
+    bool dynamic;
+    float resolutionScale;
+    uint32_t bounces;
+    uint32_t samples;
+
+    // PIXEL SAMPLES THE BATCH TRACES, FOR THE SAMPLES/SEC STATISTIC
+    uint64_t pixelSamples;
+};
+
+// WAVEFRONT PATH STATE, MATCHES THE STRUCTS IN shaders/include/wavefront.glsl
+struct WavefrontPath
+{
+    alignas(16) glm::vec3 origin;
+    uint32_t pixelIndex;
+    alignas(16) glm::vec3 dir;
+    uint32_t bounce;
+    alignas(16) glm::vec3 throughput;
+    uint32_t seed;
+    alignas(16) glm::vec3 radiance;
+    uint32_t alive;
+};
+
+struct WavefrontHit
+{
+    alignas(16) glm::vec3 pos;
+    uint32_t materialIndex;
+    alignas(16) glm::vec3 normal;
+    uint32_t frontFace;
+    glm::vec2 uv;
+    uint32_t hit;
+    uint32_t padding;
+};
+
+struct WavefrontShadowRay
+{
+    alignas(16) glm::vec3 origin;
+    float maxDist;
+    alignas(16) glm::vec3 dir;
+    uint32_t slot;
+};
+
+// QUEUE COUNTS AND THE INDIRECT ARGUMENTS THE KERNELS ARE DISPATCHED WITH
+struct WavefrontCounters
+{
+    uint32_t queueCounts[2];
+    uint32_t shadowCount;
+    uint32_t counterPadding;
+    DispatchIndirectCommand activeArgs;
+    uint32_t activePadding;
+    DispatchIndirectCommand shadowArgs;
+    uint32_t shadowPadding;
+};
+static_assert(sizeof(WavefrontPath) == 64 && sizeof(WavefrontHit) == 48 && sizeof(WavefrontShadowRay) == 32, "Wavefront structs must match the shader");
+static_assert(offsetof(WavefrontCounters, activeArgs) == 16 && offsetof(WavefrontCounters, shadowArgs) == 32, "WavefrontCounters must match the shader");
+
+// KERNELS OF THE WAVEFRONT PATH TRACER, ALL ZERO UNTIL SetWavefrontShaders
+struct WavefrontPrograms
+{
+    unsigned int generate = 0;
+    unsigned int extend = 0;
+    unsigned int shade = 0;
+    unsigned int shadow = 0;
+    unsigned int compact = 0;
+    unsigned int args = 0;
+};
+
+// ACCUMULATION IMAGES FOR ONE RENDER MODE. THE PREVIEW AND FINAL SETS STAY ALLOCATED SO SWITCHING
+// MODES IS FREE, AND EACH KEEPS ITS SAMPLES UNTIL THE CAMERA LEAVES THE POSE THEY WERE TAKEN AT
+struct RenderTargetSet
+{
+    unsigned int renderTexture = 0;
+    unsigned int displayTexture = 0;
+    unsigned int momentTexture = 0;
+    unsigned int firstHitTexture = 0;
+    unsigned int groupErrorBuffer = 0;
+    int width = 0; // ALLOCATED SIZE, THE RENDERED AREA CAN BE SMALLER
+    int height = 0;
+
+    // PROGRESS OF THE SET, PARKED HERE WHILE THE OTHER SET IS ACTIVE
+    uint32_t accumulationFrame = 0;
+    uint32_t frameCount = 0;
+    uint64_t poseHash = 0;
+    bool poseValid = false;
 };
 
+// BATCHES IN FLIGHT BEFORE THE CPU STOPS ISSUING NEW WORK
+#define BATCH_QUERY_COUNT 4
+
+// UNIFORM AND STORAGE BINDINGS OWNED BY THE RENDER SYSTEM
+#define FRAME_CONSTANTS_BINDING 0
+#define TILE_GROUP_BINDING 18
+#define GROUP_ERROR_BINDING 19
+#define WAVEFRONT_PATH_BINDING 20
+#define WAVEFRONT_HIT_BINDING 21
+#define WAVEFRONT_QUEUE_BINDING 22
+#define WAVEFRONT_SHADOW_RAY_BINDING 23
+#define WAVEFRONT_SHADOW_LIGHT_BINDING 24
+#define WAVEFRONT_COUNTER_BINDING 25
+#define RAY_STATS_BINDING 26
+
+// PATHS IN FLIGHT PER WAVEFRONT CHUNK, MUST MATCH shaders/include/wavefront.glsl
+#define WAVEFRONT_PATH_CAPACITY 524288
+#define WAVEFRONT_SHADOW_SLOTS 3
+
+// WAVEFRONT SHADER UNIFORM LOCATIONS
+#define WAVEFRONT_QUEUE_LOCATION 0
+#define WAVEFRONT_ARGS_MODE_LOCATION 1
+#define WAVEFRONT_GROUP_OFFSET_LOCATION 2
+
+// TEMPORAL SHADER UNIFORM LOCATIONS
+#define TEMPORAL_PREV_POS_LOCATION 0
+#define TEMPORAL_PREV_FORWARD_LOCATION 1
+#define TEMPORAL_PREV_RIGHT_LOCATION 2
+#define TEMPORAL_PREV_UP_LOCATION 3
+#define TEMPORAL_PREV_FOV_LOCATION 4
+#define TEMPORAL_PREV_SIZE_LOCATION 5
+#define TEMPORAL_HISTORY_VALID_LOCATION 6
+#define TEMPORAL_MAX_HISTORY_LOCATION 7
+
+// DENOISE SHADER UNIFORM LOCATIONS AND STAGES
+#define DENOISE_STAGE_LOCATION 0
+#define DENOISE_STEP_LOCATION 1
+#define DENOISE_EXTENT_LOCATION 2
+#define DENOISE_COLOUR_SIGMA_LOCATION 3
+#define DENOISE_PREPARE 0
+#define DENOISE_FILTER 1
+#define DENOISE_OUTPUT 2
+
+// A-TROUS FILTER STAGES, THE LAST ONE SPANS 4 * 2^(N-1) + 1 PIXELS
+#define DENOISE_ITERATIONS 5
+
+// GROUP TIME ASSUMED BEFORE ANY GPU TIMING HAS COME BACK (MILLISECONDS)
+#define INITIAL_GROUP_TIME 0.05f
+
 class RenderSystem
 {
 public:
@@ -61,58 +242,94 @@ public:
         VIEWPORT_WIDTH = width;
         VIEWPORT_HEIGHT = height;
 
-        int SCA_W = static_cast<int>(static_cast<float>(VIEWPORT_WIDTH) * resolutionScale);
-        int SCA_H = static_cast<int>(static_cast<float>(VIEWPORT_HEIGHT) * resolutionScale);
-
         qRenderer.PrepareQuadShader();
         qRenderer.CreateFrameBuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
-        
-        // RENDER TEXTURE SETUP
-        glGenTextures(1, &RenderTexture);
-        glBindTexture(GL_TEXTURE_2D, RenderTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, SCA_W, SCA_H, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glBindTexture(GL_TEXTURE_2D, 0);
 
-        // DISPLAY TEXTURE SETUP
-        glGenTextures(1, &DisplayTexture);
-        glBindTexture(GL_TEXTURE_2D, DisplayTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCA_W, SCA_H, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        // FINAL TARGETS AT THE STATIC RESOLUTION, PREVIEW TARGETS LARGE ENOUGH FOR ANY DYNAMIC SCALE
+        CreateTargets(finalTargets);
+        CreateTargets(previewTargets);
+        AllocateTargets(finalTargets, ScaledSize(VIEWPORT_WIDTH, resolutionScale), ScaledSize(VIEWPORT_HEIGHT, resolutionScale));
+        AllocateTargets(previewTargets, ScaledSize(VIEWPORT_WIDTH, dynamicResolution.maxScale), ScaledSize(VIEWPORT_HEIGHT, dynamicResolution.maxScale));
+        ActivateTargets(finalTargets);
+
+        // TEMPORAL HISTORY FOLLOWS THE PREVIEW TARGETS
+        glGenTextures(2, historyTextures);
+        glGenTextures(2, historyDepthTextures);
+        AllocateHistory();
+
+        // DENOISER PING-PONG AND OUTPUT, SIZED FOR THE LARGER SET
+        glGenTextures(2, denoiseTextures);
+        glGenTextures(1, &denoisedTexture);
+        AllocateDenoise();
+
+        // SAMPLE MAP TEXTURE SETUP, ONE TEXEL PER WORK GROUP
+        glGenTextures(1, &SampleMapTexture);
+        glBindTexture(GL_TEXTURE_2D, SampleMapTexture);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glBindTexture(GL_TEXTURE_2D, 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
 
-        // CAMERA PATH BUFFER
-        uint32_t cameraPathVertexCount = SCA_W * SCA_H * (bounces+1);
-        glGenBuffers(1, &cameraPathVertexBuffer);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cameraPathVertexBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PathVertex) * cameraPathVertexCount, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, cameraPathVertexBuffer);
+        // RESERVE SPACE FOR GROUP ARRAYS, THESE FOLLOW THE FINAL GRID
+        uint32_t tilesX = GroupCount(finalTargets.width);
+        uint32_t tilesY = GroupCount(finalTargets.height);
+        groupTimes.resize(tilesX * tilesY, INITIAL_GROUP_TIME);
+        groupErrors.resize(tilesX * tilesY, 1.0f);
+        groupSampleCounts.resize(tilesX * tilesY, 0);
+
+        // FRAME CONSTANTS UNIFORM BUFFER
+        glGenBuffers(1, &frameConstantsBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameConstantsBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_CONSTANTS_BINDING, frameConstantsBuffer);
+
+        // TILE GROUP LIST AND INDIRECT DISPATCH BUFFERS, SIZED FOR THE LARGER OF THE TWO GRIDS
+        uint32_t listGroups = MaxGroupCount();
+        glGenBuffers(1, &tileGroupBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileGroupBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, listGroups * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TILE_GROUP_BINDING, tileGroupBuffer);
+        tileGroups.reserve(listGroups);
+
+        glGenBuffers(1, &dispatchIndirectBuffer);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatchIndirectBuffer);
+        glBufferData(GL_DISPATCH_INDIRECT_BUFFER, sizeof(DispatchIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+
+        // BATCH TIMER QUERIES
+        batchQueries.resize(BATCH_QUERY_COUNT);
+        for (BatchTimerQuery& batchQuery : batchQueries)
+        {
+            glGenQueries(1, &batchQuery.query);
+            batchQuery.pending = false;
+        }
 
-        // RAYCAST BUFFER
-        glGenBuffers(1, &raycastBuffer);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, raycastBuffer);
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(RaycastHit), nullptr, GL_DYNAMIC_STORAGE_BIT | GL_MAP_READ_BIT);  
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, raycastBuffer);
+        // RAY COUNTERS, ONE PER BATCH QUERY, MAPPED FOR THE LIFETIME OF THE RENDERER
+        GLbitfield rayStatsFlags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &rayStatsBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, rayStatsBuffer);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, BATCH_QUERY_COUNT * sizeof(uint32_t), nullptr, rayStatsFlags);
+        rayCounts = static_cast<uint32_t*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, BATCH_QUERY_COUNT * sizeof(uint32_t), rayStatsFlags));
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RAY_STATS_BINDING, rayStatsBuffer);
 
-        // RESERVE SPACE FOR GROUP ARRAYS
-        uint32_t tilesX = static_cast<uint32_t>((static_cast<float>(SCA_W) + 32) / 32);
-        uint32_t tilesY =  static_cast<uint32_t>((static_cast<float>(SCA_H) + 32) / 32);
-        groupTimes.reserve(tilesX * tilesY);
-        occupiedColumnHeights.resize(tilesX, 0);
+        ReportMemory();
     }
 
     ~RenderSystem()
     {
-        glDeleteBuffers(1, &RenderTexture);
-        glDeleteBuffers(1, &DisplayTexture);
-        glDeleteBuffers(1, &cameraPathVertexBuffer);
-        glDeleteBuffers(1, &lightPathVertexBuffer);
+        DeleteTargets(finalTargets);
+        DeleteTargets(previewTargets);
+        glDeleteTextures(2, historyTextures);
+        glDeleteTextures(2, historyDepthTextures);
+        glDeleteTextures(2, denoiseTextures);
+        glDeleteTextures(1, &denoisedTexture);
+        glDeleteTextures(1, &SampleMapTexture);
+        glDeleteBuffers(1, &frameConstantsBuffer);
+        glDeleteBuffers(1, &tileGroupBuffer);
+        glDeleteBuffers(1, &dispatchIndirectBuffer);
+        glDeleteBuffers(1, &rayStatsBuffer);
+        if (wavefrontAllocated) glDeleteBuffers(6, wavefrontBuffers);
+        for (BatchTimerQuery& batchQuery : batchQueries) glDeleteQueries(1, &batchQuery.query);
     }
 
     void ResizeFramebuffer(int width, int height)
@@ -120,182 +337,588 @@ public:
         VIEWPORT_WIDTH = width;
         VIEWPORT_HEIGHT = height;
 
-        int SCA_W = static_cast<int>(static_cast<float>(VIEWPORT_WIDTH) * resolutionScale);
-        int SCA_H = static_cast<int>(static_cast<float>(VIEWPORT_HEIGHT) * resolutionScale);
-
         qRenderer.ResizeFramebuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
-        // CLEAR TEXTURES
-        glm::vec4 blackColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClearTexImage(RenderTexture, 0, GL_RGBA, GL_FLOAT, &blackColor);
-        glClearTexImage(DisplayTexture, 0, GL_RGBA, GL_UNSIGNED_BYTE, &blackColor);
+        // BOTH SETS ARE REALLOCATED, THE ONLY TIME THE RENDER TARGETS CHANGE SIZE
+        float finalScale = dynamicScene ? revert_resolutionScale : resolutionScale;
+        AllocateTargets(finalTargets, ScaledSize(VIEWPORT_WIDTH, finalScale), ScaledSize(VIEWPORT_HEIGHT, finalScale));
+        AllocateTargets(previewTargets, ScaledSize(VIEWPORT_WIDTH, dynamicResolution.maxScale), ScaledSize(VIEWPORT_HEIGHT, dynamicResolution.maxScale));
+        AllocateHistory();
+        AllocateDenoise();
 
-        // RESIZE RENDER TEXTURE
-        glBindTexture(GL_TEXTURE_2D, RenderTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, SCA_W, SCA_H, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        // RESERVE SPACE FOR GROUP TIMES
+        uint32_t tilesX = GroupCount(finalTargets.width);
+        uint32_t tilesY = GroupCount(finalTargets.height);
+        groupTimes.assign(tilesX * tilesY, INITIAL_GROUP_TIME);
+
+        // TIMINGS STILL IN FLIGHT BELONG TO THE OLD GRID
+        timingGeneration++;
+
+        // RESIZE TILE GROUP LIST
+        uint32_t listGroups = MaxGroupCount();
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileGroupBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, listGroups * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TILE_GROUP_BINDING, tileGroupBuffer);
+        tileGroups.reserve(listGroups);
+
+        // RESIZE GROUP ERRORS AND SAMPLE COUNTS
+        groupErrors.assign(tilesX * tilesY, 1.0f);
+        groupSampleCounts.assign(tilesX * tilesY, 0);
+
+        ReportMemory();
+
+        // THE ACTIVE SET STARTS AGAIN, AllocateTargets ALREADY RESET THE PARKED ONE
+        ResetAccumulation();
+        renderConverged = false;
+        renderJobFinished = false;
+    }
 
-        // RESIZE DISPLAY TEXTURE
-        glBindTexture(GL_TEXTURE_2D, DisplayTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCA_W, SCA_H, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glBindTexture(GL_TEXTURE_2D, 1);
+    void RestartRender()
+    {
+        // AN EDITED SCENE INVALIDATES THE SAMPLES OF BOTH SETS
+        finalTargets.poseValid = false;
+        previewTargets.poseValid = false;
+        historyValid = false;
+        ResetAccumulation();
+        renderConverged = false;
+        renderJobFinished = false;
+
+        // AN EDITED SCENE STARTS THE JOB'S CLOCK AGAIN
+        renderJobStart = std::chrono::steady_clock::now();
+        renderJobRayCount = 0;
+    }
 
-        // RESIZE CAMERA PATH VERTEX BUFFER
-        uint32_t cameraPathVertexCount = SCA_W * SCA_H * (bounces+1);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cameraPathVertexBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PathVertex) * cameraPathVertexCount, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, cameraPathVertexBuffer);
+    void SetSceneCounts(int meshCount, uint32_t directionalLightCount, uint32_t pointLightCount, uint32_t spotlightCount)
+    {
+        sceneMeshCount = meshCount;
+        sceneDirectionalLightCount = directionalLightCount;
+        scenePointLightCount = pointLightCount;
+        sceneSpotlightCount = spotlightCount;
+    }
 
-        // RESERVE SPACE FOR GROUP TIMES
-        uint32_t tilesX = static_cast<uint32_t>((static_cast<float>(SCA_W) + 32) / 32);
-        uint32_t tilesY =  static_cast<uint32_t>((static_cast<float>(SCA_H) + 32) / 32);
-        groupTimes.clear();
-        groupTimes.reserve(tilesX * tilesY);
+    void StartRenderJob(const RenderJob& job)
+    {
+        renderJob = job;
+        renderJobActive = true;
+        renderJobGeneration++;
+        renderJobFinished = false;
+        RestartRender();
+    }
 
-        occupiedColumnHeights.resize(tilesX, 0);
+    // WRITES THE FINAL SET TO path AT THE FIRST PASS BOUNDARY EVERY intervalSeconds. sceneHash
+    // STANDS FOR EVERYTHING THE CAMERA AND RENDER SETTINGS DON'T COVER, AN EMPTY PATH TURNS THEM OFF
+    void SetCheckpoint(const std::string& path, float intervalSeconds, uint64_t sceneHash)
+    {
+        checkpointPath = path;
+        checkpointInterval = intervalSeconds;
+        checkpointSceneHash = sceneHash;
+        lastCheckpoint = std::chrono::steady_clock::now();
+    }
 
-        // EMPTY TILE QUEUE
-        TileQueue.clear();
-        accumulationFrame = 0;
-        frameCount = 0;
+    // CONTINUES THE FINAL SET FROM THE CHECKPOINT WHEN IT WAS TAKEN OF THE SAME SCENE, POSE AND
+    // SETTINGS. THE COUNTERS COME BACK WITH THE SAMPLES SO THE SEED SEQUENCE CARRIES ON AND THE
+    // FINISHED IMAGE MATCHES AN UNINTERRUPTED RENDER. CALL AFTER StartRenderJob
+    bool ResumeFromCheckpoint(Camera& camera)
+    {
+        if (checkpointPath.empty() || dynamicScene || activeTargets != &finalTargets) return false;
+
+        CheckpointHeader header;
+        std::vector<uint8_t> payload;
+        if (!CheckpointWriter::Load(checkpointPath, header, payload)) return false;
+        if (header.key != CheckpointKey(camera) || header.width != finalTargets.width || header.height != finalTargets.height || header.groupCount != groupErrors.size())
+        {
+            std::cerr << "[RenderSystem] Checkpoint " << checkpointPath << " belongs to a different scene or settings, starting over" << std::endl;
+            return false;
+        }
+
+        // SAME ORDER AS CheckpointWriter::Capture
+        size_t pixels = static_cast<size_t>(header.width) * header.height;
+        const uint8_t* data = payload.data();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, finalTargets.renderTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, header.width, header.height, GL_RGBA, GL_FLOAT, data);
+        data += pixels * 16;
+        glBindTexture(GL_TEXTURE_2D, finalTargets.momentTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, header.width, header.height, GL_RG, GL_FLOAT, data);
+        data += pixels * 8;
+        glBindTexture(GL_TEXTURE_2D, finalTargets.firstHitTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, header.width, header.height, GL_RGBA_INTEGER, GL_UNSIGNED_INT, data);
+        data += pixels * 16;
+        glBindTexture(GL_TEXTURE_2D, finalTargets.displayTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, header.width, header.height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        data += pixels * 4;
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        memcpy(groupErrors.data(), data, groupErrors.size() * sizeof(float));
+        data += groupErrors.size() * sizeof(float);
+        memcpy(groupSampleCounts.data(), data, groupSampleCounts.size() * sizeof(uint32_t));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, finalTargets.groupErrorBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, groupErrors.size() * sizeof(float), groupErrors.data());
+        groupErrorGeneration++;
+        groupErrorReadPending = false;
+        groupErrorSamples = header.frameCount;
+        CountConvergedGroups();
+
+        // THE NEXT PASS IS SCHEDULED FROM THE RESTORED ERRORS, AT THE POSE THE SAMPLES WERE TAKEN AT
+        TileQueue.Clear();
+        accumulationFrame = header.accumulationFrame;
+        frameCount = header.frameCount;
+        finalTargets.poseHash = camera.GetPoseHash();
+        finalTargets.poseValid = true;
+        renderConverged = false;
+        renderJobFinished = false;
+        denoiseValid = false;
+        cpuDenoiseGeneration++;
+        denoisePending = accumulationFrame > 0;
+        lastCheckpoint = std::chrono::steady_clock::now();
+
+        // THE CHECKPOINT MAY ALREADY MEET THE JOB'S TARGETS
+        if (renderJobActive) CheckRenderJobComplete();
+        return true;
     }
 
-    void ResizePathBuffer()
+    // BLOCKS UNTIL THE LAST CHECKPOINT IS WRITTEN
+    void FinishCheckpoints()
     {
-        int SCA_W = static_cast<int>(static_cast<float>(VIEWPORT_WIDTH) * resolutionScale);
-        int SCA_H = static_cast<int>(static_cast<float>(VIEWPORT_HEIGHT) * resolutionScale);
+        checkpointWriter.Finish();
+    }
 
-        // CAMERA PATH BUFFER
-        uint32_t cameraPathVertexCount = SCA_W * SCA_H * (bounces+1);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cameraPathVertexBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(PathVertex) * cameraPathVertexCount, nullptr, GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, cameraPathVertexBuffer);
+    void CancelRenderJob()
+    {
+        if (renderJobActive) FinishRenderJob(RenderJobStopReason::Cancelled);
     }
 
-    void RestartRender()
+    bool IsRenderJobActive()
     {
-        // CLEAR SCHEDULING BUFFERS
-        TileQueue.clear();
-        for (int i=0; i<occupiedColumnHeights.size(); i++) occupiedColumnHeights[i] = 0;
-        accumulationFrame = 0;
-        frameCount = 0;
+        return renderJobActive;
     }
 
-    void PathtraceFrame(unsigned int pathtraceShader, Camera &camera)
+    float GetRenderJobElapsedTime()
     {
-        auto startTime = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - renderJobStart).count();
+    }
 
-        int SCA_W = static_cast<int>(static_cast<float>(VIEWPORT_WIDTH) * resolutionScale);
-        int SCA_H = static_cast<int>(static_cast<float>(VIEWPORT_HEIGHT) * resolutionScale);
+    // COMPLETION EVENT, TRUE ONCE PER FINISHED JOB
+    bool PollRenderJobComplete(RenderJobResult& result)
+    {
+        if (!renderJobCompletePending) return false;
+        renderJobCompletePending = false;
+        result = renderJobResult;
+        return true;
+    }
 
-        uint32_t currentBounces = static_cast<uint32_t>(bounces);
-        if (dynamicScene) currentBounces = 1;
+    void SetWavefrontShaders(const WavefrontPrograms& programs)
+    {
+        wavefrontPrograms = programs;
+    }
 
+    void SetTemporalShader(unsigned int shader)
+    {
+        temporalShader = shader;
+    }
 
-        glUseProgram(pathtraceShader);
-        camera.UpdatePathtracerUniforms(); // CAMERA UNIFORM
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_frameCount"), frameCount); // FRAME COUNT FOR PSEUDO RANDOMNESS
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_accumulationFrame"), accumulationFrame); // FRAME ACCUMULATION COUNT
-        glUniform1ui(glGetUniformLocation(pathtraceShader, "u_bounces"), currentBounces); // CAMERA BOUNCES
-        glUniform1f(glGetUniformLocation(pathtraceShader, "u_resolution_scale"), resolutionScale); // RESOLUTION SCALE
-        glUniform3f(glGetUniformLocation(pathtraceShader, "u_skyColour"), skyColour.x, skyColour.y, skyColour.z); // SKY COLOUR
-        glUniform1f(glGetUniformLocation(pathtraceShader, "u_skyBrightness"), skyBrightness); // SKY BRIGHTNESS
-        glBindImageTexture(0, RenderTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F); // RENDER TEXTURE
-        glBindImageTexture(1, DisplayTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8); // DISPLAY TEXTURE
+    void SetDenoiseShader(unsigned int shader)
+    {
+        denoiseShader = shader;
+    }
 
-        uint32_t tilesX = static_cast<uint32_t>((static_cast<float>(SCA_W) + 32) / 32);
-        uint32_t tilesY =  static_cast<uint32_t>((static_cast<float>(SCA_H) + 32) / 32);
+    // LIMITS FINAL PASSES TO A RECTANGLE OF WORK GROUPS SO A WORKER RENDERS ONE REGION OF A
+    // DISTRIBUTED FRAME. A REGION WITHOUT AREA RENDERS THE WHOLE IMAGE
+    void SetRenderRegion(const RenderTile& region)
+    {
+        renderRegion = region;
+        TileQueue.Clear();
+    }
 
-        if (TileQueue.empty())
-        {
-            ScheduleRenderTiles(tilesX, tilesY, accumulationFrame);
-        }
+    // COPIES THE ACCUMULATED COLOUR AND MOMENTS OF A RECTANGLE OF THE FINAL SET, ROW 0 AT THE BOTTOM
+    void ReadFinalPixels(int x, int y, int width, int height, std::vector<glm::vec4>& colour, std::vector<glm::vec2>& moments)
+    {
+        size_t pixels = static_cast<size_t>(width) * height;
+        colour.resize(pixels);
+        moments.resize(pixels);
+
+        unsigned int readFramebuffer;
+        glGenFramebuffers(1, &readFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+        glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, finalTargets.renderTexture, 0);
+        glReadPixels(x, y, width, height, GL_RGBA, GL_FLOAT, colour.data());
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, finalTargets.momentTexture, 0);
+        glReadPixels(x, y, width, height, GL_RG, GL_FLOAT, moments.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &readFramebuffer);
+    }
+
+    // GPU TIME ONE BATCH MAY TAKE (MILLISECONDS). THE DEFAULT KEEPS THE UI RESPONSIVE, HEADLESS
+    // RENDERS HAVE NO UI TO WAIT FOR AND SUBMIT FAR LARGER BATCHES
+    void SetRenderBudget(float milliseconds)
+    {
+        renderBudget = std::max(milliseconds, 1.0f);
+    }
+
+    // LINEAR ACCUMULATION OF THE FINAL SET WITH ITS ALBEDO, NORMAL, DEPTH AND SAMPLE COUNT AOVS
+    void ReadFinalImage(HDRImage& image)
+    {
+        std::vector<glm::vec4> colour;
+        std::vector<glm::vec2> moments;
+        std::vector<glm::uvec4> firstHits;
+        ReadFinalTextures(colour, moments, firstHits);
+        UnpackFinalImage(finalTargets.width, finalTargets.height, colour.data(), moments.data(), firstHits.data(), image);
+    }
 
-        while (!TileQueue.empty())
+    // .exr OR .pfm OF THE UNDENOISED LINEAR IMAGE, PNG EXPORTS GO THROUGH SaveRender
+    bool SaveFinalImage(const std::string& path, const HDRExportOptions& options)
+    {
+        HDRImage image;
+        ReadFinalImage(image);
+        return SaveHDRImage(image, path, options);
+    }
+
+    // SaveFinalImage WITHOUT WAITING ON THE GPU, THE FILE IS UNPACKED AND WRITTEN ON THE
+    // READBACK WORKER A FEW FRAMES LATER
+    void SaveFinalImageAsync(const std::string& path, const HDRExportOptions& options)
+    {
+        int width = finalTargets.width;
+        int height = finalTargets.height;
+        size_t pixels = static_cast<size_t>(width) * height;
+        std::shared_ptr<ReadbackBytes> colour = std::make_shared<ReadbackBytes>();
+        std::shared_ptr<ReadbackBytes> moments = std::make_shared<ReadbackBytes>();
+
+        // REQUESTS ARE DELIVERED IN ORDER, THE LAST ONE FINDS THE OTHER TWO WAITING
+        readback.ReadTexture(finalTargets.renderTexture, GL_RGBA, GL_FLOAT, pixels * sizeof(glm::vec4), [colour](const ReadbackBytes& bytes) { *colour = bytes; });
+        readback.ReadTexture(finalTargets.momentTexture, GL_RG, GL_FLOAT, pixels * sizeof(glm::vec2), [moments](const ReadbackBytes& bytes) { *moments = bytes; });
+        readback.ReadTexture(finalTargets.firstHitTexture, GL_RGBA_INTEGER, GL_UNSIGNED_INT, pixels * sizeof(glm::uvec4), [this, colour, moments, width, height, path, options](const ReadbackBytes& firstHits)
         {
-            const RenderTile &tile = TileQueue.front();
+            readback.RunInBackground([colour, moments, firstHits, width, height, path, options]()
+            {
+                size_t pixels = static_cast<size_t>(width) * height;
+                if (colour->size() != pixels * sizeof(glm::vec4) || moments->size() != pixels * sizeof(glm::vec2) || firstHits.size() != pixels * sizeof(glm::uvec4))
+                {
+                    std::cerr << "[SaveFinalImageAsync] Failed! Could not read back the image for: " << path << std::endl;
+                    return;
+                }
 
-            // UPDATE TILE OFFSET UNIFORM
-            glUniform1ui(glGetUniformLocation(pathtraceShader, "u_tileX"), tile.x);
-            glUniform1ui(glGetUniformLocation(pathtraceShader, "u_tileY"), tile.y);
+                // UNPACKED STRAIGHT FROM THE MAPPINGS, WHICH ARE ALIGNED FOR ANY VECTOR TYPE
+                HDRImage image;
+                const glm::vec4* colourPixels = reinterpret_cast<const glm::vec4*>(colour->data());
+                const glm::vec2* momentPixels = reinterpret_cast<const glm::vec2*>(moments->data());
+                const glm::uvec4* firstHitPixels = reinterpret_cast<const glm::uvec4*>(firstHits.data());
+                UnpackFinalImage(width, height, colourPixels, momentPixels, firstHitPixels, image);
+                SaveHDRImage(image, path, options);
+            });
+        });
+    }
 
+    // READS BACK THE FINAL IMAGE AND ITS GUIDES, DENOISES THEM ON THE READBACK WORKER AND SHOWS
+    // THE RESULT FROM A LATER Poll. shown RUNS THEN, current IS FALSE WHEN THE IMAGE WAS RESET,
+    // DENOISED AGAIN OR THE DENOISER FAILED SINCE, SO THE VIEWPORT STILL SHOWS SOMETHING ELSE
+    void DenoiseOnCPU(std::function<void(bool current)> shown = nullptr)
+    {
+        int width = finalTargets.width;
+        int height = finalTargets.height;
+        size_t pixels = static_cast<size_t>(width) * height;
+        uint32_t generation = ++cpuDenoiseGeneration;
+        float colourSigma = denoiseColourSigma;
+        std::shared_ptr<ReadbackBytes> colour = std::make_shared<ReadbackBytes>();
+        std::shared_ptr<ReadbackBytes> moments = std::make_shared<ReadbackBytes>();
+
+        // REQUESTS ARE DELIVERED IN ORDER, THE LAST ONE FINDS THE OTHER TWO WAITING
+        readback.ReadTexture(finalTargets.renderTexture, GL_RGBA, GL_FLOAT, pixels * sizeof(glm::vec4), [colour](const ReadbackBytes& bytes) { *colour = bytes; });
+        readback.ReadTexture(finalTargets.momentTexture, GL_RG, GL_FLOAT, pixels * sizeof(glm::vec2), [moments](const ReadbackBytes& bytes) { *moments = bytes; });
+        readback.ReadTexture(finalTargets.firstHitTexture, GL_RGBA_INTEGER, GL_UNSIGNED_INT, pixels * sizeof(glm::uvec4), [this, colour, moments, width, height, generation, colourSigma, shown](const ReadbackBytes& firstHits)
+        {
+            std::shared_ptr<std::vector<uint8_t>> displayPixels = std::make_shared<std::vector<uint8_t>>();
+            std::shared_ptr<CPUDenoiseState> state = cpuDenoise;
+            readback.RunInBackground([state, colour, moments, firstHits, displayPixels, width, height, colourSigma]()
+            {
+                size_t pixels = static_cast<size_t>(width) * height;
+                if (colour->size() != pixels * sizeof(glm::vec4) || moments->size() != pixels * sizeof(glm::vec2) || firstHits.size() != pixels * sizeof(glm::uvec4))
+                {
+                    std::cerr << "[DenoiseOnCPU] Failed! Could not read back the final image" << std::endl;
+                    return;
+                }
 
-            // RENDER TILE SEGMENT OF IMAGE
-            auto dispatchStartTime = std::chrono::high_resolution_clock::now();
-            glDispatchCompute(tile.width, tile.height, 1);
-            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-            glFinish();
-            auto dispatchEndTime = std::chrono::high_resolution_clock::now();
-            float dispatchDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(dispatchEndTime - dispatchStartTime).count() / 1000000.0f;
+                // UNPACK INTO PLANES, THE VARIANCE IS OF THE DEMODULATED MEAN LIKE THE GPU PREPARE STAGE
+                DenoiseImage& image = state->image;
+                image.Resize(width, height);
+                for (size_t i=0; i<pixels; i++)
+                {
+                    glm::vec4 pixel;
+                    glm::vec2 moment;
+                    glm::uvec4 firstHit;
+                    memcpy(&pixel, colour->data() + i * sizeof(glm::vec4), sizeof(glm::vec4));
+                    memcpy(&moment, moments->data() + i * sizeof(glm::vec2), sizeof(glm::vec2));
+                    memcpy(&firstHit, firstHits.data() + i * sizeof(glm::uvec4), sizeof(glm::uvec4));
+
+                    glm::vec3 albedo = UnpackFirstHitAlbedo(firstHit.z);
+                    glm::vec3 normal = UnpackFirstHitNormal(firstHit.y);
+                    float distance;
+                    memcpy(&distance, &firstHit.x, sizeof(float));
+
+                    glm::vec3 clampedAlbedo = glm::max(albedo, glm::vec3(0.01f));
+                    float luminance = pixel.x * 0.2126f + pixel.y * 0.7152f + pixel.z * 0.0722f;
+                    float albedoLuminance = std::max(clampedAlbedo.x * 0.2126f + clampedAlbedo.y * 0.7152f + clampedAlbedo.z * 0.0722f, 0.01f);
+                    float sampleCount = std::max(moment.y, 1.0f);
+
+                    for (int c=0; c<3; c++)
+                    {
+                        image.colour[c][i] = pixel[c];
+                        image.albedo[c][i] = albedo[c];
+                        image.normal[c][i] = normal[c];
+                    }
+                    image.depth[i] = distance;
+                    image.variance[i] = std::max(moment.x - luminance * luminance, 0.0f) / sampleCount / (albedoLuminance * albedoLuminance);
+                    image.hit[i] = firstHit.w == 1u ? 1 : 0;
+                }
 
+                state->denoiser.colourSigma = colourSigma;
+                state->denoiser.Denoise(image);
 
-            // SET GROUP TIMES
-            if (!dynamicScene)
+                // TONE MAPPED HERE, THE GL THREAD ONLY UPLOADS
+                displayPixels->resize(pixels * 4);
+                for (size_t i=0; i<pixels; i++)
+                {
+                    glm::vec3 mapped = ToneMapACES(glm::vec3(image.colour[0][i], image.colour[1][i], image.colour[2][i]));
+                    (*displayPixels)[i * 4 + 0] = static_cast<uint8_t>(mapped.x * 255.0f + 0.5f);
+                    (*displayPixels)[i * 4 + 1] = static_cast<uint8_t>(mapped.y * 255.0f + 0.5f);
+                    (*displayPixels)[i * 4 + 2] = static_cast<uint8_t>(mapped.z * 255.0f + 0.5f);
+                    (*displayPixels)[i * 4 + 3] = 255;
+                }
+            },
+            [this, displayPixels, width, height, generation, shown]()
             {
-                float timePerGroup = dispatchDuration / (tile.width * tile.height);
-                for (int y=0; y<tile.height; y++) for (int x=0; x<tile.width; x++)
+                // SHOW IN PLACE OF THE NOISY IMAGE, UNLESS THE IMAGE WAS RESET OR DENOISED AGAIN SINCE
+                bool current = generation == cpuDenoiseGeneration && denoiseMode == DenoiseMode::CPU && !displayPixels->empty();
+                if (current)
                 {
-                    int groupIndex = (y + tile.y) * tilesX + (x + tile.x);
-                    groupTimes[groupIndex] = timePerGroup;
+                    glBindTexture(GL_TEXTURE_2D, denoisedTexture);
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, displayPixels->data());
+                    glBindTexture(GL_TEXTURE_2D, 0);
+
+                    denoisedWidth = width;
+                    denoisedHeight = height;
+                    denoiseValid = true;
                 }
-            }
+                if (shown) shown(current);
+            });
+        });
+    }
 
-            // REMOVE TILE FROM QUEUE
-            TileQueue.erase(TileQueue.begin());
+    // RAYS TRACED PER SECOND OF GPU TIME, AVERAGED OVER RECENT BATCHES
+    float GetRaysPerSecond()
+    {
+        return raysPerSecond;
+    }
+
+    // RAYS PER WALL CLOCK SECOND SINCE THE JOB STARTED, FOR BATCH RENDERS AND FOR DRIVERS WHOSE
+    // TIMER QUERIES REPORT NOTHING (llvmpipe). WAITS FOR THE BATCHES STILL ON THE GPU
+    float GetRenderJobRaysPerSecond()
+    {
+        glFinish();
+        CollectBatchTimings();
+        float elapsedTime = GetRenderJobElapsedTime();
+        return elapsedTime > 0.0f ? static_cast<float>(renderJobRayCount) / elapsedTime : 0.0f;
+    }
+
+    // PIXEL SAMPLES PER SECOND OF GPU TIME, OVER THE SAME WINDOW AS RAYS/SEC
+    float GetSamplesPerSecond()
+    {
+        return samplesPerSecond;
+    }
+
+    // TILES DISPATCHED BY THE LAST CALL TO PathtraceFrame
+    uint32_t GetTilesLastFrame()
+    {
+        return tilesLastFrame;
+    }
+
+    // FRACTION OF THE RENDER JOB DONE BY ITS CLOSEST STOP CONDITION, OR OF THE TILES CONVERGED
+    // WITHOUT A JOB. NEGATIVE WHEN NOTHING BOUNDS THE ACCUMULATION
+    float GetAccumulationProgress()
+    {
+        float progress = -1.0f;
+        if (renderJobActive && renderJob.targetSamples > 0) progress = std::max(progress, static_cast<float>(frameCount) / renderJob.targetSamples);
+        if (renderJobActive && renderJob.timeBudget > 0.0f) progress = std::max(progress, GetRenderJobElapsedTime() / renderJob.timeBudget);
+        if (adaptiveSampling && !groupErrors.empty()) progress = std::max(progress, static_cast<float>(convergedGroupCount) / groupErrors.size());
+        return std::min(progress, 1.0f);
+    }
 
+    void PathtraceFrame(unsigned int pathtraceShader, Camera &camera)
+    {
+        tilesLastFrame = 0;
+        readback.Poll();
+        checkpointWriter.Poll();
 
-            auto now = std::chrono::high_resolution_clock::now();
-            float totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
-            if (totalDuration + TileQueue.front().estimatedTime >= renderBudget) break; // STOP RENDERING AFTER 16 MILLISECONDS
+        // SAMPLES OF THE ACTIVE SET ARE KEPT WHILE THE CAMERA STAYS AT THE POSE THEY WERE TAKEN AT
+        uint64_t poseHash = camera.GetPoseHash();
+        if (!activeTargets->poseValid || activeTargets->poseHash != poseHash)
+        {
+            ResetAccumulation();
+            activeTargets->poseHash = poseHash;
+            activeTargets->poseValid = true;
         }
 
-        if (TileQueue.empty()) {
-            accumulationFrame += 1;
-            frameCount += 1;
+        // FINAL IMAGES RESUMED AT THEIR POSE ARE DENOISED AGAIN BEFORE THEY ARE SHOWN
+        if (denoisePending && !dynamicScene)
+        {
+            if (denoiseMode == DenoiseMode::GPU) DenoiseGPU(RenderTexture);
+            if (denoiseMode == DenoiseMode::CPU) DenoiseOnCPU();
+            denoisePending = false;
         }
-    }
 
-    int Raycast(unsigned int raycastShader, Camera &camera, int meshCount, int cursorX, int cursorY)
-    {   
-        glUseProgram(raycastShader);
-        camera.UpdateRaycasterUniforms(raycastShader);
+        // THE LAST JOB FINISHED, LEAVE THE GPU IDLE UNTIL THE NEXT JOB OR A RESTART
+        if (renderJobFinished && !dynamicScene) return;
 
-        // UPDATE UNIFORMS
-        glUniform1i(glGetUniformLocation(raycastShader, "u_cursorX"), cursorX);
-        glUniform1i(glGetUniformLocation(raycastShader, "u_cursorY"), cursorY);
-        glUniform1i(glGetUniformLocation(raycastShader, "u_width"), VIEWPORT_WIDTH);
-        glUniform1i(glGetUniformLocation(raycastShader, "u_height"), VIEWPORT_HEIGHT);
-        glUniform1i(glGetUniformLocation(raycastShader, "u_meshCount"), meshCount);
+        // THE TIME BUDGET CAN RUN OUT PART WAY THROUGH A PASS, PIXELS KEEP THEIR OWN SAMPLE COUNTS
+        if (renderJobActive && renderJob.timeBudget > 0.0f && GetRenderJobElapsedTime() >= renderJob.timeBudget)
+        {
+            FinishRenderJob(RenderJobStopReason::TimeBudget);
+            return;
+        }
 
-        // RUN RAYCAST SHADER
-        glDispatchCompute(1, 1, 1);
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); 
-        glFinish();
+        uint32_t currentBounces = static_cast<uint32_t>(bounces);
+        if (dynamicScene) currentBounces = std::min(dynamicResolution.Bounces(), currentBounces);
 
-        // COPY HIT DATA TO CPU
-        RaycastHit hit;
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, raycastBuffer);
-        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(RaycastHit), &hit);
-        
-        // RETURN PARTITION INDEX
-        return hit.meshIndex;
+        glUseProgram(pathtraceShader);
+        glBindImageTexture(0, RenderTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F); // RENDER TEXTURE
+        glBindImageTexture(1, DisplayTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8); // DISPLAY TEXTURE
+        glBindImageTexture(2, MomentTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG32F); // MOMENT TEXTURE
+        glBindImageTexture(3, FirstHitTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32UI); // FIRST HIT TEXTURE
+
+        uint32_t tilesX = GroupCount(RenderWidth());
+        uint32_t tilesY = GroupCount(RenderHeight());
+
+        // FOLD IN GPU TIMINGS FROM EARLIER FRAMES
+        CollectBatchTimings();
+
+        // THE GPU IS STILL BUSY WITH EVERY EARLIER BATCH, DON'T QUEUE MORE WORK
+        BatchTimerQuery& batchQuery = batchQueries[nextBatchQuery];
+        if (batchQuery.pending) return;
+
+        // THE BATCH COUNTS ITS RAYS INTO THE SLOT OF ITS TIMER QUERY
+        Profiler::BeginStage("uploads");
+        UploadFrameConstants(camera, currentBounces);
+        Profiler::EndStage("uploads");
+        rayCounts[nextBatchQuery] = 0;
+
+        // EVERY TILE IS BELOW THE NOISE THRESHOLD, RESUME IF THE THRESHOLD IS LOWERED
+        if (renderConverged && renderJobActive && renderJob.targetError > 0.0f && convergedThreshold <= renderJob.targetError)
+        {
+            FinishRenderJob(RenderJobStopReason::TargetError);
+            return;
+        }
+        if (renderConverged && !dynamicScene)
+        {
+            if (adaptiveSampling && noiseThreshold >= convergedThreshold) return;
+            renderConverged = false;
+        }
+
+        if (TileQueue.Empty())
+        {
+            ScheduleRenderTiles(tilesX, tilesY, accumulationFrame);
+            if (TileQueue.Empty()) return;
+        }
+
+        // GATHER TILES UNTIL THE PREDICTED GPU TIME FILLS THE BUDGET
+        Profiler::BeginStage("tile_loop");
+        float predictedTime = 0.0f;
+        uint64_t batchPixels = 0;
+        batchQuery.tiles.clear();
+        tileGroups.clear();
+        while (!TileQueue.Empty())
+        {
+            const RenderTile &tile = TileQueue.Front();
+            float tileTime = dynamicScene ? 0.0f : EstimateTileTime(tile, tilesX) * passSamples;
+            if (!batchQuery.tiles.empty() && predictedTime + tileTime >= renderBudget) break;
+
+            // FLATTEN TILE INTO WORK GROUP COORDINATES
+            for (int y=0; y<tile.height; y++) for (int x=0; x<tile.width; x++)
+            {
+                uint32_t groupX = static_cast<uint32_t>(tile.x + x);
+                uint32_t groupY = static_cast<uint32_t>(tile.y + y);
+                tileGroups.push_back(groupX | (groupY << 16));
+                batchPixels += static_cast<uint64_t>(std::min(32, RenderWidth() - static_cast<int>(groupX) * 32)) * std::min(32, RenderHeight() - static_cast<int>(groupY) * 32);
+                if (!dynamicScene) groupSampleCounts[groupY * tilesX + groupX] += passSamples;
+            }
+
+            predictedTime += tileTime;
+            batchQuery.tiles.push_back(tile);
+
+            // REMOVE TILE FROM QUEUE
+            TileQueue.Pop();
+        }
+
+        Profiler::EndStage("tile_loop");
+
+        // UPLOAD GROUP LIST AND DISPATCH SIZE
+        Profiler::BeginStage("uploads");
+        DispatchIndirectCommand command = { static_cast<uint32_t>(tileGroups.size()), 1, 1 };
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileGroupBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tileGroups.size() * sizeof(uint32_t), tileGroups.data());
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatchIndirectBuffer);
+        glBufferSubData(GL_DISPATCH_INDIRECT_BUFFER, 0, sizeof(DispatchIndirectCommand), &command);
+        Profiler::EndStage("uploads");
+
+        // RENDER EVERY TILE IN ONE DISPATCH, OR AS QUEUED KERNELS IN WAVEFRONT MODE
+        glBeginQuery(GL_TIME_ELAPSED, batchQuery.query);
+        if (wavefront && wavefrontPrograms.generate != 0) DispatchWavefront(currentBounces);
+        else glDispatchComputeIndirect(0);
+
+        // NAVIGATION PREVIEWS BLEND IN THE REPROJECTED HISTORY OF EARLIER FRAMES
+        bool temporal = dynamicScene && temporalReprojection && temporalShader != 0;
+        if (temporal) ResolveTemporal(camera);
+
+        // PREVIEWS ARE ALWAYS DENOISED ON THE GPU, THE CPU FILTER IS TOO SLOW TO RUN EVERY FRAME
+        if (dynamicScene && denoiseMode != DenoiseMode::Off) DenoiseGPU(temporal ? historyTextures[historyIndex] : RenderTexture);
+        glEndQuery(GL_TIME_ELAPSED);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+        // DYNAMIC FRAMES RUN AT A DIFFERENT SCALE SO THEIR TIMES ARE NOT KEPT
+        batchQuery.predictedTime = predictedTime;
+        batchQuery.groupColumns = tilesX;
+        batchQuery.generation = timingGeneration;
+        batchQuery.recordTiming = !dynamicScene;
+        batchQuery.pending = true;
+        batchQuery.dynamic = dynamicScene;
+        batchQuery.resolutionScale = resolutionScale;
+        batchQuery.bounces = currentBounces;
+        batchQuery.samples = passSamples;
+        batchQuery.pixelSamples = batchPixels * passSamples;
+        tilesLastFrame = static_cast<uint32_t>(batchQuery.tiles.size());
+        nextBatchQuery = (nextBatchQuery + 1) % BATCH_QUERY_COUNT;
+
+        if (TileQueue.Empty()) {
+            accumulationFrame += 1;
+            frameCount += passSamples;
+
+            // EACH FINISHED PASS REFRESHES THE DENOISED IMAGE, OUTSIDE THE BATCH TIMER
+            if (!dynamicScene && denoiseMode == DenoiseMode::GPU) DenoiseGPU(RenderTexture);
+            if (!dynamicScene) CheckpointIfDue(camera);
+            if (!dynamicScene && frameCount >= adaptiveMinSamples) RequestGroupErrors();
+            if (renderJobActive) CheckRenderJobComplete();
+        }
     }
 
     void SetRendererDynamic()
     {
+        // LET THE CONTROLLER REACT TO THE LAST NAVIGATION FRAMES
+        bool scaleChanged = dynamicResolution.Update(static_cast<uint32_t>(bounces), static_cast<uint32_t>(std::max(samplesPerDispatch, 1)));
+
         if (dynamicScene == false)
         {
             dynamicScene = true;
 
-            // SAVE CURRENT SETTINGS
+            // SAVE CURRENT SETTINGS AND SWAP TO THE PREVIEW TARGETS
             revert_resolutionScale = resolutionScale;
-
-            // OPTIMISE THE FRAMERATE
-            resolutionScale = 0.25f;
-
-            // RESIZE IMAGES TO LOWER RESOLUTION
-            ResizeFramebuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+            ActivateTargets(previewTargets);
+            historyValid = false;
         }
+
+        // THE PREVIEW RENDERS INTO A CORNER OF ITS TARGETS, A NEW SCALE ONLY DISCARDS ITS SAMPLES
+        if (scaleChanged) previewTargets.poseValid = false;
+        resolutionScale = dynamicResolution.Scale();
     }
 
     void SetRendererStatic()
@@ -304,11 +927,9 @@ public:
         {
             dynamicScene = false;
 
-            // RESET RESOLUTION SCALE AND RENDER BUDGET
+            // RESET RESOLUTION SCALE, THE FINAL TARGETS RESUME IF THE CAMERA CAME BACK TO THEIR POSE
             resolutionScale = revert_resolutionScale;
-
-            // RESIZE IMAGES TO FULL RESOLUTION
-            ResizeFramebuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+            ActivateTargets(finalTargets);
         }
     }
 
@@ -316,7 +937,20 @@ public:
     {
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_CULL_FACE);
-        qRenderer.RenderToViewport(DisplayTexture);
+
+        // THE DENOISED IMAGE REPLACES THE DISPLAY IMAGE ONCE ONE EXISTS FOR THE CURRENT VIEW
+        if (denoiseMode != DenoiseMode::Off && denoiseValid)
+        {
+            glm::vec2 denoisedScale(static_cast<float>(denoisedWidth) / static_cast<float>(denoiseTextureWidth),
+                                    static_cast<float>(denoisedHeight) / static_cast<float>(denoiseTextureHeight));
+            qRenderer.RenderToViewport(denoisedTexture, denoisedScale);
+            return;
+        }
+
+        // ONLY THE RENDERED CORNER OF THE TARGETS IS SHOWN
+        glm::vec2 uvScale(static_cast<float>(RenderWidth()) / static_cast<float>(activeTargets->width),
+                          static_cast<float>(RenderHeight()) / static_cast<float>(activeTargets->height));
+        qRenderer.RenderToViewport(DisplayTexture, uvScale);
     }
 
     void RenderThumbnail(Material& material, int width, int height)
@@ -329,6 +963,39 @@ public:
         return qRenderer.GetFrameBufferTextureID();
     }
 
+    // PER GROUP SAMPLE COUNT HEATMAP, COOL GROUPS WERE SKIPPED AS CONVERGED
+    unsigned int GetSampleMapTextureID()
+    {
+        return SampleMapTexture;
+    }
+
+    float GetSampleMapAspect()
+    {
+        if (sampleMapHeight == 0) return 1.0f;
+        return static_cast<float>(sampleMapWidth) / static_cast<float>(sampleMapHeight);
+    }
+
+    uint32_t GetConvergedGroupCount()
+    {
+        return convergedGroupCount;
+    }
+
+    uint32_t GetGroupCount()
+    {
+        return static_cast<uint32_t>(groupErrors.size());
+    }
+
+    bool IsConverged()
+    {
+        return renderConverged;
+    }
+
+    // SAMPLES PER PIXEL SO FAR, PIXELS SKIPPED BY ADAPTIVE SAMPLING MAY HAVE FEWER
+    uint32_t GetSampleCount()
+    {
+        return frameCount;
+    }
+
     uint32_t accumulationFrame = 0;
     int bounces = 3;
 
@@ -336,96 +1003,985 @@ public:
     glm::vec3 skyColour = glm::vec3(0.5f, 0.7f, 0.95f);
     float skyBrightness = 1.5f;
 
+    // ADAPTIVE SAMPLING
+    bool adaptiveSampling = true;
+    float noiseThreshold = 0.02f;
+    uint32_t adaptiveMinSamples = 16;
+
+    // TRACE WITH SEPARATE EXTEND/SHADE/SHADOW KERNELS INSTEAD OF ONE MEGAKERNEL
+    bool wavefront = false;
+
+    // GPU READBACKS FOR EXPORTS AND PICKING, POLLED EVERY FRAME
+    ReadbackService readback;
+
+    // SEED INDEX OF THE FIRST SAMPLE. A WORKER TAKING SAMPLES [firstSample, firstSample + n) OF A
+    // DISTRIBUTED FRAME DRAWS THE SAME RANDOM NUMBERS ONE MACHINE WOULD FOR THOSE SAMPLES
+    uint32_t firstSample = 0;
+
+    // SAMPLES EACH PIXEL TAKES PER DISPATCH, SUMMED IN REGISTERS AND WRITTEN ONCE.
+    // TAKES EFFECT FROM THE NEXT PASS, WAVEFRONT MODE ALWAYS TAKES ONE
+    int samplesPerDispatch = 1;
+
+    // RESOLUTION, BOUNCES AND SAMPLES WHILE NAVIGATING, BOUNCES AND SAMPLES NEVER EXCEED THE SETTINGS ABOVE
+    DynamicResolutionController dynamicResolution;
+
+    // REPROJECT AND BLEND EARLIER NAVIGATION FRAMES, FEWER HISTORY FRAMES REACT FASTER TO CHANGES
+    bool temporalReprojection = true;
+    int temporalHistory = 16;
+
+    // EDGE AVOIDING DENOISER FOR THE DISPLAYED IMAGE, A HIGHER COLOUR SIGMA BLURS MORE NOISE AWAY
+    DenoiseMode denoiseMode = DenoiseMode::Off;
+    float denoiseColourSigma = 4.0f;
+
 private:
 
     uint32_t currentBounces;
     float renderBudget = 15;
     float resolutionScale = 1.0f;
-    uint32_t frameCount = 0;
+    uint32_t frameCount = 0; // SAMPLES TAKEN SO FAR, ALSO THE SEED BASE FOR THE NEXT PASS
+    uint32_t passSamples = 1; // SAMPLES PER DISPATCH FIXED FOR THE WHOLE PASS
 
     QuadRenderer qRenderer;
     ThumbnailRenderer thumbnailRenderer;
     int VIEWPORT_WIDTH;
     int VIEWPORT_HEIGHT;
-    unsigned int DisplayTexture;
+    unsigned int DisplayTexture; // HANDLES OF THE ACTIVE TARGET SET
     unsigned int RenderTexture;
-    unsigned int cameraPathVertexBuffer;
-    unsigned int lightPathVertexBuffer;
-    unsigned int raycastBuffer;
-    std::vector<RenderTile> TileQueue;
+    unsigned int MomentTexture;
+    unsigned int FirstHitTexture;
+    RenderTargetSet finalTargets;
+    RenderTargetSet previewTargets;
+    RenderTargetSet* activeTargets = &finalTargets;
+    unsigned int SampleMapTexture;
+    RenderTileQueue TileQueue;
 
     std::vector<float> groupTimes;
-    std::vector<uint16_t> occupiedColumnHeights;
+    SkylinePacker skyline;
+    RenderTile renderRegion; // WORK GROUPS OF A DISTRIBUTED FRAME, EMPTY FOR THE WHOLE IMAGE
+
+    // RENDER JOB STATE
+    RenderJob renderJob;
+    RenderJobResult renderJobResult;
+    bool renderJobActive = false;
+    bool renderJobFinished = false;
+    bool renderJobCompletePending = false;
+    std::chrono::steady_clock::time_point renderJobStart = std::chrono::steady_clock::now();
+
+    // ADAPTIVE SAMPLING STATE, ERRORS ARE READ FROM THE FINAL SET WITHOUT WAITING ON THE GPU, SO
+    // THEY ARE THOSE OF A PASS OR TWO AGO. A RESTART BUMPS THE GENERATION SO OLD COPIES ARE DROPPED
+    std::vector<float> groupErrors;
+    uint32_t groupErrorGeneration = 0;
+    uint32_t groupErrorSamples = 0; // SAMPLES PER PIXEL BEHIND groupErrors
+    bool groupErrorReadPending = false;
+    uint32_t renderJobGeneration = 0;
+    std::vector<uint32_t> groupSampleCounts;
+    std::vector<uint8_t> sampleMapPixels;
+    int sampleMapWidth = 0;
+    int sampleMapHeight = 0;
+    uint32_t convergedGroupCount = 0;
+    bool renderConverged = false;
+    float convergedThreshold = 0.0f;
+
+    // GPU BATCH TIMING
+    std::vector<BatchTimerQuery> batchQueries;
+    uint32_t nextBatchQuery = 0;
+    uint32_t oldestBatchQuery = 0;
+    uint32_t timingGeneration = 0;
+
+    // FRAME CONSTANTS AND TILE DISPATCH
+    unsigned int frameConstantsBuffer;
+    unsigned int tileGroupBuffer;
+    unsigned int dispatchIndirectBuffer;
+    std::vector<uint32_t> tileGroups;
+
+    // WAVEFRONT PATH TRACING, BUFFERS ARE ALLOCATED THE FIRST TIME THE MODE IS USED
+    WavefrontPrograms wavefrontPrograms;
+    unsigned int wavefrontBuffers[6];
+    bool wavefrontAllocated = false;
+
+    // TEMPORAL REPROJECTION, THE HISTORY PAIR IS PING-PONGED EVERY PREVIEW FRAME
+    unsigned int temporalShader = 0;
+    unsigned int historyTextures[2];
+    unsigned int historyDepthTextures[2];
+    uint32_t historyIndex = 0;
+    bool historyValid = false;
+    CameraConstants historyCamera;
+    int historyWidth = 0;
+    int historyHeight = 0;
+
+    // DENOISER, THE TEXTURES COVER THE LARGER OF THE TWO TARGET SETS
+    unsigned int denoiseShader = 0;
+    unsigned int denoiseTextures[2];
+    unsigned int denoisedTexture;
+    int denoiseTextureWidth = 0;
+    int denoiseTextureHeight = 0;
+    int denoisedWidth = 0;
+    int denoisedHeight = 0;
+    bool denoiseValid = false;
+    bool denoisePending = false;
+
+    // OWNED WITH THE READBACK WORKER, A DENOISE STILL RUNNING MAY OUTLIVE THE RENDERER
+    struct CPUDenoiseState
+    {
+        Denoiser denoiser;
+        DenoiseImage image;
+    };
+    std::shared_ptr<CPUDenoiseState> cpuDenoise = std::make_shared<CPUDenoiseState>();
+    uint32_t cpuDenoiseGeneration = 0;
+
+    // RAYS/SEC STATISTIC
+    unsigned int rayStatsBuffer;
+    uint32_t* rayCounts = nullptr;
+    uint64_t rayWindowCount = 0;
+    uint64_t renderJobRayCount = 0;
+    float rayWindowTime = 0.0f;
+    float raysPerSecond = 0.0f;
+    uint64_t sampleWindowCount = 0;
+    float samplesPerSecond = 0.0f;
+    uint32_t tilesLastFrame = 0;
+
+    // SCENE COUNTS FOR THE FRAME CONSTANTS
+    int sceneMeshCount = 0;
+    uint32_t sceneDirectionalLightCount = 0;
+    uint32_t scenePointLightCount = 0;
+    uint32_t sceneSpotlightCount = 0;
+
+    // CHECKPOINTS OF THE FINAL SET
+    CheckpointWriter checkpointWriter;
+    std::string checkpointPath;
+    float checkpointInterval = 300.0f;
+    uint64_t checkpointSceneHash = 0;
+    std::chrono::steady_clock::time_point lastCheckpoint = std::chrono::steady_clock::now();
 
     // DYNAMIC SCENES
     bool dynamicScene = false;
-    float revert_resolutionScale;
+    float revert_resolutionScale = 1.0f;
+
 
+    // REPORT RENDER TARGET SIZES TO THE MEMORY TRACKER
+    void ReportMemory()
+    {
+        for (RenderTargetSet* targets : { &finalTargets, &previewTargets })
+        {
+            uint64_t renderTextureSize = MemoryTracker::TextureBytes(targets->width, targets->height, 16, false);
+            uint64_t displayTextureSize = MemoryTracker::TextureBytes(targets->width, targets->height, 4, false);
+            uint64_t momentTextureSize = MemoryTracker::TextureBytes(targets->width, targets->height, 8, false);
+            uint64_t firstHitTextureSize = MemoryTracker::TextureBytes(targets->width, targets->height, 16, false);
+
+            MemoryTracker::Track("render targets", targets->renderTexture, renderTextureSize, renderTextureSize);
+            MemoryTracker::Track("render targets", targets->displayTexture, displayTextureSize, displayTextureSize);
+            MemoryTracker::Track("render targets", targets->momentTexture, momentTextureSize, momentTextureSize);
+            MemoryTracker::Track("render targets", targets->firstHitTexture, firstHitTextureSize, firstHitTextureSize);
+        }
+
+        uint64_t historySize = MemoryTracker::TextureBytes(previewTargets.width, previewTargets.height, 8, false);
+        uint64_t historyDepthSize = MemoryTracker::TextureBytes(previewTargets.width, previewTargets.height, 4, false);
+        for (int i=0; i<2; i++)
+        {
+            MemoryTracker::Track("temporal history", historyTextures[i], historySize, historySize);
+            MemoryTracker::Track("temporal history", historyDepthTextures[i], historyDepthSize, historyDepthSize);
+        }
+
+        uint64_t denoiseSize = MemoryTracker::TextureBytes(denoiseTextureWidth, denoiseTextureHeight, 16, false);
+        uint64_t denoisedSize = MemoryTracker::TextureBytes(denoiseTextureWidth, denoiseTextureHeight, 4, false);
+        MemoryTracker::Track("denoiser", denoiseTextures[0], denoiseSize, denoiseSize);
+        MemoryTracker::Track("denoiser", denoiseTextures[1], denoiseSize, denoiseSize);
+        MemoryTracker::Track("denoiser", denoisedTexture, denoisedSize, denoisedSize);
+
+        uint64_t viewportSize = MemoryTracker::TextureBytes(VIEWPORT_WIDTH, VIEWPORT_HEIGHT, 8, false);
+        MemoryTracker::Track("viewport framebuffer", qRenderer.GetFrameBufferTextureID(), viewportSize, viewportSize);
+    }
+
+    static int ScaledSize(int size, float scale)
+    {
+        return std::max(static_cast<int>(static_cast<float>(size) * scale), 1);
+    }
+
+    static uint32_t GroupCount(int size)
+    {
+        return static_cast<uint32_t>((static_cast<float>(size) + 32) / 32);
+    }
+
+    uint32_t MaxGroupCount()
+    {
+        uint32_t finalGroups = GroupCount(finalTargets.width) * GroupCount(finalTargets.height);
+        uint32_t previewGroups = GroupCount(previewTargets.width) * GroupCount(previewTargets.height);
+        return std::max(finalGroups, previewGroups);
+    }
+
+    // SIZE OF THE RENDERED AREA, A CORNER OF THE ACTIVE TARGETS
+    int RenderWidth()
+    {
+        return std::min(ScaledSize(VIEWPORT_WIDTH, resolutionScale), activeTargets->width);
+    }
+
+    int RenderHeight()
+    {
+        return std::min(ScaledSize(VIEWPORT_HEIGHT, resolutionScale), activeTargets->height);
+    }
+
+    void CreateTargets(RenderTargetSet& targets)
+    {
+        // RENDER TEXTURE SETUP
+        glGenTextures(1, &targets.renderTexture);
+        glBindTexture(GL_TEXTURE_2D, targets.renderTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // DISPLAY TEXTURE SETUP, FILTERED FOR THE UPSCALE PASS
+        glGenTextures(1, &targets.displayTexture);
+        glBindTexture(GL_TEXTURE_2D, targets.displayTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // MOMENT TEXTURE SETUP
+        glGenTextures(1, &targets.momentTexture);
+        glBindTexture(GL_TEXTURE_2D, targets.momentTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // FIRST HIT TEXTURE SETUP
+        glGenTextures(1, &targets.firstHitTexture);
+        glBindTexture(GL_TEXTURE_2D, targets.firstHitTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // EACH SET HAS ITS OWN GROUP ERRORS SO PREVIEW FRAMES NEVER OVERWRITE THE FINAL ONES
+        glGenBuffers(1, &targets.groupErrorBuffer);
+    }
+
+    void AllocateTargets(RenderTargetSet& targets, int width, int height)
+    {
+        targets.width = width;
+        targets.height = height;
+
+        glBindTexture(GL_TEXTURE_2D, targets.renderTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glBindTexture(GL_TEXTURE_2D, targets.displayTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, targets.momentTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, nullptr);
+        glBindTexture(GL_TEXTURE_2D, targets.firstHitTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, width, height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // NOTHING IS SHOWN UNTIL THE FIRST TILES LAND
+        glm::vec4 blackColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClearTexImage(targets.displayTexture, 0, GL_RGBA, GL_FLOAT, &blackColor);
+
+        uint32_t groups = GroupCount(width) * GroupCount(height);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, targets.groupErrorBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, groups * sizeof(float), nullptr, GL_DYNAMIC_READ);
+        if (&targets == activeTargets) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GROUP_ERROR_BINDING, targets.groupErrorBuffer);
+
+        targets.accumulationFrame = 0;
+        targets.frameCount = 0;
+        targets.poseValid = false;
+    }
+
+    void DeleteTargets(RenderTargetSet& targets)
+    {
+        glDeleteTextures(1, &targets.renderTexture);
+        glDeleteTextures(1, &targets.displayTexture);
+        glDeleteTextures(1, &targets.momentTexture);
+        glDeleteTextures(1, &targets.firstHitTexture);
+        glDeleteBuffers(1, &targets.groupErrorBuffer);
+    }
+
+    // PARK THE PROGRESS OF THE CURRENT SET AND PICK UP WHERE THE OTHER ONE LEFT OFF. A PASS CUT
+    // SHORT HERE IS HARMLESS, EVERY PIXEL KEEPS ITS OWN SAMPLE COUNT
+    void ActivateTargets(RenderTargetSet& targets)
+    {
+        activeTargets->accumulationFrame = accumulationFrame;
+        activeTargets->frameCount = frameCount;
+
+        activeTargets = &targets;
+        accumulationFrame = targets.accumulationFrame;
+        frameCount = targets.frameCount;
+        RenderTexture = targets.renderTexture;
+        DisplayTexture = targets.displayTexture;
+        MomentTexture = targets.momentTexture;
+        FirstHitTexture = targets.firstHitTexture;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GROUP_ERROR_BINDING, targets.groupErrorBuffer);
+        TileQueue.Clear();
+
+        // THE DENOISED IMAGE BELONGS TO THE SET JUST LEFT
+        denoiseValid = false;
+        cpuDenoiseGeneration++;
+        denoisePending = &targets == &finalTargets && accumulationFrame > 0;
+    }
+
+    // COLOUR AND FIRST HIT DISTANCE PAIRS AT THE PREVIEW SIZE
+    void AllocateHistory()
+    {
+        for (int i=0; i<2; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, historyTextures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, previewTargets.width, previewTargets.height, 0, GL_RGBA, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glBindTexture(GL_TEXTURE_2D, historyDepthTextures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, previewTargets.width, previewTargets.height, 0, GL_RED, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        historyValid = false;
+    }
+
+    // ILLUMINATION PING-PONG AND THE DENOISED DISPLAY IMAGE
+    void AllocateDenoise()
+    {
+        denoiseTextureWidth = std::max(finalTargets.width, previewTargets.width);
+        denoiseTextureHeight = std::max(finalTargets.height, previewTargets.height);
+        for (int i=0; i<2; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, denoiseTextures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, denoiseTextureWidth, denoiseTextureHeight, 0, GL_RGBA, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+
+        // FILTERED LIKE THE DISPLAY TEXTURES FOR THE UPSCALE TO THE VIEWPORT
+        glBindTexture(GL_TEXTURE_2D, denoisedTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, denoiseTextureWidth, denoiseTextureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        denoiseValid = false;
+        cpuDenoiseGeneration++;
+    }
+
+    // ONE PREPARE STAGE, THEN FILTER STAGES WITH DOUBLING STEPS, THE LAST OF WHICH WRITES THE
+    // DENOISED DISPLAY IMAGE. colourTexture IS THE LINEAR COLOUR OF THE ACTIVE SET
+    void DenoiseGPU(unsigned int colourTexture)
+    {
+        if (denoiseShader == 0) return;
+        int width = RenderWidth();
+        int height = RenderHeight();
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+        glUseProgram(denoiseShader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colourTexture);
+        glBindImageTexture(2, MomentTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG32F);
+        glBindImageTexture(3, FirstHitTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32UI);
+        glBindImageTexture(6, denoisedTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        glUniform2ui(DENOISE_EXTENT_LOCATION, static_cast<GLuint>(width), static_cast<GLuint>(height));
+        glUniform1f(DENOISE_COLOUR_SIGMA_LOCATION, denoiseColourSigma);
+
+        for (int stage=0; stage<=DENOISE_ITERATIONS; stage++)
+        {
+            int mode = stage == 0 ? DENOISE_PREPARE : (stage == DENOISE_ITERATIONS ? DENOISE_OUTPUT : DENOISE_FILTER);
+            glBindImageTexture(4, denoiseTextures[(stage + 1) % 2], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+            glBindImageTexture(5, denoiseTextures[stage % 2], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+            glUniform1i(DENOISE_STAGE_LOCATION, mode);
+            glUniform1i(DENOISE_STEP_LOCATION, stage == 0 ? 1 : 1 << (stage - 1));
+            glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        }
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        denoisedWidth = width;
+        denoisedHeight = height;
+        denoiseValid = true;
+    }
+
+    void ReadFinalTextures(std::vector<glm::vec4>& colour, std::vector<glm::vec2>& moments, std::vector<glm::uvec4>& firstHits)
+    {
+        size_t pixels = static_cast<size_t>(finalTargets.width) * finalTargets.height;
+        colour.resize(pixels);
+        moments.resize(pixels);
+        firstHits.resize(pixels);
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, finalTargets.renderTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, colour.data());
+        glBindTexture(GL_TEXTURE_2D, finalTargets.momentTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, moments.data());
+        glBindTexture(GL_TEXTURE_2D, finalTargets.firstHitTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, firstHits.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    static void UnpackFinalImage(int width, int height, const glm::vec4* colour, const glm::vec2* moments, const glm::uvec4* firstHits, HDRImage& image)
+    {
+        int64_t pixels = static_cast<int64_t>(width) * height;
+        image.width = width;
+        image.height = height;
+        image.colour.resize(pixels);
+        image.albedo.resize(pixels);
+        image.normal.resize(pixels);
+        image.depth.resize(pixels);
+        image.samples.resize(pixels);
+
+        #pragma omp parallel for
+        for (int64_t i=0; i<pixels; i++)
+        {
+            image.colour[i] = glm::vec3(colour[i].x, colour[i].y, colour[i].z);
+            image.albedo[i] = UnpackFirstHitAlbedo(firstHits[i].z);
+            image.normal[i] = UnpackFirstHitNormal(firstHits[i].y);
+            memcpy(&image.depth[i], &firstHits[i].x, sizeof(float));
+            image.samples[i] = moments[i].y;
+        }
+    }
+
+    // CPU UNPACKING OF THE GUIDES, MATCHES PackFirstHit IN shaders/include/gbuffer.glsl
+    static glm::vec3 UnpackFirstHitAlbedo(uint32_t bits)
+    {
+        return glm::vec3(bits & 0xFF, (bits >> 8) & 0xFF, (bits >> 16) & 0xFF) / 255.0f;
+    }
+
+    static glm::vec3 UnpackFirstHitNormal(uint32_t bits)
+    {
+        glm::vec2 e(static_cast<float>(static_cast<int16_t>(bits & 0xFFFF)), static_cast<float>(static_cast<int16_t>(bits >> 16)));
+        e = glm::clamp(e / 32767.0f, -1.0f, 1.0f);
+        glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+        float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::length(n) > 0.0f ? glm::normalize(n) : n;
+    }
+
+    // BLENDS THE PREVIEW JUST DISPATCHED WITH THE HISTORY REPROJECTED FROM THE LAST ONE. THE
+    // RESULT BECOMES THE DISPLAY IMAGE AND THE HISTORY FOR THE NEXT FRAME
+    void ResolveTemporal(Camera& camera)
+    {
+        uint32_t next = 1 - historyIndex;
+        int width = RenderWidth();
+        int height = RenderHeight();
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glUseProgram(temporalShader);
+        glBindImageTexture(4, historyTextures[historyIndex], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+        glBindImageTexture(5, historyTextures[next], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glBindImageTexture(6, historyDepthTextures[historyIndex], 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(7, historyDepthTextures[next], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glUniform3fv(TEMPORAL_PREV_POS_LOCATION, 1, &historyCamera.pos.x);
+        glUniform3fv(TEMPORAL_PREV_FORWARD_LOCATION, 1, &historyCamera.forward.x);
+        glUniform3fv(TEMPORAL_PREV_RIGHT_LOCATION, 1, &historyCamera.right.x);
+        glUniform3fv(TEMPORAL_PREV_UP_LOCATION, 1, &historyCamera.up.x);
+        glUniform1f(TEMPORAL_PREV_FOV_LOCATION, historyCamera.FOV);
+        glUniform2ui(TEMPORAL_PREV_SIZE_LOCATION, static_cast<GLuint>(historyWidth), static_cast<GLuint>(historyHeight));
+        glUniform1ui(TEMPORAL_HISTORY_VALID_LOCATION, historyValid ? 1u : 0u);
+        glUniform1f(TEMPORAL_MAX_HISTORY_LOCATION, static_cast<float>(std::max(temporalHistory, 1)));
+
+        glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+
+        historyIndex = next;
+        historyCamera = camera.GetShaderConstants();
+        historyWidth = width;
+        historyHeight = height;
+        historyValid = true;
+    }
+
+    // START THE ACTIVE SET OVER, ADAPTIVE AND JOB STATE ONLY BELONG TO THE FINAL SET
+    void ResetAccumulation()
+    {
+        TileQueue.Clear();
+        accumulationFrame = 0;
+        frameCount = 0;
+        denoisePending = false;
+        if (activeTargets != &finalTargets) return;
+
+        denoiseValid = false;
+        cpuDenoiseGeneration++;
+        groupErrorGeneration++;
+        groupErrorReadPending = false;
+        groupErrorSamples = 0;
+        glm::vec4 blackColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClearTexImage(DisplayTexture, 0, GL_RGBA, GL_FLOAT, &blackColor);
+        renderConverged = false;
+        renderJobFinished = false;
+    }
+
+    // PATH STATE, HITS, QUEUES, SHADOW RAYS, SHADOW LIGHT AND COUNTERS FOR THE WAVEFRONT KERNELS
+    void AllocateWavefrontBuffers()
+    {
+        if (wavefrontAllocated) return;
+
+        uint64_t shadowSlots = static_cast<uint64_t>(WAVEFRONT_PATH_CAPACITY) * WAVEFRONT_SHADOW_SLOTS;
+        uint64_t sizes[6] = {
+            sizeof(WavefrontPath) * static_cast<uint64_t>(WAVEFRONT_PATH_CAPACITY),
+            sizeof(WavefrontHit) * static_cast<uint64_t>(WAVEFRONT_PATH_CAPACITY),
+            sizeof(uint32_t) * static_cast<uint64_t>(WAVEFRONT_PATH_CAPACITY) * 2,
+            sizeof(WavefrontShadowRay) * shadowSlots,
+            sizeof(glm::vec4) * shadowSlots,
+            sizeof(WavefrontCounters)
+        };
+
+        glGenBuffers(6, wavefrontBuffers);
+        for (int i=0; i<6; i++)
+        {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, wavefrontBuffers[i]);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizes[i]), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, WAVEFRONT_PATH_BINDING + i, wavefrontBuffers[i]);
+            MemoryTracker::Track("wavefront queues", wavefrontBuffers[i], sizes[i], sizes[i]);
+        }
+        wavefrontAllocated = true;
+    }
+
+    // RUNS THE BATCH'S TILE GROUPS AS WAVEFRONT CHUNKS, EACH CHUNK GENERATES CAMERA PATHS AND THEN
+    // EXTENDS, SHADES, SHADOW TESTS AND COMPACTS THEM ONCE PER BOUNCE. KERNELS AFTER GENERATE ARE
+    // DISPATCHED INDIRECTLY FROM THE QUEUE COUNTS SO FINISHED PATHS COST NOTHING
+    void DispatchWavefront(uint32_t currentBounces)
+    {
+        AllocateWavefrontBuffers();
+        unsigned int counterBuffer = wavefrontBuffers[5];
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, counterBuffer);
+
+        uint32_t chunkGroups = WAVEFRONT_PATH_CAPACITY / (32 * 32);
+        uint32_t groupCount = static_cast<uint32_t>(tileGroups.size());
+        for (uint32_t groupOffset=0; groupOffset<groupCount; groupOffset+=chunkGroups)
+        {
+            // EMPTY THE QUEUES, THE PREVIOUS CHUNK MAY STILL BE WRITING THE COUNTERS
+            WavefrontCounters counters = {};
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(WavefrontCounters), &counters);
+
+            // CAMERA PATHS INTO QUEUE 0
+            glUseProgram(wavefrontPrograms.generate);
+            glUniform1ui(WAVEFRONT_GROUP_OFFSET_LOCATION, groupOffset);
+            glDispatchCompute(std::min(chunkGroups, groupCount - groupOffset), 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+            uint32_t queue = 0;
+            PrepareWavefrontArgs(queue, 0);
+            for (uint32_t b=0; b<currentBounces+1; b++)
+            {
+                RunWavefrontKernel(wavefrontPrograms.extend, queue, offsetof(WavefrontCounters, activeArgs));
+                RunWavefrontKernel(wavefrontPrograms.shade, queue, offsetof(WavefrontCounters, activeArgs));
+                PrepareWavefrontArgs(queue, 1);
+
+                glUseProgram(wavefrontPrograms.shadow);
+                glDispatchComputeIndirect(offsetof(WavefrontCounters, shadowArgs));
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+                RunWavefrontKernel(wavefrontPrograms.compact, queue, offsetof(WavefrontCounters, activeArgs));
+                queue = 1 - queue;
+                PrepareWavefrontArgs(queue, 0);
+            }
+        }
+
+        // RESTORE THE MEGAKERNEL'S DISPATCH BUFFER
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatchIndirectBuffer);
+    }
+
+    void RunWavefrontKernel(unsigned int program, uint32_t queue, GLintptr argsOffset)
+    {
+        glUseProgram(program);
+        glUniform1ui(WAVEFRONT_QUEUE_LOCATION, queue);
+        glDispatchComputeIndirect(argsOffset);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // MODE 0 SIZES THE DISPATCHES FOR queue, MODE 1 FOR THE SHADOW RAYS
+    void PrepareWavefrontArgs(uint32_t queue, uint32_t mode)
+    {
+        glUseProgram(wavefrontPrograms.args);
+        glUniform1ui(WAVEFRONT_QUEUE_LOCATION, queue);
+        glUniform1ui(WAVEFRONT_ARGS_MODE_LOCATION, mode);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    }
 
     void ScheduleRenderTiles(int x_blocks, int y_blocks, uint32_t accumulationFrame)
     {
+        // EVERY TILE IN A PASS TAKES THE SAME NUMBER OF SAMPLES
+        passSamples = wavefront ? 1 : static_cast<uint32_t>(std::max(samplesPerDispatch, 1));
+        if (dynamicScene && !wavefront) passSamples = dynamicResolution.Samples();
+
+        // PREVIEW FRAMES ARE ONE TILE AND LEAVE THE FINAL SET'S SAMPLE MAP ALONE
         if (dynamicScene) 
         {
             RenderTile tile;
             tile.width = x_blocks;
             tile.height = y_blocks;
-            TileQueue.push_back(tile);
+            TileQueue.Push(tile);
+            return;
         }
-        else if (accumulationFrame == 0) // INITIAL TILE WIDTH
+
+        if (accumulationFrame == 0) std::fill(groupSampleCounts.begin(), groupSampleCounts.end(), 0);
+
+        if (accumulationFrame == 0) // INITIAL TILE WIDTH
         {
             int tileWidth = 5;
 
-            // CREATE SCHEDULE QUEUE
+            // CREATE SCHEDULE QUEUE, TILES ARE CLIPPED AT THE GRID EDGES
+            ResetSkyline(x_blocks, y_blocks);
+            RenderTile tile;
+            while (skyline.PlaceTile(tileWidth, tileWidth, tile))
+            {
+                TileQueue.Push(tile);
+            }
+        }
+        else 
+        { 
+            // SKIP CONVERGED GROUPS ONCE THE ERRORS THAT HAVE LANDED HAD ENOUGH SAMPLES FOR A VARIANCE ESTIMATE
+            bool adaptive = adaptiveSampling && groupErrorSamples >= adaptiveMinSamples;
+
+            ResetSkyline(x_blocks, y_blocks);
+            std::vector<RenderTile> tiles;
             int x = 0;
             int y = 0;
-            while (y < y_blocks)
+            while (skyline.FindSpace(x, y))
             {
                 // CREATE NEW RENDER TILE
                 RenderTile tile;
-                tile.width = std::min(tileWidth, x_blocks - x);
-                tile.height = std::min(tileWidth, y_blocks - y);
+                tile.width = 1;
+                tile.height = 1;
                 tile.x = x;
-                tile.y = y; 
+                tile.y = y;
+                tile.estimatedTime = groupTimes[y * x_blocks + x];
 
-                // ADD RENDER TILE TO QUEUE
-                TileQueue.push_back(tile);
+                // CONVERGED GROUPS ARE FILLED WITHOUT RENDERING
+                if (adaptive && !GroupActive(x, y, x_blocks))
+                {
+                    skyline.Occupy(tile);
+                    continue;
+                }
 
-                // INCREMENT X
-                x += tile.width;
+                GrowTile(tile, x_blocks, adaptive);
+                skyline.Occupy(tile);
+                tiles.push_back(tile);
+            }
 
-                // MOVE TO NEXT ROW
-                if (x >= x_blocks)
+            // NOISIEST TILES FIRST
+            if (adaptive)
+            {
+                std::vector<float> tileErrors(tiles.size());
+                std::vector<size_t> order(tiles.size());
+                for (size_t i=0; i<tiles.size(); i++)
                 {
-                    x = 0;
-                    y += tile.height;
+                    tileErrors[i] = GetTileError(tiles[i], x_blocks);
+                    order[i] = i;
                 }
+                std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tileErrors[a] > tileErrors[b]; });
+                for (size_t i : order) TileQueue.Push(tiles[i]);
+            }
+            else
+            {
+                for (const RenderTile& tile : tiles) TileQueue.Push(tile);
+            }
+
+            if (TileQueue.Empty())
+            {
+                renderConverged = true;
+                convergedThreshold = noiseThreshold;
             }
         }
-        else 
-        { 
-            for (int i=0; i<occupiedColumnHeights.size(); i++) occupiedColumnHeights[i] = 0;
-            int x = 0;
-            int y = 0;
-            while (true)
+
+        UpdateSampleMap(x_blocks, y_blocks);
+    }
+
+    // THE SKYLINE COVERS THE WHOLE GRID, OR ONLY THE RENDER REGION. COLUMNS BESIDE THE REGION AND
+    // ROWS BELOW IT START FULL AND ROWS ABOVE IT ARE CUT OFF, SO TILES ONLY LAND INSIDE
+    void ResetSkyline(int x_blocks, int y_blocks)
+    {
+        if (renderRegion.width <= 0 || renderRegion.height <= 0)
+        {
+            skyline.Reset(x_blocks, y_blocks);
+            return;
+        }
+
+        int left = std::clamp(renderRegion.x, 0, x_blocks);
+        int right = std::clamp(renderRegion.x + renderRegion.width, left, x_blocks);
+        int bottom = std::clamp(renderRegion.y, 0, y_blocks);
+        int top = std::clamp(renderRegion.y + renderRegion.height, bottom, y_blocks);
+        skyline.Reset(x_blocks, top);
+
+        RenderTile filled;
+        filled.height = top;
+        filled.width = left;
+        skyline.Occupy(filled);
+        filled.x = right;
+        filled.width = x_blocks - right;
+        skyline.Occupy(filled);
+        filled.x = left;
+        filled.width = right - left;
+        filled.height = bottom;
+        skyline.Occupy(filled);
+    }
+
+    // EVERYTHING THAT DECIDES WHICH SAMPLES LAND IN A PIXEL, A CHECKPOINT ONLY RESUMES INTO THE SAME KEY
+    uint64_t CheckpointKey(Camera& camera)
+    {
+        uint64_t poseHash = camera.GetPoseHash();
+        uint32_t settings[] = { static_cast<uint32_t>(bounces), static_cast<uint32_t>(samplesPerDispatch), adaptiveSampling ? 1u : 0u, adaptiveMinSamples, wavefront ? 1u : 0u, firstSample,
+                                static_cast<uint32_t>(renderRegion.x), static_cast<uint32_t>(renderRegion.y), static_cast<uint32_t>(renderRegion.width), static_cast<uint32_t>(renderRegion.height) };
+        float values[] = { noiseThreshold, skyColour.x, skyColour.y, skyColour.z, skyBrightness };
+
+        uint64_t key = HashBytes(&checkpointSceneHash, sizeof(checkpointSceneHash));
+        key = HashBytes(&poseHash, sizeof(poseHash), key);
+        key = HashBytes(settings, sizeof(settings), key);
+        return HashBytes(values, sizeof(values), key);
+    }
+
+    // CALLED BETWEEN PASSES, WHEN EVERY QUEUED DISPATCH HAS ADDED THE SAME SAMPLES TO ITS PIXELS
+    void CheckpointIfDue(Camera& camera)
+    {
+        if (checkpointPath.empty() || activeTargets != &finalTargets || checkpointWriter.Busy()) return;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - lastCheckpoint).count() < checkpointInterval) return;
+
+        CheckpointHeader header = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION, CheckpointKey(camera), finalTargets.width, finalTargets.height, accumulationFrame, frameCount, static_cast<uint32_t>(groupErrors.size()), 0 };
+        CheckpointSources sources = { finalTargets.renderTexture, finalTargets.momentTexture, finalTargets.firstHitTexture, finalTargets.displayTexture, finalTargets.groupErrorBuffer };
+        checkpointWriter.Capture(checkpointPath, header, sources, groupSampleCounts);
+        lastCheckpoint = now;
+    }
+
+    // CALLED AT THE END OF EACH ACCUMULATION PASS
+    void CheckRenderJobComplete()
+    {
+        if (dynamicScene) return;
+
+        if (renderJob.targetSamples > 0 && frameCount >= renderJob.targetSamples)
+        {
+            FinishRenderJob(RenderJobStopReason::TargetSamples);
+            return;
+        }
+
+        // ERRORS NEED A FEW SAMPLES BEFORE THE VARIANCE ESTIMATE MEANS ANYTHING
+        if (renderJob.targetError > 0.0f && groupErrorSamples >= adaptiveMinSamples && GetMaxGroupError() <= renderJob.targetError)
+        {
+            FinishRenderJob(RenderJobStopReason::TargetError);
+        }
+    }
+
+    void FinishRenderJob(RenderJobStopReason reason)
+    {
+        renderJobResult.job = renderJob;
+        renderJobResult.reason = reason;
+        renderJobResult.samples = frameCount;
+        renderJobResult.elapsedTime = GetRenderJobElapsedTime();
+        renderJobResult.maxError = GetMaxGroupError();
+
+        // DROP QUEUED TILES SO NO MORE WORK IS ISSUED FOR THIS JOB
+        TileQueue.Clear();
+        renderJobActive = false;
+        renderJobFinished = reason != RenderJobStopReason::Cancelled;
+
+        // THE COMPLETION EVENT WAITS FOR THE ERRORS OF THE LAST PASS, AND THE EXPORT THAT FOLLOWS
+        // SHOULD SEE THE CPU DENOISED IMAGE. BOTH LAND IN A LATER Poll, THE DENOISED IMAGE LAST
+        bool denoiseOnCPU = renderJobFinished && denoiseMode == DenoiseMode::CPU;
+        uint32_t jobGeneration = renderJobGeneration;
+        if (frameCount < adaptiveMinSamples)
+        {
+            if (!denoiseOnCPU) renderJobCompletePending = true;
+        }
+        else
+        {
+            uint32_t generation = groupErrorGeneration;
+            uint32_t samples = frameCount;
+            readback.ReadBuffer(finalTargets.groupErrorBuffer, 0, groupErrors.size() * sizeof(float), [this, jobGeneration, generation, samples, denoiseOnCPU](const ReadbackBytes& bytes)
             {
-                // CREATE NEW RENDER TILE
-                std::tuple<int, int> coords = FindAvailableTileSpace(x_blocks, y_blocks);
-                x = std::get<0>(coords);
-                y = std::get<1>(coords);
-                if (x >= x_blocks || y >= y_blocks) break;
+                if (jobGeneration != renderJobGeneration) return;
+                if (generation == groupErrorGeneration) StoreGroupErrors(bytes, samples);
+                renderJobResult.maxError = GetMaxGroupError();
+                if (!denoiseOnCPU) renderJobCompletePending = true;
+            });
+        }
+        if (denoiseOnCPU)
+        {
+            DenoiseOnCPU([this, jobGeneration](bool current)
+            {
+                if (jobGeneration != renderJobGeneration) return;
+                if (!current) std::cerr << "[FinishRenderJob] Failed! The CPU denoised image went stale, the job finishes without it" << std::endl;
+                renderJobCompletePending = true;
+            });
+        }
+    }
 
-                RenderTile tile;
-                tile.width = 1;
-                tile.height = 1;
-                tile.x = std::get<0>(coords);
-                tile.y = std::get<1>(coords);
+    float GetMaxGroupError()
+    {
+        float maxError = 0.0f;
+        for (float error : groupErrors) maxError = std::max(maxError, error);
+        return maxError;
+    }
+
+    // QUEUES A COPY OF THE PER GROUP ERRORS WRITTEN BY THE PATH TRACER, ONE AT A TIME. THE NEXT
+    // PASSES ARE SCHEDULED FROM WHATEVER HAS LANDED SO THE GPU QUEUE IS NEVER DRAINED
+    void RequestGroupErrors()
+    {
+        if (groupErrorReadPending) return;
+        groupErrorReadPending = true;
+
+        uint32_t generation = groupErrorGeneration;
+        uint32_t samples = frameCount;
+        readback.ReadBuffer(finalTargets.groupErrorBuffer, 0, groupErrors.size() * sizeof(float), [this, generation, samples](const ReadbackBytes& bytes)
+        {
+            if (generation != groupErrorGeneration) return;
+            groupErrorReadPending = false;
+            StoreGroupErrors(bytes, samples);
+        });
+    }
+
+    // A RESIZED GRID OR A FAILED MAP LEAVES THE ERRORS AS THEY WERE
+    void StoreGroupErrors(const ReadbackBytes& bytes, uint32_t samples)
+    {
+        if (bytes.size() != groupErrors.size() * sizeof(float)) return;
+        memcpy(groupErrors.data(), bytes.data(), bytes.size());
+        groupErrorSamples = samples;
+        CountConvergedGroups();
+    }
 
-                GrowTile(tile, x_blocks, y_blocks);
-                TileQueue.push_back(tile);
+    void CountConvergedGroups()
+    {
+        convergedGroupCount = 0;
+        for (float error : groupErrors) if (error < noiseThreshold) convergedGroupCount++;
+    }
+
+    bool GroupActive(int x, int y, int x_blocks)
+    {
+        return groupErrors[y * x_blocks + x] >= noiseThreshold;
+    }
+
+    bool RowActive(int x, int y, int width, int x_blocks)
+    {
+        for (int i=0; i<width; i++) if (!GroupActive(x + i, y, x_blocks)) return false;
+        return true;
+    }
+
+    bool ColumnActive(int x, int y, int height, int x_blocks)
+    {
+        for (int i=0; i<height; i++) if (!GroupActive(x, y + i, x_blocks)) return false;
+        return true;
+    }
+
+    float GetTileError(const RenderTile& tile, int x_blocks)
+    {
+        float error = 0.0f;
+        for (int y=0; y<tile.height; y++) for (int x=0; x<tile.width; x++)
+        {
+            error = std::max(error, groupErrors[(tile.y + y) * x_blocks + (tile.x + x)]);
+        }
+        return error;
+    }
+
+    // BLUE FOR FEW SAMPLES THROUGH TO RED FOR THE MOST SAMPLED GROUPS
+    void UpdateSampleMap(int x_blocks, int y_blocks)
+    {
+        uint32_t maxSamples = 1;
+        for (uint32_t samples : groupSampleCounts) maxSamples = std::max(maxSamples, samples);
+
+        sampleMapPixels.resize(static_cast<size_t>(x_blocks) * y_blocks * 4);
+        for (int y=0; y<y_blocks; y++) for (int x=0; x<x_blocks; x++)
+        {
+            float t = static_cast<float>(groupSampleCounts[y * x_blocks + x]) / static_cast<float>(maxSamples);
+            float red = std::clamp(t * 2.0f - 0.5f, 0.0f, 1.0f);
+            float green = std::clamp(1.0f - std::abs(t * 2.0f - 1.0f), 0.0f, 1.0f);
+            float blue = std::clamp(1.5f - t * 2.0f, 0.0f, 1.0f);
+
+            // FLIP ROWS, GROUP ROW 0 IS THE BOTTOM OF THE IMAGE
+            size_t pixel = (static_cast<size_t>(y_blocks - 1 - y) * x_blocks + x) * 4;
+            sampleMapPixels[pixel + 0] = static_cast<uint8_t>(red * 255.0f);
+            sampleMapPixels[pixel + 1] = static_cast<uint8_t>(green * 255.0f);
+            sampleMapPixels[pixel + 2] = static_cast<uint8_t>(blue * 255.0f);
+            sampleMapPixels[pixel + 3] = 255;
+        }
+
+        sampleMapWidth = x_blocks;
+        sampleMapHeight = y_blocks;
+        glBindTexture(GL_TEXTURE_2D, SampleMapTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, x_blocks, y_blocks, 0, GL_RGBA, GL_UNSIGNED_BYTE, sampleMapPixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void UploadFrameConstants(Camera& camera, uint32_t currentBounces)
+    {
+        FrameConstants constants;
+        constants.cameraInfo = camera.GetShaderConstants();
+        constants.skyColour = skyColour;
+        constants.skyBrightness = skyBrightness;
+        constants.frameCount = firstSample + frameCount;
+        constants.accumulationFrame = accumulationFrame;
+        constants.bounces = currentBounces;
+        constants.resolutionScale = resolutionScale;
+        constants.meshCount = sceneMeshCount;
+        constants.directionalLightCount = sceneDirectionalLightCount;
+        constants.pointLightCount = scenePointLightCount;
+        constants.spotlightCount = sceneSpotlightCount;
+        constants.debugMode = 0;
+        constants.statsSlot = nextBatchQuery;
+        constants.samplesPerDispatch = passSamples;
+        constants.renderWidth = static_cast<uint32_t>(RenderWidth());
+        constants.renderHeight = static_cast<uint32_t>(RenderHeight());
+
+        glBindBuffer(GL_UNIFORM_BUFFER, frameConstantsBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &constants);
+    }
+
+    // READ BACK FINISHED BATCH TIMERS IN ISSUE ORDER WITHOUT STALLING. A BATCH MAY LAND AFTER
+    // THE OTHER TARGET SET WAS ACTIVATED, SO ITS TILES ARE MAPPED WITH THE GRID IT WAS CUT FROM
+    void CollectBatchTimings()
+    {
+        while (batchQueries[oldestBatchQuery].pending)
+        {
+            BatchTimerQuery& batchQuery = batchQueries[oldestBatchQuery];
+
+            int available = 0;
+            glGetQueryObjectiv(batchQuery.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+
+            uint64_t elapsedTime = 0;
+            glGetQueryObjectui64v(batchQuery.query, GL_QUERY_RESULT, &elapsedTime);
+            batchQuery.pending = false;
+
+            // AVERAGE RAYS/SEC OVER HALF A SECOND OF GPU TIME SO THE FIGURE IS READABLE
+            rayWindowCount += rayCounts[oldestBatchQuery];
+            renderJobRayCount += rayCounts[oldestBatchQuery];
+            sampleWindowCount += batchQuery.pixelSamples;
+            rayWindowTime += elapsedTime / 1000000000.0f;
+            if (rayWindowTime >= 0.5f)
+            {
+                raysPerSecond = static_cast<float>(rayWindowCount) / rayWindowTime;
+                samplesPerSecond = static_cast<float>(sampleWindowCount) / rayWindowTime;
+                rayWindowCount = 0;
+                sampleWindowCount = 0;
+                rayWindowTime = 0.0f;
+            }
+            oldestBatchQuery = (oldestBatchQuery + 1) % BATCH_QUERY_COUNT;
+
+            // NAVIGATION FRAMES DRIVE THE DYNAMIC RESOLUTION CONTROLLER
+            if (batchQuery.dynamic) dynamicResolution.AddFrameTime(elapsedTime / 1000000.0f, batchQuery.resolutionScale, batchQuery.bounces, batchQuery.samples);
+
+            if (!batchQuery.recordTiming || batchQuery.generation != timingGeneration) continue;
+            if (batchQuery.predictedTime <= 0.0f) continue;
+
+            // RESCALE THE GROUP TIMES OF THE BATCH SO THEIR SUM MATCHES THE MEASURED TIME
+            float timeScale = (elapsedTime / 1000000.0f) / batchQuery.predictedTime;
+            for (const RenderTile& tile : batchQuery.tiles)
+            {
+                for (int y=0; y<tile.height; y++) for (int x=0; x<tile.width; x++)
+                {
+                    int groupIndex = (y + tile.y) * batchQuery.groupColumns + (x + tile.x);
+                    groupTimes[groupIndex] *= timeScale;
+                }
             }
         }
     }
 
+    float EstimateTileTime(const RenderTile& tile, int x_blocks)
+    {
+        float totalTime = 0;
+        for (int y=0; y<tile.height; y++)
+        {
+            totalTime += GetHorizontalTime(tile.x, tile.y + y, tile.width, x_blocks);
+        }
+        return totalTime;
+    }
+
     float GetHorizontalTime(int x, int y, int width, int x_blocks)
     {
         float totalTime = 0;
@@ -446,17 +2002,23 @@ private:
         return totalTime;
     }
 
-    void GrowTile(RenderTile &tile, int x_blocks, int y_blocks)
+    void GrowTile(RenderTile &tile, int x_blocks, bool adaptive)
     {
-        while (tile.estimatedTime < renderBudget)
+        // GROUP TIMES ARE PER SAMPLE, A TILE TAKING MORE SAMPLES COVERS LESS OF THE IMAGE
+        float tileBudget = renderBudget / passSamples;
+        while (tile.estimatedTime < tileBudget)
         {
-            bool hSpace = tile.y + tile.height < y_blocks; 
-            bool vSpace = tile.x + tile.width < x_blocks; 
+            bool hSpace = tile.y + tile.height < skyline.Rows(); 
+            bool vSpace = tile.x + tile.width < x_blocks && skyline.ColumnHeight(tile.x + tile.width) == tile.y; 
+
+            // DON'T GROW OVER CONVERGED GROUPS
+            if (adaptive && hSpace) hSpace = RowActive(tile.x, tile.y + tile.height, tile.width, x_blocks);
+            if (adaptive && vSpace) vSpace = ColumnActive(tile.x + tile.width, tile.y, tile.height, x_blocks);
 
             if (hSpace)
             {
                 float hTime = GetHorizontalTime(tile.x, tile.y + tile.height, tile.width, x_blocks);
-                if (tile.estimatedTime + hTime < renderBudget) {
+                if (tile.estimatedTime + hTime < tileBudget) {
                     tile.height += 1;
                     tile.estimatedTime += hTime;
                 }
@@ -469,7 +2031,7 @@ private:
             if (vSpace)
             {
                 float vTime = GetVerticalTime(tile.x + tile.width, tile.y, tile.height, x_blocks);
-                if (tile.estimatedTime + vTime < renderBudget) {
+                if (tile.estimatedTime + vTime < tileBudget) {
                     tile.width += 1;
                     tile.estimatedTime += vTime;
                 }
@@ -481,30 +2043,6 @@ private:
 
             if (!hSpace && !vSpace) break;
         }
-
-        for (int x=tile.x; x<tile.x+tile.width; x++)
-        {
-            occupiedColumnHeights[x] = static_cast<uint16_t>(tile.y + tile.height);
-        }
-    }
-
-    std::tuple<int, int> FindAvailableTileSpace(int x_blocks, int y_blocks)
-    {
-        int x = x_blocks;
-        int y = y_blocks;
-        if (TileQueue.size() == 0) { return std::make_tuple(0, 0); }
-
-        uint16_t minY = y_blocks;
-        for (int col=0; col<x_blocks; col++)
-        {
-            if (occupiedColumnHeights[col] < minY)
-            {
-                minY = occupiedColumnHeights[col];
-                x = col;
-                y = static_cast<int>(minY);
-            }
-        }
-        return std::make_tuple(x, y);
     }
 };
 
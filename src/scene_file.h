@@ -0,0 +1,250 @@
+#pragma once
+
+// STANDARD LIBRARY
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+// PROJECT HEADERS
+#include "camera.h"
+#include "checkpoint.h"
+#include "render_system.h"
+#include "model_manager.h"
+#include "light_manager.h"
+#include "material_manager.h"
+
+// PLAIN TEXT SCENE DESCRIPTION FOR BATCH RENDERS. ONE ENTRY PER LINE, # STARTS A COMMENT,
+// ANGLES ARE IN DEGREES AND MODEL PATHS ARE RELATIVE TO THE SCENE FILE:
+//
+//   camera <x> <y> <z> <pitch> <yaw> <fov>
+//   exposure <value>
+//   dof <focus distance> <fStop>
+//   sky <r> <g> <b> <brightness>
+//   material <name> <r> <g> <b> <roughness> <emission> [<IOR> <refractive 0|1>]
+//   model <obj path> [material <name>] [position <x> <y> <z>] [rotation <x> <y> <z>] [scale <s>]
+//   directional <rx> <ry> <rz> <r> <g> <b> <brightness>
+//   point <x> <y> <z> <r> <g> <b> <brightness>
+//   spot <x> <y> <z> <rx> <ry> <rz> <r> <g> <b> <brightness> <angle> <falloff>
+
+class SceneFileReader
+{
+public:
+
+    SceneFileReader(Camera& _camera, RenderSystem& _renderSystem, ModelManager& _modelManager, LightManager& _lightManager, MaterialManager& _materialManager) :
+    camera(_camera),
+    renderSystem(_renderSystem),
+    modelManager(_modelManager),
+    lightManager(_lightManager),
+    materialManager(_materialManager)
+    {
+
+    }
+
+    void Load(const std::string& filepath)
+    {
+        std::ifstream stream(filepath);
+        if (!stream.is_open())
+        {
+            throw std::runtime_error("[SceneFileReader] <Error> Failed to open scene file \"" + filepath + "\"");
+        }
+
+        directory = filepath.substr(0, filepath.find_last_of("/\\") + 1);
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(stream, line))
+        {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            sceneHash = HashBytes(line.data(), line.size(), sceneHash);
+            std::istringstream entry(line);
+            std::string keyword;
+            if (!(entry >> keyword)) continue;
+
+            try
+            {
+                ReadEntry(keyword, entry);
+            }
+            catch (const std::exception& e)
+            {
+                throw std::runtime_error("[SceneFileReader] <Error> " + filepath + ":" + std::to_string(lineNumber) + " " + e.what());
+            }
+        }
+
+        renderSystem.SetSceneCounts(modelManager.meshCount, static_cast<uint32_t>(lightManager.directionalLights.size()), static_cast<uint32_t>(lightManager.pointLights.size()), static_cast<uint32_t>(lightManager.spotlights.size()));
+    }
+
+    // CHANGES WITH ANY ENTRY OF THE SCENE FILE OR BYTE OF THE MODELS IT LOADS
+    uint64_t GetSceneHash() const
+    {
+        return sceneHash;
+    }
+
+private:
+
+    Camera& camera;
+    RenderSystem& renderSystem;
+    ModelManager& modelManager;
+    LightManager& lightManager;
+    MaterialManager& materialManager;
+    std::string directory;
+    std::unordered_map<std::string, int> materialIndices;
+    uint64_t sceneHash = HashBytes(nullptr, 0);
+
+    void ReadEntry(const std::string& keyword, std::istringstream& entry)
+    {
+        if (keyword == "camera")
+        {
+            camera.pos = ReadVec3(entry);
+            camera.rotation.x = ReadFloat(entry);
+            camera.rotation.y = ReadFloat(entry);
+            camera.fov = ReadFloat(entry);
+        }
+        else if (keyword == "exposure")
+        {
+            camera.exposure = ReadFloat(entry);
+        }
+        else if (keyword == "dof")
+        {
+            camera.dof = true;
+            camera.focus_distance = ReadFloat(entry);
+            camera.fStop = ReadFloat(entry);
+        }
+        else if (keyword == "sky")
+        {
+            renderSystem.skyColour = ReadVec3(entry);
+            renderSystem.skyBrightness = ReadFloat(entry);
+        }
+        else if (keyword == "material")
+        {
+            std::string name = ReadWord(entry);
+            MaterialData data;
+            data.colour = ReadVec3(entry);
+            data.roughness = ReadFloat(entry);
+            data.emission = ReadFloat(entry);
+            float IOR;
+            if (entry >> IOR)
+            {
+                data.IOR = IOR;
+                data.refractive = ReadFloat(entry) != 0.0f ? 1 : 0;
+            }
+            materialIndices[name] = materialManager.AddMaterial(data, name);
+        }
+        else if (keyword == "model")
+        {
+            ReadModel(entry);
+        }
+        else if (keyword == "directional")
+        {
+            lightManager.AddDirectionalLight();
+            DirectionalLight& light = lightManager.directionalLights.back();
+            light.rotation = ReadVec3(entry);
+            light.colour = ReadVec3(entry);
+            light.brightness = ReadFloat(entry);
+            light.TransformDirection();
+            lightManager.UpdateDirectionalLight(static_cast<int>(lightManager.directionalLights.size()) - 1);
+        }
+        else if (keyword == "point")
+        {
+            lightManager.AddPointLight();
+            PointLight& light = lightManager.pointLights.back();
+            light.position = ReadVec3(entry);
+            light.colour = ReadVec3(entry);
+            light.brightness = ReadFloat(entry);
+            lightManager.UpdatePointLight(static_cast<int>(lightManager.pointLights.size()) - 1);
+        }
+        else if (keyword == "spot")
+        {
+            lightManager.AddSpotlight();
+            Spotlight& light = lightManager.spotlights.back();
+            light.position = ReadVec3(entry);
+            light.rotation = ReadVec3(entry);
+            light.colour = ReadVec3(entry);
+            light.brightness = ReadFloat(entry);
+            light.angle = ReadFloat(entry);
+            light.falloff = ReadFloat(entry);
+            light.TransformDirection();
+            lightManager.UpdateSpotlight(static_cast<int>(lightManager.spotlights.size()) - 1);
+        }
+        else
+        {
+            throw std::runtime_error("unknown entry \"" + keyword + "\"");
+        }
+    }
+
+    void ReadModel(std::istringstream& entry)
+    {
+        std::string path = ReadWord(entry);
+        if (path.empty() || (path[0] != '/' && path.find(':') == std::string::npos)) path = directory + path;
+
+        int materialIndex = 0;
+        glm::vec3 position(0.0f);
+        glm::vec3 rotation(0.0f);
+        float scale = 1.0f;
+        std::string option;
+        while (entry >> option)
+        {
+            if (option == "material")
+            {
+                std::string name = ReadWord(entry);
+                auto found = materialIndices.find(name);
+                if (found == materialIndices.end()) throw std::runtime_error("unknown material \"" + name + "\"");
+                materialIndex = found->second;
+            }
+            else if (option == "position") position = ReadVec3(entry);
+            else if (option == "rotation") rotation = ReadVec3(entry);
+            else if (option == "scale") scale = ReadFloat(entry);
+            else throw std::runtime_error("unknown model option \"" + option + "\"");
+        }
+
+        HashFile(path);
+        modelManager.LoadModel(path.c_str());
+        int instanceID = modelManager.CreateModelInstance(static_cast<int>(modelManager.models.size()) - 1);
+        Model& instance = modelManager.modelInstances[instanceID];
+        for (Mesh* mesh : instance.submeshPtrs)
+        {
+            mesh->position = position;
+            mesh->rotation = rotation;
+            mesh->scale = glm::vec3(scale);
+        }
+        modelManager.AddModelToScene(&instance);
+
+        // THE INSTANCE'S PARTITIONS ARE THE LAST ONES ADDED, MESH IDS ARE NOT PARTITION INDICES
+        uint32_t firstPartition = static_cast<uint32_t>(modelManager.meshCount) - static_cast<uint32_t>(instance.meshIDs.size());
+        for (uint32_t i=0; i<instance.meshIDs.size(); i++) modelManager.UpdateMeshMaterial(firstPartition + i, static_cast<uint32_t>(materialIndex));
+    }
+
+    void HashFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> buffer(1 << 20);
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+        {
+            sceneHash = HashBytes(buffer.data(), static_cast<size_t>(file.gcount()), sceneHash);
+        }
+    }
+
+    static std::string ReadWord(std::istringstream& entry)
+    {
+        std::string word;
+        if (!(entry >> word)) throw std::runtime_error("missing value");
+        return word;
+    }
+
+    static float ReadFloat(std::istringstream& entry)
+    {
+        float value;
+        if (!(entry >> value)) throw std::runtime_error("expected a number");
+        return value;
+    }
+
+    static glm::vec3 ReadVec3(std::istringstream& entry)
+    {
+        float x = ReadFloat(entry);
+        float y = ReadFloat(entry);
+        float z = ReadFloat(entry);
+        return glm::vec3(x, y, z);
+    }
+};
@@ -0,0 +1,412 @@
+#pragma once
+
+// EXTERNAL LIBRARIES
+#include "../lib/glm/glm.hpp"
+
+// STANDARD LIBRARY
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// PROJECT HEADERS
+#include "mesh.h"
+#include "camera.h"
+
+#define SCENE_QUERY_MISS 1e30f
+#define SCENE_QUERY_STACK_SIZE 64
+
+struct SceneRay
+{
+    glm::vec3 origin;
+    glm::vec3 dir;
+};
+
+struct SceneHit
+{
+    int meshIndex = -1; // PARTITION INDEX, -1 FOR NOTHING
+    float dist = SCENE_QUERY_MISS;
+};
+
+// A MESH PLACED IN THE SCENE, MIRRORS ITS PARTITION ON THE GPU
+struct SceneInstance
+{
+    Mesh* mesh;
+    glm::mat4 inverseTransform;
+    glm::vec3 worldMin;
+    glm::vec3 worldMax;
+};
+
+// SCREEN RECTANGLE IN VIEWPORT PIXELS, ROWS RUN BOTTOM TO TOP LIKE THE RENDER TARGETS
+struct ScreenRect
+{
+    float minX, minY;
+    float maxX, maxY;
+};
+
+// RAY QUERIES OVER THE SCENE ON THE CPU, FOR PICKING, RECTANGLE SELECTION AND HOVER WITHOUT
+// TOUCHING THE GPU QUEUE. A SMALL BVH OVER THE WORLD BOUNDS OF THE INSTANCES FINDS THE
+// CANDIDATES, EACH IS THEN TRAVERSED IN OBJECT SPACE THROUGH THE MESH BVH THE RENDERER USES
+class SceneQuery
+{
+public:
+
+    void AddInstance(Mesh* mesh)
+    {
+        SceneInstance instance;
+        instance.mesh = mesh;
+        instances.push_back(instance);
+        SetTransform(static_cast<uint32_t>(instances.size()) - 1, mesh->inverseTransform);
+    }
+
+    void RemoveInstance(uint32_t meshIndex)
+    {
+        if (meshIndex >= instances.size()) return;
+        instances.erase(instances.begin() + meshIndex);
+        dirty = true;
+    }
+
+    void SetTransform(uint32_t meshIndex, const glm::mat4& inverseTransform)
+    {
+        if (meshIndex >= instances.size()) return;
+        SceneInstance& instance = instances[meshIndex];
+        instance.inverseTransform = inverseTransform;
+        ComputeWorldBounds(instance);
+        dirty = true;
+    }
+
+    int InstanceCount() const
+    {
+        return static_cast<int>(instances.size());
+    }
+
+    // CLOSEST HIT ALONG THE RAY, dir NEED NOT BE NORMALISED
+    SceneHit Intersect(const SceneRay& ray)
+    {
+        SceneHit closest;
+        if (instances.empty()) return closest;
+        RebuildIfDirty();
+
+        glm::vec3 inverseDir = 1.0f / ray.dir;
+        uint32_t stack[SCENE_QUERY_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const TopNode& node = topNodes[stack[--stackSize]];
+            if (IntersectAABB(ray.origin, inverseDir, node.aabbMin, node.aabbMax) >= closest.dist) continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t i=0; i<node.count; i++)
+                {
+                    uint32_t meshIndex = instanceOrder[node.first + i];
+                    float dist = IntersectInstance(instances[meshIndex], ray, closest.dist);
+                    if (dist < closest.dist)
+                    {
+                        closest.dist = dist;
+                        closest.meshIndex = static_cast<int>(meshIndex);
+                    }
+                }
+                continue;
+            }
+
+            // NEARER CHILD IS POPPED FIRST SO THE FAR ONE IS USUALLY CULLED
+            const TopNode& left = topNodes[node.left];
+            const TopNode& right = topNodes[node.left + 1];
+            float leftDist = IntersectAABB(ray.origin, inverseDir, left.aabbMin, left.aabbMax);
+            float rightDist = IntersectAABB(ray.origin, inverseDir, right.aabbMin, right.aabbMax);
+            uint32_t nearChild = leftDist <= rightDist ? node.left : node.left + 1;
+            uint32_t farChild = leftDist <= rightDist ? node.left + 1 : node.left;
+            if (stackSize + 2 > SCENE_QUERY_STACK_SIZE) continue;
+            stack[stackSize++] = farChild;
+            stack[stackSize++] = nearChild;
+        }
+        return closest;
+    }
+
+    // SAME RAY AS PixelRayPos IN THE SHADERS, x AND y IN VIEWPORT PIXELS FROM THE BOTTOM LEFT
+    static SceneRay PixelRay(Camera& camera, float x, float y, int width, int height)
+    {
+        CameraConstants constants = camera.GetShaderConstants();
+        float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+        float planeHeight = NEAR_PLANE * tanf(glm::radians(constants.FOV) * 0.5f);
+        float planeWidth = planeHeight * aspectRatio;
+
+        float localX = -planeWidth * 0.5f + planeWidth * (x / (width - 1.0f));
+        float localY = -planeHeight * 0.5f + planeHeight * (y / (height - 1.0f));
+        glm::vec3 worldPoint = constants.pos - constants.right * localX + constants.up * localY + constants.forward * NEAR_PLANE;
+
+        SceneRay ray;
+        ray.origin = constants.pos;
+        ray.dir = glm::normalize(worldPoint - constants.pos);
+        return ray;
+    }
+
+    SceneHit Pick(Camera& camera, float x, float y, int width, int height)
+    {
+        return Intersect(PixelRay(camera, x, y, width, height));
+    }
+
+    // INVERSE OF PixelRay, FALSE FOR POINTS BEHIND THE NEAR PLANE
+    static bool ProjectToPixel(const CameraConstants& constants, const glm::vec3& point, int width, int height, float& x, float& y)
+    {
+        glm::vec3 offset = point - constants.pos;
+        float depth = glm::dot(offset, constants.forward);
+        if (depth < NEAR_PLANE) return false;
+
+        float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+        float planeHeight = NEAR_PLANE * tanf(glm::radians(constants.FOV) * 0.5f);
+        float planeWidth = planeHeight * aspectRatio;
+        float localX = -glm::dot(offset, constants.right) * NEAR_PLANE / depth;
+        float localY = glm::dot(offset, constants.up) * NEAR_PLANE / depth;
+        x = (localX / planeWidth + 0.5f) * (width - 1.0f);
+        y = (localY / planeHeight + 0.5f) * (height - 1.0f);
+        return true;
+    }
+
+    // PIXEL BOUNDS OF A MESH, FALSE IF ANY CORNER IS BEHIND THE CAMERA
+    bool ProjectBounds(Camera& camera, uint32_t meshIndex, int width, int height, ScreenRect& rect)
+    {
+        if (meshIndex >= instances.size()) return false;
+        const SceneInstance& instance = instances[meshIndex];
+        CameraConstants constants = camera.GetShaderConstants();
+        rect = { 1e30f, 1e30f, -1e30f, -1e30f };
+        for (int corner=0; corner<8; corner++)
+        {
+            glm::vec3 point(
+                (corner & 1) ? instance.worldMax.x : instance.worldMin.x,
+                (corner & 2) ? instance.worldMax.y : instance.worldMin.y,
+                (corner & 4) ? instance.worldMax.z : instance.worldMin.z
+            );
+            float x, y;
+            if (!ProjectToPixel(constants, point, width, height, x, y)) return false;
+            rect.minX = std::min(rect.minX, x);
+            rect.minY = std::min(rect.minY, y);
+            rect.maxX = std::max(rect.maxX, x);
+            rect.maxY = std::max(rect.maxY, y);
+        }
+        return true;
+    }
+
+    // MESHES WHOSE WORLD BOUNDS CENTRE PROJECTS INTO THE RECTANGLE, NEAREST FIRST
+    std::vector<int> SelectRect(Camera& camera, const ScreenRect& rect, int width, int height)
+    {
+        CameraConstants constants = camera.GetShaderConstants();
+        std::vector<std::pair<float, int>> found;
+        for (uint32_t i=0; i<instances.size(); i++)
+        {
+            glm::vec3 centre = (instances[i].worldMin + instances[i].worldMax) * 0.5f;
+            float x, y;
+            if (!ProjectToPixel(constants, centre, width, height, x, y)) continue;
+            if (x < rect.minX || x > rect.maxX || y < rect.minY || y > rect.maxY) continue;
+            found.push_back({ glm::dot(centre - constants.pos, constants.forward), static_cast<int>(i) });
+        }
+        std::sort(found.begin(), found.end());
+
+        std::vector<int> meshIndices;
+        for (const auto& entry : found) meshIndices.push_back(entry.second);
+        return meshIndices;
+    }
+
+private:
+
+    // MATCHES THE NEAR PLANE OF PixelRayPos
+    static constexpr float NEAR_PLANE = 0.1f;
+
+    // first IS THE FIRST ENTRY OF instanceOrder FOR LEAVES, INTERIOR NODES KEEP BOTH CHILDREN
+    // SIDE BY SIDE AT left AND left + 1
+    struct TopNode
+    {
+        glm::vec3 aabbMin;
+        glm::vec3 aabbMax;
+        uint32_t left;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    std::vector<SceneInstance> instances;
+    std::vector<TopNode> topNodes;
+    std::vector<uint32_t> instanceOrder;
+    bool dirty = true;
+
+    static glm::vec3 TransformPoint(const glm::mat4& matrix, const glm::vec3& point)
+    {
+        glm::vec4 transformed = matrix * glm::vec4(point, 1.0f);
+        return glm::vec3(transformed.x, transformed.y, transformed.z);
+    }
+
+    static glm::vec3 TransformDirection(const glm::mat4& matrix, const glm::vec3& direction)
+    {
+        glm::vec4 transformed = matrix * glm::vec4(direction, 0.0f);
+        return glm::vec3(transformed.x, transformed.y, transformed.z);
+    }
+
+    // WORLD BOUNDS OF THE TRANSFORMED ROOT BOX
+    static void ComputeWorldBounds(SceneInstance& instance)
+    {
+        const BVH_Node& root = instance.mesh->bvhNodes[0];
+        glm::mat4 transform = glm::inverse(instance.inverseTransform);
+        instance.worldMin = glm::vec3(1e30f);
+        instance.worldMax = glm::vec3(-1e30f);
+        for (int corner=0; corner<8; corner++)
+        {
+            glm::vec3 point(
+                (corner & 1) ? root.aabbMax.x : root.aabbMin.x,
+                (corner & 2) ? root.aabbMax.y : root.aabbMin.y,
+                (corner & 4) ? root.aabbMax.z : root.aabbMin.z
+            );
+            glm::vec3 world = TransformPoint(transform, point);
+            instance.worldMin = glm::min(instance.worldMin, world);
+            instance.worldMax = glm::max(instance.worldMax, world);
+        }
+    }
+
+    // adapted from https://jacco.ompf2.com/2022/04/13/how-to-build-a-bvh-part-1-basics/
+    static float IntersectAABB(const glm::vec3& origin, const glm::vec3& inverseDir, const glm::vec3& aabbMin, const glm::vec3& aabbMax)
+    {
+        glm::vec3 tMin = (aabbMin - origin) * inverseDir;
+        glm::vec3 tMax = (aabbMax - origin) * inverseDir;
+        glm::vec3 t1 = glm::min(tMin, tMax);
+        glm::vec3 t2 = glm::max(tMin, tMax);
+        float distFar = std::min(std::min(t2.x, t2.y), t2.z);
+        float distNear = std::max(std::max(t1.x, t1.y), t1.z);
+        bool hit = distFar >= distNear && distFar > 0.0f;
+        return hit ? distNear : SCENE_QUERY_MISS;
+    }
+
+    // MOLLER-TRUMBORE, SAME TOLERANCES AS RayTriangle IN THE SHADERS
+    static float IntersectTriangle(const SceneRay& ray, const glm::vec3& v1, const glm::vec3& v2, const glm::vec3& v3)
+    {
+        glm::vec3 edge1 = v2 - v1;
+        glm::vec3 edge2 = v3 - v1;
+        glm::vec3 p = glm::cross(ray.dir, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::fabs(determinant) < 0.000001f) return SCENE_QUERY_MISS;
+
+        float inverseDeterminant = 1.0f / determinant;
+        glm::vec3 v1ToOrigin = ray.origin - v1;
+        float u = glm::dot(v1ToOrigin, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f) return SCENE_QUERY_MISS;
+
+        glm::vec3 q = glm::cross(v1ToOrigin, edge1);
+        float v = glm::dot(ray.dir, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f) return SCENE_QUERY_MISS;
+
+        float dist = glm::dot(edge2, q) * inverseDeterminant;
+        return dist < 0.0f ? SCENE_QUERY_MISS : dist;
+    }
+
+    // THE DIRECTION IS NOT RENORMALISED IN OBJECT SPACE, SO DISTANCES STAY IN WORLD UNITS OF THE
+    // ORIGINAL RAY AND COMPARE ACROSS MESHES
+    static float IntersectInstance(const SceneInstance& instance, const SceneRay& worldRay, float maxDist)
+    {
+        SceneRay ray;
+        ray.origin = TransformPoint(instance.inverseTransform, worldRay.origin);
+        ray.dir = TransformDirection(instance.inverseTransform, worldRay.dir);
+        glm::vec3 inverseDir = 1.0f / ray.dir;
+
+        const Mesh& mesh = *instance.mesh;
+        float closest = maxDist;
+        uint32_t stack[SCENE_QUERY_STACK_SIZE];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const BVH_Node& node = mesh.bvhNodes[stack[--stackSize]];
+            if (IntersectAABB(ray.origin, inverseDir, node.aabbMin, node.aabbMax) >= closest) continue;
+
+            if (node.indexCount > 0)
+            {
+                for (uint32_t i=0; i<node.indexCount; i+=3)
+                {
+                    const glm::vec3& v1 = mesh.vertices[mesh.indices[node.firstIndex + i]].pos;
+                    const glm::vec3& v2 = mesh.vertices[mesh.indices[node.firstIndex + i + 1]].pos;
+                    const glm::vec3& v3 = mesh.vertices[mesh.indices[node.firstIndex + i + 2]].pos;
+                    closest = std::min(closest, IntersectTriangle(ray, v1, v2, v3));
+                }
+                continue;
+            }
+
+            const BVH_Node& left = mesh.bvhNodes[node.leftChild];
+            const BVH_Node& right = mesh.bvhNodes[node.rightChild];
+            float leftDist = IntersectAABB(ray.origin, inverseDir, left.aabbMin, left.aabbMax);
+            float rightDist = IntersectAABB(ray.origin, inverseDir, right.aabbMin, right.aabbMax);
+            if (stackSize + 2 > SCENE_QUERY_STACK_SIZE) continue;
+            stack[stackSize++] = leftDist <= rightDist ? node.rightChild : node.leftChild;
+            stack[stackSize++] = leftDist <= rightDist ? node.leftChild : node.rightChild;
+        }
+        return closest;
+    }
+
+    // REBUILT LAZILY ON THE NEXT QUERY, A FEW HUNDRED INSTANCES TAKE WELL UNDER A MILLISECOND
+    void RebuildIfDirty()
+    {
+        if (!dirty) return;
+        dirty = false;
+
+        instanceOrder.resize(instances.size());
+        for (uint32_t i=0; i<instances.size(); i++) instanceOrder[i] = i;
+
+        topNodes.clear();
+        topNodes.reserve(instances.size() * 2);
+        TopNode root;
+        root.left = 0;
+        root.first = 0;
+        root.count = static_cast<uint32_t>(instances.size());
+        topNodes.push_back(root);
+        UpdateTopNodeBounds(0);
+        SubdivideTopNode(0, 0);
+    }
+
+    void UpdateTopNodeBounds(uint32_t nodeIndex)
+    {
+        TopNode& node = topNodes[nodeIndex];
+        node.aabbMin = glm::vec3(1e30f);
+        node.aabbMax = glm::vec3(-1e30f);
+        for (uint32_t i=0; i<node.count; i++)
+        {
+            const SceneInstance& instance = instances[instanceOrder[node.first + i]];
+            node.aabbMin = glm::min(node.aabbMin, instance.worldMin);
+            node.aabbMax = glm::max(node.aabbMax, instance.worldMax);
+        }
+    }
+
+    // MEDIAN SPLIT OF THE CENTROIDS ALONG THE LONGEST AXIS OF THE NODE
+    void SubdivideTopNode(uint32_t nodeIndex, uint32_t depth)
+    {
+        if (topNodes[nodeIndex].count <= 2 || depth >= SCENE_QUERY_STACK_SIZE / 2) return;
+
+        TopNode node = topNodes[nodeIndex];
+        glm::vec3 extent = node.aabbMax - node.aabbMin;
+        int axis = 0;
+        if (extent.y > extent[axis]) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+
+        uint32_t* first = instanceOrder.data() + node.first;
+        uint32_t half = node.count / 2;
+        std::nth_element(first, first + half, first + node.count, [this, axis](uint32_t a, uint32_t b)
+        {
+            return instances[a].worldMin[axis] + instances[a].worldMax[axis] < instances[b].worldMin[axis] + instances[b].worldMax[axis];
+        });
+
+        TopNode left;
+        left.left = 0;
+        left.first = node.first;
+        left.count = half;
+        TopNode right;
+        right.left = 0;
+        right.first = node.first + half;
+        right.count = node.count - half;
+
+        uint32_t leftIndex = static_cast<uint32_t>(topNodes.size());
+        topNodes.push_back(left);
+        topNodes.push_back(right);
+        topNodes[nodeIndex].left = leftIndex;
+        topNodes[nodeIndex].count = 0;
+
+        UpdateTopNodeBounds(leftIndex);
+        UpdateTopNodeBounds(leftIndex + 1);
+        SubdivideTopNode(leftIndex, depth + 1);
+        SubdivideTopNode(leftIndex + 1, depth + 1);
+    }
+};
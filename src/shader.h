@@ -5,6 +5,24 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <utility>
+
+// #define LINES PUT AFTER THE #version LINE OF EVERY SHADER, FOR VALUES ONLY KNOWN AT RUN TIME
+inline std::vector<std::pair<std::string, std::string>> shaderDefines;
+
+inline void SetShaderDefine(const std::string& name, const std::string& value)
+{
+    for (auto& define : shaderDefines)
+    {
+        if (define.first == name)
+        {
+            define.second = value;
+            return;
+        }
+    }
+    shaderDefines.emplace_back(name, value);
+}
 
 int GetShaderProgram()
 {
@@ -13,15 +31,43 @@ int GetShaderProgram()
     return program;
 }
 
-std::string LoadShaderFromFile(const std::string &filepath)
+// EXPANDS #include "file" LINES RELATIVE TO THE INCLUDING FILE, GLSL HAS NO INCLUDE OF ITS OWN
+std::string LoadShaderFromFile(const std::string &filepath, int includeDepth = 0)
 {
+    if (includeDepth > 16)
+    {
+        throw std::runtime_error("[LoadShaderFromFile] <Error> Include depth exceeded in \"" + filepath + "\"");
+    }
+
     std::ifstream stream(filepath);
     if (!stream.is_open())
     {
         throw std::runtime_error("[LoadShaderFromFile] <Error> Failed to locate shader file \"" + filepath + "\"");
     }
+
+    std::string directory = filepath.substr(0, filepath.find_last_of("/\\") + 1);
     std::stringstream buffer;
-    buffer << stream.rdbuf();
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        size_t includePos = line.find("#include");
+        if (includePos != std::string::npos && line.find_first_not_of(" \t") == includePos)
+        {
+            size_t nameStart = line.find('"', includePos);
+            size_t nameEnd = line.find('"', nameStart + 1);
+            if (nameStart == std::string::npos || nameEnd == std::string::npos)
+            {
+                throw std::runtime_error("[LoadShaderFromFile] <Error> Malformed include in \"" + filepath + "\": " + line);
+            }
+            buffer << LoadShaderFromFile(directory + line.substr(nameStart + 1, nameEnd - nameStart - 1), includeDepth + 1);
+            continue;
+        }
+        buffer << line << '\n';
+        if (includeDepth == 0 && line.rfind("#version", 0) == 0)
+        {
+            for (const auto& define : shaderDefines) buffer << "#define " << define.first << " " << define.second << '\n';
+        }
+    }
     return buffer.str();
 }
 
@@ -40,7 +86,7 @@ unsigned int CompileShader(unsigned int type, const std::string &source)
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
         char* errorMessage = (char*)alloca(length * sizeof(char));
         glGetShaderInfoLog(id, length, &length, errorMessage);
-        std::cout << "[CompileShader] <Shader Compile Error> " << errorMessage << "\n";
+        std::cerr << "[CompileShader] <Shader Compile Error> " << errorMessage << "\n";
         glDeleteShader(id);
         return 0;
     }
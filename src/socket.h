@@ -0,0 +1,225 @@
+#pragma once
+
+// PLATFORM SOCKETS
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+typedef WSAPOLLFD SocketPollEntry;
+#define INVALID_SOCKET_HANDLE INVALID_SOCKET
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+typedef int SocketHandle;
+typedef pollfd SocketPollEntry;
+#define INVALID_SOCKET_HANDLE -1
+#endif
+
+// STANDARD LIBRARY
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+// BLOCKING TCP SOCKET, MOVE ONLY. SEND AND RECEIVE ALWAYS TRANSFER THE WHOLE BUFFER OR FAIL
+class Socket
+{
+public:
+
+    Socket() {}
+
+    explicit Socket(SocketHandle _handle) : handle(_handle) {}
+
+    Socket(Socket&& other) noexcept : handle(other.handle)
+    {
+        other.handle = INVALID_SOCKET_HANDLE;
+    }
+
+    Socket& operator=(Socket&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            handle = other.handle;
+            other.handle = INVALID_SOCKET_HANDLE;
+        }
+        return *this;
+    }
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    ~Socket()
+    {
+        Close();
+    }
+
+    // ACCEPTS CONNECTIONS ON EVERY INTERFACE
+    static Socket Listen(uint16_t port)
+    {
+        Startup();
+        Socket listener(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        if (!listener.Valid()) throw std::runtime_error("[Socket::Listen] <Error> Could not create a socket");
+
+        int reuse = 1;
+        setsockopt(listener.handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (bind(listener.handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener.handle, SOMAXCONN) != 0)
+        {
+            throw std::runtime_error("[Socket::Listen] <Error> Could not listen on port " + std::to_string(port));
+        }
+        return listener;
+    }
+
+    static Socket Connect(const std::string& host, uint16_t port)
+    {
+        Startup();
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || !addresses)
+        {
+            throw std::runtime_error("[Socket::Connect] <Error> Could not resolve " + host);
+        }
+
+        Socket connection(socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol));
+        bool connected = connection.Valid() && connect(connection.handle, addresses->ai_addr, static_cast<int>(addresses->ai_addrlen)) == 0;
+        freeaddrinfo(addresses);
+        if (!connected) throw std::runtime_error("[Socket::Connect] <Error> Could not connect to " + host + ":" + std::to_string(port));
+
+        connection.SetNoDelay();
+        return connection;
+    }
+
+    // INVALID IF NO CONNECTION COULD BE ACCEPTED
+    Socket Accept()
+    {
+        Socket connection(accept(handle, nullptr, nullptr));
+        if (connection.Valid()) connection.SetNoDelay();
+        return connection;
+    }
+
+    bool SendAll(const void* data, size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+            int sent = send(handle, bytes, chunk, SEND_FLAGS);
+            if (sent <= 0) return false;
+            bytes += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    // FALSE IF THE PEER CLOSED THE CONNECTION OR THE RECEIVE TIMEOUT RAN OUT
+    bool ReceiveAll(void* data, size_t size)
+    {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0)
+        {
+            int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+            int received = recv(handle, bytes, chunk, 0);
+            if (received <= 0) return false;
+            bytes += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    // A PEER THAT STOPS SENDING PART WAY THROUGH A MESSAGE FAILS THE RECEIVE INSTEAD OF HANGING IT
+    void SetReceiveTimeout(int milliseconds)
+    {
+#ifdef _WIN32
+        DWORD timeout = static_cast<DWORD>(milliseconds);
+#else
+        timeval timeout = { milliseconds / 1000, (milliseconds % 1000) * 1000 };
+#endif
+        setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    }
+
+    bool Valid() const
+    {
+        return handle != INVALID_SOCKET_HANDLE;
+    }
+
+    SocketHandle Handle() const
+    {
+        return handle;
+    }
+
+    void Close()
+    {
+        if (!Valid()) return;
+#ifdef _WIN32
+        closesocket(handle);
+#else
+        close(handle);
+#endif
+        handle = INVALID_SOCKET_HANDLE;
+    }
+
+    // WAITS UNTIL AT LEAST ONE SOCKET HAS DATA OR A PENDING CONNECTION, ready[i] IS SET FOR EACH.
+    // CLOSED AND FAILED CONNECTIONS ALSO COUNT AS READY SO THEIR NEXT RECEIVE REPORTS IT
+    static void WaitReadable(const std::vector<SocketHandle>& handles, std::vector<uint8_t>& ready, int timeoutMilliseconds)
+    {
+        std::vector<SocketPollEntry> entries(handles.size());
+        for (size_t i=0; i<handles.size(); i++)
+        {
+            entries[i].fd = handles[i];
+            entries[i].events = POLLIN;
+            entries[i].revents = 0;
+        }
+
+#ifdef _WIN32
+        int result = WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), timeoutMilliseconds);
+#else
+        int result = poll(entries.data(), static_cast<nfds_t>(entries.size()), timeoutMilliseconds);
+#endif
+
+        ready.assign(handles.size(), 0);
+        if (result <= 0) return;
+        for (size_t i=0; i<entries.size(); i++) ready[i] = (entries[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+    }
+
+private:
+    SocketHandle handle = INVALID_SOCKET_HANDLE;
+
+    // A PEER THAT DISCONNECTS SHOULD FAIL THE SEND, NOT RAISE SIGPIPE
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+
+    static void Startup()
+    {
+#ifdef _WIN32
+        static bool started = false;
+        if (started) return;
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) throw std::runtime_error("[Socket::Startup] <Error> Winsock failed to start");
+        started = true;
+#endif
+    }
+
+    // TILE REQUESTS ARE SMALL, DON'T HOLD THEM BACK WAITING FOR MORE DATA
+    void SetNoDelay()
+    {
+        int noDelay = 1;
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    }
+};
@@ -88,9 +88,12 @@ public:
         glUniform1f(glGetUniformLocation(thumbnailShader, "material.emission"), material.data.emission);
         glUniform1f(glGetUniformLocation(thumbnailShader, "material.IOR"), material.data.IOR);
         glUniform1i(glGetUniformLocation(thumbnailShader, "material.refractive"), material.data.refractive);
-        glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.albedoHandle"), material.data.albedoHandle);
-        glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.normalHandle"), material.data.normalHandle);
-        glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.roughnessHandle"), material.data.roughnessHandle);
+        if (BindlessTexturesSupported())
+        {
+            glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.albedoHandle"), material.data.albedoHandle);
+            glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.normalHandle"), material.data.normalHandle);
+            glUniform1ui64ARB(glGetUniformLocation(thumbnailShader, "material.roughnessHandle"), material.data.roughnessHandle);
+        }
         glUniform1ui(glGetUniformLocation(thumbnailShader, "material.textureFlags"), material.data.textureFlags);
 
         // MODEL VIEW PROJECTION UNIFORM
@@ -0,0 +1,236 @@
+#pragma once
+
+// STANDARD LIBRARY
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+// RECTANGLE OF 32x32 WORK GROUPS DISPATCHED TOGETHER
+struct RenderTile
+{
+    int x;
+    int y;
+    int width;
+    int height;
+    float estimatedTime;
+
+    RenderTile()
+    {
+        x = 0;
+        y = 0;
+        width = 0;
+        height = 0;
+        estimatedTime = 0;
+    }
+};
+
+// FIFO OF TILES BACKED BY A RING BUFFER, PUSH AND POP ARE O(1)
+class RenderTileQueue
+{
+public:
+
+    RenderTileQueue() : tiles(16) {}
+
+    void Push(const RenderTile& tile)
+    {
+        if (count == tiles.size()) Grow();
+        tiles[(head + count) & (tiles.size() - 1)] = tile;
+        count++;
+    }
+
+    const RenderTile& Front() const
+    {
+        if (count == 0) throw std::runtime_error("[RenderTileQueue::Front] <Error> Queue is empty");
+        return tiles[head];
+    }
+
+    void Pop()
+    {
+        if (count == 0) throw std::runtime_error("[RenderTileQueue::Pop] <Error> Queue is empty");
+        head = (head + 1) & (tiles.size() - 1);
+        count--;
+    }
+
+    bool Empty() const
+    {
+        return count == 0;
+    }
+
+    size_t Size() const
+    {
+        return count;
+    }
+
+    void Clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<RenderTile> tiles; // CAPACITY IS ALWAYS A POWER OF TWO
+    size_t head = 0;
+    size_t count = 0;
+
+    // DOUBLE CAPACITY AND UNWRAP SO THE QUEUE STARTS AT INDEX 0
+    void Grow()
+    {
+        std::vector<RenderTile> grown(tiles.size() * 2);
+        for (size_t i=0; i<count; i++) grown[i] = tiles[(head + i) & (tiles.size() - 1)];
+        tiles.swap(grown);
+        head = 0;
+    }
+};
+
+// SKYLINE OVER THE GROUP GRID, EACH COLUMN IS FILLED FROM ROW 0 UP TO ITS HEIGHT.
+// A SEGMENT TREE OF MIN/MAX HEIGHTS WITH LAZY ASSIGNMENT GIVES O(LOG N) PLACEMENT,
+// LOWEST COLUMN LOOKUP AND FLAT SPAN QUERIES SO TILES NEVER OVERLAP OR LEAVE GAPS
+class SkylinePacker
+{
+public:
+
+    void Reset(int columns, int rows)
+    {
+        columnCount = std::max(columns, 1);
+        rowCount = rows;
+        leafCount = 1;
+        while (leafCount < columnCount) leafCount *= 2;
+
+        // PADDING COLUMNS PAST THE GRID ARE FULL SO THEY ARE NEVER CHOSEN
+        minHeights.assign(leafCount * 2, rowCount);
+        maxHeights.assign(leafCount * 2, rowCount);
+        pending.assign(leafCount * 2, -1);
+        Assign(1, 0, leafCount, 0, columnCount, 0);
+    }
+
+    int Columns() const
+    {
+        return columnCount;
+    }
+
+    int Rows() const
+    {
+        return rowCount;
+    }
+
+    // LEFTMOST COLUMN WITH THE LOWEST HEIGHT, FALSE ONCE EVERY COLUMN IS FULL
+    bool FindSpace(int& x, int& y)
+    {
+        if (minHeights[1] >= rowCount) return false;
+        y = minHeights[1];
+        x = FindFirstNotAbove(1, 0, leafCount, 0, y);
+        return true;
+    }
+
+    // NUMBER OF COLUMNS FROM x (UP TO maxWidth) THAT ALL HAVE HEIGHT y
+    int FlatWidth(int x, int y, int maxWidth)
+    {
+        int end = std::min(x + maxWidth, columnCount);
+        int firstDifferent = FindFirstDifferent(1, 0, leafCount, x, y);
+        return std::max(0, std::min(firstDifferent, end) - x);
+    }
+
+    int ColumnHeight(int x)
+    {
+        return QueryMax(1, 0, leafCount, x, x + 1);
+    }
+
+    // RAISE THE COLUMNS UNDER THE TILE TO ITS TOP EDGE
+    void Occupy(const RenderTile& tile)
+    {
+        Assign(1, 0, leafCount, tile.x, tile.x + tile.width, tile.y + tile.height);
+    }
+
+    // PLACE A TILE OF THE REQUESTED SHAPE AT THE LOWEST FREE POSITION, CLAMPED TO THE FLAT
+    // RUN OF COLUMNS AND THE GRID SO DIFFERENT SHAPES CAN SHARE ONE PASS
+    bool PlaceTile(int width, int height, RenderTile& tile)
+    {
+        int x, y;
+        if (!FindSpace(x, y)) return false;
+
+        tile.x = x;
+        tile.y = y;
+        tile.width = std::max(1, FlatWidth(x, y, width));
+        tile.height = std::max(1, std::min(height, rowCount - y));
+        Occupy(tile);
+        return true;
+    }
+
+private:
+    int columnCount = 0;
+    int rowCount = 0;
+    int leafCount = 0;
+    std::vector<int> minHeights;
+    std::vector<int> maxHeights;
+    std::vector<int> pending; // LAZY ASSIGNMENT, -1 WHEN NONE
+
+    void Apply(int node, int height)
+    {
+        minHeights[node] = height;
+        maxHeights[node] = height;
+        pending[node] = height;
+    }
+
+    void PushDown(int node)
+    {
+        if (pending[node] < 0) return;
+        Apply(node * 2, pending[node]);
+        Apply(node * 2 + 1, pending[node]);
+        pending[node] = -1;
+    }
+
+    void Assign(int node, int nodeStart, int nodeEnd, int start, int end, int height)
+    {
+        if (end <= nodeStart || nodeEnd <= start) return;
+        if (start <= nodeStart && nodeEnd <= end)
+        {
+            Apply(node, height);
+            return;
+        }
+
+        PushDown(node);
+        int mid = (nodeStart + nodeEnd) / 2;
+        Assign(node * 2, nodeStart, mid, start, end, height);
+        Assign(node * 2 + 1, mid, nodeEnd, start, end, height);
+        minHeights[node] = std::min(minHeights[node * 2], minHeights[node * 2 + 1]);
+        maxHeights[node] = std::max(maxHeights[node * 2], maxHeights[node * 2 + 1]);
+    }
+
+    int QueryMax(int node, int nodeStart, int nodeEnd, int start, int end)
+    {
+        if (end <= nodeStart || nodeEnd <= start) return 0;
+        if (start <= nodeStart && nodeEnd <= end) return maxHeights[node];
+
+        PushDown(node);
+        int mid = (nodeStart + nodeEnd) / 2;
+        return std::max(QueryMax(node * 2, nodeStart, mid, start, end), QueryMax(node * 2 + 1, mid, nodeEnd, start, end));
+    }
+
+    // FIRST COLUMN AT OR AFTER start WITH HEIGHT <= height, leafCount IF NONE
+    int FindFirstNotAbove(int node, int nodeStart, int nodeEnd, int start, int height)
+    {
+        if (nodeEnd <= start || minHeights[node] > height) return leafCount;
+        if (nodeEnd - nodeStart == 1) return nodeStart;
+
+        PushDown(node);
+        int mid = (nodeStart + nodeEnd) / 2;
+        int left = FindFirstNotAbove(node * 2, nodeStart, mid, start, height);
+        if (left != leafCount) return left;
+        return FindFirstNotAbove(node * 2 + 1, mid, nodeEnd, start, height);
+    }
+
+    // FIRST COLUMN AT OR AFTER start WITH HEIGHT != height, leafCount IF NONE
+    int FindFirstDifferent(int node, int nodeStart, int nodeEnd, int start, int height)
+    {
+        if (nodeEnd <= start) return leafCount;
+        if (minHeights[node] == height && maxHeights[node] == height) return leafCount;
+        if (nodeEnd - nodeStart == 1) return nodeStart;
+
+        PushDown(node);
+        int mid = (nodeStart + nodeEnd) / 2;
+        int left = FindFirstDifferent(node * 2, nodeStart, mid, start, height);
+        if (left != leafCount) return left;
+        return FindFirstDifferent(node * 2 + 1, mid, nodeEnd, start, height);
+    }
+};
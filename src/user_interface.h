@@ -7,9 +7,11 @@
 
 // STANDARD LIBRARY
 #include <cstdint>
+#include <cfloat>
 
 // PROJECT HEADERS
 #include "material_manager.h"
+#include "profiler.h"
 
 
 class UserInterface
@@ -116,7 +118,7 @@ public:
         ImGui::PopStyleColor();
     }
 
-    void RenderViewportPanel(int width, int height, float frameTime, bool cursorOverViewport, unsigned int frameBufferTextureID, Camera& camera, ModelManager& modelManager, RenderSystem& renderSystem, const unsigned int &raycastShader)
+    void RenderViewportPanel(int width, int height, float frameTime, bool cursorOverViewport, unsigned int frameBufferTextureID, Camera& camera, ModelManager& modelManager, RenderSystem& renderSystem)
     {
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
         ImGui::BeginChild("Viewport", ImVec2(width, height), true);
@@ -131,13 +133,27 @@ public:
 
         ImGui::Dummy(ImVec2(0, 15));
 
+        // VIEWPORT PIXEL UNDER THE CURSOR, ROWS RUN BOTTOM TO TOP LIKE THE RENDER TARGETS
+        ImVec2 mousePos = ImGui::GetMousePos();
+        float pixelX = mousePos.x - cursorPos.x;
+        float pixelY = height - 1.0f - (mousePos.y - cursorPos.y);
+
         if (draggedModelReleased)
         {
             if (cursorOverViewport)
             {
+                // A MODEL THE GEOMETRY PAGES CANNOT HOLD IS REFUSED, THE SCENE STAYS AS IT WAS
                 int instanceID = modelManager.CreateModelInstance(draggedModelIndex);
-                modelManager.AddModelToScene(&modelManager.modelInstances[instanceID]);
-                restartRender = true;
+                try
+                {
+                    modelManager.AddModelToScene(&modelManager.modelInstances[instanceID]);
+                    restartRender = true;
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[RenderViewportPanel] Failed! Model was not added: " << e.what() << std::endl;
+                    modelManager.DiscardModelInstance(instanceID);
+                }
             }
             draggedModelIndex = -1;
             draggedModelReleased = false;
@@ -147,16 +163,11 @@ public:
         {
             if (cursorOverViewport)
             {
-                ImVec2 mousePos = ImGui::GetMousePos();
-
-        
-                int y = height - mousePos.y + 3;
-                int meshIndex = renderSystem.Raycast(raycastShader, camera, modelManager.meshCount, (int)mousePos.x, y);
-                
-                if (meshIndex >= 0 && meshIndex < modelManager.meshCount)
+                SceneHit hit = modelManager.sceneQuery.Pick(camera, pixelX, pixelY, width, height);
+                if (hit.meshIndex != -1)
                 {
                     modelManager.UpdateMeshMaterial( 
-                        static_cast<uint32_t>(meshIndex), 
+                        static_cast<uint32_t>(hit.meshIndex), 
                         static_cast<uint32_t>(draggedMaterialIndex)
                     );
                     restartRender = true;
@@ -173,22 +184,149 @@ public:
         if (ImGui::Button("Export Render", ImVec2(280, 0)))
         {
             // ADAPTED FROM USER tinyfiledialogs https://stackoverflow.com/questions/6145910/cross-platform-native-open-save-file-dialogs
-            const char *lFilterPatterns[1] = { "*.png" };
-            const char* filename = tinyfd_saveFileDialog("Export Render", "render.png", 1, lFilterPatterns, "(*.png)");
-            if (filename)
+            const char *lFilterPatterns[3] = { "*.png", "*.exr", "*.pfm" };
+            const char* filename = tinyfd_saveFileDialog("Export Render", "render.png", 3, lFilterPatterns, "(*.png, *.exr, *.pfm)");
+            if (filename && IsHDRImagePath(filename))
+            {
+                // LINEAR EXPORTS SKIP THE DENOISER AND TONE MAPPING
+                renderSystem.SaveFinalImageAsync(filename, HDRExportOptions());
+            }
+            else if (filename)
             {
-                SaveRender(frameBufferTextureID, filename);
+                // THE CPU DENOISER ONLY RUNS ON DEMAND, THE VIEWPORT IS REDRAWN WITH ITS RESULT AND
+                // SAVED ONCE IT LANDS. A STALE RESULT WAS NEVER SHOWN, SAVING WOULD WRITE THE NOISY IMAGE
+                if (renderSystem.denoiseMode == DenoiseMode::CPU)
+                {
+                    std::string path = filename;
+                    renderSystem.DenoiseOnCPU([&renderSystem, frameBufferTextureID, path](bool current)
+                    {
+                        if (!current)
+                        {
+                            std::cerr << "[RenderViewportPanel] Failed! The denoised image changed before " << path << " was saved, export again" << std::endl;
+                            return;
+                        }
+                        renderSystem.RenderToViewport();
+                        SaveRenderAsync(renderSystem.readback, frameBufferTextureID, path);
+                    });
+                }
+                else SaveRenderAsync(renderSystem.readback, frameBufferTextureID, filename);
             }
         }
         ImGui::PopStyleColor();
+
+        // A CLICK SELECTS THE MESH UNDER THE CURSOR, A DRAG THE NEAREST MESH INSIDE THE RECTANGLE.
+        // ALL ANSWERED BY THE CPU SCENE QUERY, NOTHING WAITS ON THE GPU
+        bool draggingAsset = draggedModelIndex != -1 || draggedMaterialIndex != -1 || draggedTextureIndex != -1;
+        bool viewportFree = cursorOverViewport && !draggingAsset && !ImGui::IsAnyItemHovered() && !ImGui::IsMouseDown(ImGuiMouseButton_Right);
+        if (viewportFree && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+        {
+            selectingInViewport = true;
+            selectionStart = ImVec2(pixelX, pixelY);
+        }
+        if (selectingInViewport && !ImGui::IsMouseDown(ImGuiMouseButton_Left))
+        {
+            selectingInViewport = false;
+            int meshIndex = -1;
+            if (std::fabs(pixelX - selectionStart.x) < 3.0f && std::fabs(pixelY - selectionStart.y) < 3.0f)
+            {
+                meshIndex = modelManager.sceneQuery.Pick(camera, pixelX, pixelY, width, height).meshIndex;
+            }
+            else
+            {
+                ScreenRect rect = {
+                    std::min(pixelX, selectionStart.x), std::min(pixelY, selectionStart.y),
+                    std::max(pixelX, selectionStart.x), std::max(pixelY, selectionStart.y)
+                };
+                std::vector<int> inside = modelManager.sceneQuery.SelectRect(camera, rect, width, height);
+                if (!inside.empty()) meshIndex = inside[0];
+            }
+
+            selectedMesh = meshIndex;
+            if (meshIndex != -1)
+            {
+                selectedDirectionalLight = -1;
+                selectedPointLight = -1;
+                selectedSpotlight = -1;
+            }
+        }
+
+        // HOVER AND SELECTION OUTLINES
+        int hoveredMesh = viewportFree ? modelManager.sceneQuery.Pick(camera, pixelX, pixelY, width, height).meshIndex : -1;
+        if (hoveredMesh != -1 && hoveredMesh != selectedMesh) DrawMeshBounds(modelManager, camera, hoveredMesh, cursorPos, width, height, BUTTON_HOVER);
+        if (selectedMesh != -1) DrawMeshBounds(modelManager, camera, selectedMesh, cursorPos, width, height, SELECTED);
+        if (selectingInViewport)
+        {
+            ImVec2 start(cursorPos.x + selectionStart.x, cursorPos.y + height - 1.0f - selectionStart.y);
+            ImGui::GetWindowDrawList()->AddRect(start, mousePos, ImGui::ColorConvertFloat4ToU32(HexToRGBA(SELECTED)));
+        }
         ImGui::Dummy(ImVec2(0, 0));
 
 
         RenderSettingsPanel(camera, renderSystem);
+        if (Profiler::enabled) RenderProfilerOverlay(width);
         ImGui::EndChild();
         ImGui::PopStyleVar();
     }
 
+    // STAGE TIMES AND COUNTERS OVER THE TOP RIGHT OF THE VIEWPORT, AVERAGED OVER HALF A SECOND
+    // AT 60 FPS SO THE FIGURES ARE READABLE
+    void RenderProfilerOverlay(int width)
+    {
+        const uint32_t averageFrames = 30;
+        const float overlayWidth = 300.0f;
+        ImGui::SetCursorPosX(width - overlayWidth - 15.0f);
+        ImGui::SetCursorPosY(15.0f);
+        ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.0f, 0.0f, 0.0f, 0.75f));
+        ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
+        ImGui::PushStyleColor(ImGuiCol_PlotLines, HexToRGBA(SELECTED));
+        ImGui::BeginChild("Profiler HUD", ImVec2(overlayWidth, 0), ImGuiChildFlags_AutoResizeY);
+        ImGui::Indent(5.0f);
+
+        // FRAME TIME GRAPH
+        std::vector<float> frameTimes = Profiler::Ordered(Profiler::frameTime);
+        ImGui::Text("Frame %.2f ms", std::max(Profiler::Average(Profiler::frameTime, averageFrames), 0.0f));
+        if (!frameTimes.empty()) ImGui::PlotLines("##PROFILER FRAME", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(overlayWidth - 10.0f, 40.0f));
+
+        // PER STAGE CPU / GPU MILLISECONDS, GPU GRAPH FOR EVERY STAGE THAT HAS ONE
+        for (const Profiler::Stage& stage : Profiler::stages)
+        {
+            float cpuTime = std::max(Profiler::Average(stage.cpuTime, averageFrames), 0.0f);
+            float gpuTime = Profiler::Average(stage.gpuTime, averageFrames);
+            if (stage.gpu && gpuTime >= 0.0f) ImGui::Text("%-10s cpu %6.2f  gpu %6.2f", stage.name.c_str(), cpuTime, gpuTime);
+            else ImGui::Text("%-10s cpu %6.2f", stage.name.c_str(), cpuTime);
+            if (!stage.gpu) continue;
+
+            std::vector<float> gpuTimes = Profiler::Ordered(stage.gpuTime);
+            std::string plotID = "##PROFILER GPU " + stage.name;
+            if (!gpuTimes.empty()) ImGui::PlotLines(plotID.c_str(), gpuTimes.data(), static_cast<int>(gpuTimes.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(overlayWidth - 10.0f, 20.0f));
+        }
+
+        // THROUGHPUT AND PROGRESS
+        for (const Profiler::Counter& counter : Profiler::counters)
+        {
+            if (counter.name == "progress") continue;
+            float value = std::max(Profiler::Average(counter.value, averageFrames), 0.0f);
+            ImGui::Text("%-16s %s", counter.name.c_str(), FormatRayRate(value).c_str());
+        }
+        float progress = Profiler::FrameCount() > 0 ? Profiler::FindCounter("progress").value[Profiler::Slot(Profiler::frameIndex - 1)] : -1.0f;
+        if (progress >= 0.0f) ImGui::ProgressBar(progress, ImVec2(overlayWidth - 10.0f, 0));
+
+        // CSV OF EVERY FRAME IN THE HISTORY
+        ImGui::PushStyleColor(ImGuiCol_Button, HexToRGBA(BUTTON));
+        if (ImGui::Button("Export CSV", ImVec2(overlayWidth - 10.0f, 0)))
+        {
+            const char *lFilterPatterns[1] = { "*.csv" };
+            const char* filename = tinyfd_saveFileDialog("Export Profile", "profile.csv", 1, lFilterPatterns, "(*.csv)");
+            if (filename) Profiler::ExportCSV(filename);
+        }
+        ImGui::PopStyleColor();
+
+        ImGui::Unindent(5.0f);
+        ImGui::Dummy(ImVec2(0, 0));
+        ImGui::EndChild();
+        ImGui::PopStyleColor(3);
+    }
+
     void RenderSettingsPanel(Camera& camera, RenderSystem& renderSystem)
     {
         ImGui::SetCursorPosX(ImGui::GetCursorPosX() + 20.0f);
@@ -213,29 +351,174 @@ public:
             changed |= CheckboxAttribute("Anti Aliasing", "AA", 3, 3, &camera.anti_aliasing);
             changed |= DragFloatAttribute("Exposure", "EXPOSURE", "", 3, 3, &camera.exposure, 0.0f, 3.0f, 0.01f);
 
-            // RENDER SETTINGS
-            if (IntAttribute("Light Bounces", "BOUNCES", 3, &renderSystem.bounces, 1, 10))
-            {
-                renderSystem.ResizePathBuffer();
-                changed = true;
-            }
+            // RENDER SETTINGS, PATHS ARE EVALUATED AS THEY ARE TRACED SO BOUNCES NEED NO REALLOCATION
+            changed |= IntAttribute("Light Bounces", "BOUNCES", 3, &renderSystem.bounces, 1, 10);
+
+            // APPLIES FROM THE NEXT PASS, NO RESTART NEEDED
+            IntAttribute("Samples / Dispatch", "SAMPLES PER DISPATCH", 3, &renderSystem.samplesPerDispatch, 1, 64);
+
+            // NAVIGATION QUALITY, THE CONTROLLER TRADES RESOLUTION, BOUNCES AND SAMPLES FOR FRAME RATE
+            DynamicResolutionController& dynamicResolution = renderSystem.dynamicResolution;
+            DragFloatAttribute("Target FPS", "TARGET FPS", "", 3, 3, &dynamicResolution.targetFrameRate, 10.0f, 240.0f, 1.0f);
+            DragFloatAttribute("Min Scale", "MIN DYNAMIC SCALE", "", 3, 3, &dynamicResolution.minScale, DYNAMIC_SCALE_STEP, 1.0f, 0.01f);
+            CheckboxAttribute("Adjust Bounces", "DYNAMIC BOUNCES", 3, 3, &dynamicResolution.adjustBounces);
+            CheckboxAttribute("Adjust Samples", "DYNAMIC SAMPLES", 3, 3, &dynamicResolution.adjustSamples);
+            CheckboxAttribute("Temporal", "TEMPORAL", 3, 3, &renderSystem.temporalReprojection);
+            IntAttribute("History Frames", "TEMPORAL HISTORY", 3, &renderSystem.temporalHistory, 1, 64);
+
+            // DENOISING, CPU MODE FILTERS EXPORTS AND FINISHED JOBS WHILE PREVIEWS STAY ON THE GPU
+            static const char* denoiseModes[] = { "Off", "GPU", "CPU" };
+            int denoiseMode = static_cast<int>(renderSystem.denoiseMode);
+            if (ComboAttribute("Denoiser", "DENOISER", 3, 3, &denoiseMode, denoiseModes, 3)) renderSystem.denoiseMode = static_cast<DenoiseMode>(denoiseMode);
+            DragFloatAttribute("Denoise Strength", "DENOISE STRENGTH", "", 3, 3, &renderSystem.denoiseColourSigma, 0.5f, 16.0f, 0.1f);
+            char dynamicState[64];
+            snprintf(dynamicState, 64, "%d%% x%u x%u  %.1fms", static_cast<int>(dynamicResolution.Scale() * 100.0f), dynamicResolution.Bounces(), dynamicResolution.Samples(), dynamicResolution.FrameTime());
+            TextAttribute("Navigation", "DYNAMIC STATE", 3, 3, dynamicState);
 
             // ENVIRONMENT SETTINGS
             changed |= ColourSelectAttribute("Sky colour", "###Sky Colour Button", "###Sky Colour", renderSystem.skyColour, skyColourPopupOpen, GAP, 3);
             changed |= DragFloatAttribute("Sky Brightness", "SKY BRIGHTNESS", "", 3, 3, &renderSystem.skyBrightness, 0.0f, 4.0f, 0.01f);
+
+            // TRACING MODE, BOTH REPORT RAYS/SEC SO THEY CAN BE COMPARED ON THE SAME SCENE
+            changed |= CheckboxAttribute("Wavefront", "WAVEFRONT", 3, 3, &renderSystem.wavefront);
+            TextAttribute("Rays / sec", "RAYS PER SEC", 3, 3, FormatRayRate(renderSystem.GetRaysPerSecond()));
+
+            // STAGE TIMING OVERLAY, EACH TIME IT IS TURNED ON THE HISTORY STARTS OVER
+            if (CheckboxAttribute("Profiler", "PROFILER", 3, 3, &Profiler::enabled) && Profiler::enabled) Profiler::Reset();
             if (changed) restartRender = true;
 
+            // ADAPTIVE SAMPLING, CHANGES APPLY FROM THE NEXT PASS WITHOUT A RESTART
+            CheckboxAttribute("Adaptive Sampling", "ADAPTIVE", 3, 3, &renderSystem.adaptiveSampling);
+            DragFloatAttribute("Noise Threshold", "NOISE THRESHOLD", "", 3, 3, &renderSystem.noiseThreshold, 0.001f, 0.5f, 0.001f);
+            std::string converged = std::to_string(renderSystem.GetConvergedGroupCount()) + " / " + std::to_string(renderSystem.GetGroupCount());
+            if (renderSystem.IsConverged()) converged += " (done)";
+            TextAttribute("Converged Tiles", "CONVERGED TILES", 3, 3, converged);
+
+            // SAMPLE COUNT MAP
+            ImGui::Dummy(ImVec2(3, 0));
+            ImGui::SameLine();
+            float sampleMapWidth = SpaceX() - 3;
+            ImGui::Image(
+                (ImTextureID)(intptr_t)renderSystem.GetSampleMapTextureID(),
+                ImVec2(sampleMapWidth, sampleMapWidth / renderSystem.GetSampleMapAspect()));
+
             // CLOSE CONTAINER
             ImGui::Dummy(ImVec2(0, 0));
             ImGui::EndChild();
             ImGui::PopStyleVar();
             ImGui::PopStyleColor();
         }
+        RenderJobPanel(renderSystem);
+        RenderMemoryPanel();
         ImGui::PopStyleVar();
         ImGui::PopStyleColor(2);
         ImGui::EndChild();
     }
 
+    void RenderJobPanel(RenderSystem& renderSystem)
+    {
+        if (ImGui::CollapsingHeader("Render Job")) 
+        {
+            // BEGIN CONTAINER
+            ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, GAP));
+            ImGui::PushStyleColor(ImGuiCol_ChildBg, HexToRGBA(MATERIAL_EDITOR_BG));
+            ImGui::BeginChild("Render Job", ImVec2(0, 0), ImGuiChildFlags_AutoResizeY);
+            ImGui::Dummy(ImVec2(0, 0));
+
+            // STOP CONDITIONS, ZERO DISABLES A CONDITION
+            IntAttribute("Target Samples", "JOB SAMPLES", 3, &jobTargetSamples, 0, 100000);
+            DragFloatAttribute("Time Budget", "JOB TIME", "s", 3, 3, &renderJobSettings.timeBudget, 0.0f, 86400.0f, 1.0f);
+            DragFloatAttribute("Target Error", "JOB ERROR", "", 3, 3, &renderJobSettings.targetError, 0.0f, 0.5f, 0.001f);
+            CheckboxAttribute("Auto Export", "JOB EXPORT", 3, 3, &renderJobSettings.autoExport);
+
+            // PROGRESS
+            if (renderSystem.IsRenderJobActive())
+            {
+                TextAttribute("Samples", "JOB PROGRESS SAMPLES", 3, 3, std::to_string(renderSystem.GetSampleCount()));
+                TextAttribute("Elapsed", "JOB PROGRESS TIME", 3, 3, std::to_string(static_cast<int>(renderSystem.GetRenderJobElapsedTime())) + "s");
+            }
+
+            // START / CANCEL
+            ImGui::Dummy(ImVec2(3, 0));
+            ImGui::SameLine();
+            ImGui::PushStyleColor(ImGuiCol_Button, HexToRGBA(BUTTON));
+            if (renderSystem.IsRenderJobActive())
+            {
+                if (ImGui::Button("Cancel Render Job", ImVec2(SpaceX() - 3, 0))) renderSystem.CancelRenderJob();
+            }
+            else if (ImGui::Button("Start Render Job", ImVec2(SpaceX() - 3, 0)))
+            {
+                bool start = true;
+                if (renderJobSettings.autoExport)
+                {
+                    const char *lFilterPatterns[3] = { "*.png", "*.exr", "*.pfm" };
+                    const char* filename = tinyfd_saveFileDialog("Export Render", "render.png", 3, lFilterPatterns, "(*.png, *.exr, *.pfm)");
+                    if (filename) renderJobSettings.exportPath = filename;
+                    else start = false;
+                }
+
+                if (start)
+                {
+                    renderJobSettings.targetSamples = static_cast<uint32_t>(jobTargetSamples);
+                    renderSystem.StartRenderJob(renderJobSettings);
+                }
+            }
+            ImGui::PopStyleColor();
+
+            // CLOSE CONTAINER
+            ImGui::Dummy(ImVec2(0, 0));
+            ImGui::EndChild();
+            ImGui::PopStyleVar();
+            ImGui::PopStyleColor();
+        }
+    }
+
+    void RenderMemoryPanel()
+    {
+        if (ImGui::CollapsingHeader("Memory")) 
+        {
+            // BEGIN CONTAINER
+            ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, GAP));
+            ImGui::PushStyleColor(ImGuiCol_ChildBg, HexToRGBA(MATERIAL_EDITOR_BG));
+            ImGui::BeginChild("Memory", ImVec2(0, 0), ImGuiChildFlags_AutoResizeY);
+            ImGui::Dummy(ImVec2(0, 0));
+
+            // TOTALS
+            uint64_t totalUsed = MemoryTracker::TotalUsed();
+            uint64_t totalAllocated = MemoryTracker::TotalAllocated();
+            TextAttribute("Total Used", "MEM TOTAL USED", 3, 3, FormatBytes(totalUsed));
+            TextAttribute("Total Allocated", "MEM TOTAL ALLOCATED", 3, 3, FormatBytes(totalAllocated));
+            TextAttribute("High Water Mark", "MEM HIGH WATER", 3, 3, FormatBytes(MemoryTracker::totalHighWaterMark));
+            TextAttribute("Fragmentation", "MEM FRAGMENTATION", 3, 3, FormatPercent(MemoryTracker::Fragmentation(totalUsed, totalAllocated)));
+
+            // PER SUBSYSTEM USED / ALLOCATED
+            for (const auto& [name, subsystem] : MemoryTracker::subsystems)
+            {
+                std::string id = "MEM " + name;
+                std::string usage = FormatBytes(subsystem.used) + " / " + FormatBytes(subsystem.allocated);
+                TextAttribute(name, id.c_str(), 3, 3, usage);
+            }
+
+            // JSON REPORT
+            ImGui::Dummy(ImVec2(3, 0));
+            ImGui::SameLine();
+            ImGui::PushStyleColor(ImGuiCol_Button, HexToRGBA(BUTTON));
+            if (ImGui::Button("Save Memory Report", ImVec2(SpaceX() - 3, 0)))
+            {
+                const char *lFilterPatterns[1] = { "*.json" };
+                const char* filename = tinyfd_saveFileDialog("Save Memory Report", "memory.json", 1, lFilterPatterns, "(*.json)");
+                if (filename) MemoryTracker::DumpJSON(filename);
+            }
+            ImGui::PopStyleColor();
+
+            // CLOSE CONTAINER
+            ImGui::Dummy(ImVec2(0, 0));
+            ImGui::EndChild();
+            ImGui::PopStyleVar();
+            ImGui::PopStyleColor();
+        }
+    }
+
     void BeginSidebar(float height)
     {
         ImGui::SameLine();
@@ -792,6 +1075,10 @@ private:
     bool releasingDraggedTexture = false;
     bool droppedTextureIntoSlot = false;
 
+    // VIEWPORT SELECTION CONTROLS
+    bool selectingInViewport = false;
+    ImVec2 selectionStart;
+
     // TRANSFORM PANEL CONTROLS
     int selectedMesh = -1;
     int selectedDirectionalLight = -1;
@@ -803,6 +1090,20 @@ private:
     // SKY CONTROLS
     bool skyColourPopupOpen = false;
 
+    // RENDER JOB CONTROLS
+    RenderJob renderJobSettings;
+    int jobTargetSamples = 1024;
+
+
+    // OUTLINES THE SCREEN BOUNDS OF A MESH OVER THE VIEWPORT IMAGE AT origin
+    void DrawMeshBounds(ModelManager& modelManager, Camera& camera, int meshIndex, ImVec2 origin, int width, int height, const char* colour)
+    {
+        ScreenRect rect;
+        if (!modelManager.sceneQuery.ProjectBounds(camera, static_cast<uint32_t>(meshIndex), width, height, rect)) return;
+        ImVec2 topLeft(origin.x + rect.minX, origin.y + height - 1.0f - rect.maxY);
+        ImVec2 bottomRight(origin.x + rect.maxX, origin.y + height - 1.0f - rect.minY);
+        ImGui::GetWindowDrawList()->AddRect(topLeft, bottomRight, ImGui::ColorConvertFloat4ToU32(HexToRGBA(colour)));
+    }
 
     // ADAPTED FROM Tor Klingberg https://stackoverflow.com/questions/3723846/convert-from-hex-color-to-rgb-struct-in-c
     ImVec4 HexToRGBA(const char* hex)
@@ -832,6 +1133,31 @@ private:
         return ImGui::GetContentRegionAvail().y;
     }
 
+    std::string FormatBytes(uint64_t bytes)
+    {
+        char text[32];
+        if (bytes >= (1ull << 30)) snprintf(text, 32, "%.2f GB", bytes / static_cast<double>(1ull << 30));
+        else if (bytes >= (1ull << 20)) snprintf(text, 32, "%.2f MB", bytes / static_cast<double>(1ull << 20));
+        else snprintf(text, 32, "%.1f KB", bytes / 1024.0);
+        return text;
+    }
+
+    std::string FormatPercent(float fraction)
+    {
+        char text[16];
+        snprintf(text, 16, "%.1f%%", fraction * 100.0f);
+        return text;
+    }
+
+    std::string FormatRayRate(float raysPerSecond)
+    {
+        char text[32];
+        if (raysPerSecond >= 1e9f) snprintf(text, 32, "%.2f G", raysPerSecond / 1e9f);
+        else if (raysPerSecond >= 1e6f) snprintf(text, 32, "%.2f M", raysPerSecond / 1e6f);
+        else snprintf(text, 32, "%.0f", raysPerSecond);
+        return text;
+    }
+
     void PaddedText(const char* text, float padding)
     {
         ImGui::Indent(padding);
@@ -840,6 +1166,28 @@ private:
     }
 
     // }----------{ ATTRIBUTE COMPONENTS }----------{
+    void TextAttribute(std::string label, const char* id, float padding, float margin, std::string value)
+    {
+        std::string frameID = "###" + std::string(id);
+        ImGui::PushStyleColor(ImGuiCol_ChildBg, HexToRGBA(ATTRIBUTE_BG));
+
+        ImGui::Dummy(ImVec2(margin, 1)); 
+        ImGui::SameLine();
+
+        ImGui::BeginChild(frameID.c_str(), ImVec2(SpaceX() - margin, 0), ImGuiChildFlags_AutoResizeY);
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+        ImGui::Dummy(ImVec2(1, padding));
+        ImGui::Indent(padding); 
+        ImGui::Text("%s", label.c_str());   
+        ImGui::SameLine(SpaceX() - ImGui::CalcTextSize(value.c_str()).x - padding); 
+        ImGui::Text("%s", value.c_str());
+        ImGui::Unindent(padding); 
+        ImGui::Dummy(ImVec2(1, padding)); 
+        ImGui::PopStyleVar();
+        ImGui::EndChild();
+        ImGui::PopStyleColor();
+    }
+
     bool FloatAttribute(std::string label, const char* id, const char* suffix, float padding, float margin, float* value, float min, float max)
     {
         bool changed = false;
@@ -1007,6 +1355,37 @@ private:
         return changed;
     }
 
+    bool ComboAttribute(std::string label, const char* id, float padding, float margin, int* value, const char* const items[], int itemCount)
+    {
+        bool changed = false;
+        std::string frameID = "###" + std::string(id);
+        ImGui::PushStyleColor(ImGuiCol_ChildBg, HexToRGBA(ATTRIBUTE_BG));
+        ImGui::PushStyleColor(ImGuiCol_FrameBg, HexToRGBA(INPUT_BG));
+
+        ImGui::Dummy(ImVec2(margin, 1)); 
+        ImGui::SameLine();
+
+        ImGui::BeginChild(frameID.c_str(), ImVec2(SpaceX() - margin, 0), ImGuiChildFlags_AutoResizeY);
+        ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+        std::string uniqueID = "##" + std::string(id);
+        ImGui::Dummy(ImVec2(1, padding)); // VERTICAL PADDING
+        ImGui::Indent(padding); // HORIZONTAL PADDING
+        ImGui::Text("%s", label.c_str());   
+        ImGui::SameLine(SpaceX() - 100.0f); 
+        ImGui::PushItemWidth(100.0f - padding);
+        if (ImGui::Combo(uniqueID.c_str(), value, items, itemCount))
+        {
+            changed = true;
+        }
+        ImGui::PopItemWidth();
+        ImGui::Unindent(padding); // HORIZONTAL PADDING
+        ImGui::Dummy(ImVec2(1, padding)); // VERTICAL PADDING
+        ImGui::PopStyleVar();
+        ImGui::EndChild();
+        ImGui::PopStyleColor(2);
+        return changed;
+    }
+
     bool TransformAttribute(std::string label, float padding, float* x, float* y, float* z)
     {   
         ImGui::PushStyleColor(ImGuiCol_ChildBg, HexToRGBA(ATTRIBUTE_BG));
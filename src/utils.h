@@ -2,6 +2,17 @@
 
 #include <string>
 #include <functional>
+#include <cstdio>
+
+// strcpy_s ONLY EXISTS IN THE MICROSOFT C RUNTIME, LINUX BUILDS FOR RENDER NODES USE THIS ONE
+#ifndef _WIN32
+inline int strcpy_s(char* destination, size_t size, const char* source)
+{
+    if (destination == nullptr || size == 0) return 22; // EINVAL
+    snprintf(destination, size, "%s", source);
+    return 0;
+}
+#endif
 
 std::string ExtractName(std::string filepath)
 {
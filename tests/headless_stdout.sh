@@ -0,0 +1,41 @@
+#!/bin/bash
+# THE HEADLESS RENDERER MUST PRINT EXACTLY ONE JSON LINE TO stdout, WHETHER IT RENDERS OR FAILS,
+# SO RENDER FARM SCRIPTS CAN PARSE IT. RUNS THE BINARY FROM ITS OWN FOLDER, WHICH HOLDS THE SHADERS
+# COPIED BY ./compile_headless.sh. NEEDS AN EGL DRIVER, llvmpipe IS ENOUGH
+baseDir="$(cd "$(dirname "$0")/.." && pwd)"
+headless="${1:-$baseDir/build/rayleak_headless}"
+outDir="$(mktemp -d)"
+trap 'rm -rf "$outDir"' EXIT
+
+if [ ! -x "$headless" ]; then
+    echo "[HeadlessStdout] Failed! No headless binary at $headless, build it with ./compile_headless.sh"
+    exit 1
+fi
+
+# <NAME> <EXPECTED EXIT CODE> <EXPECTED STATUS> <ARGUMENTS...>
+CheckRun()
+{
+    local name="$1" expectedCode="$2" expectedStatus="$3"
+    shift 3
+    local stdoutPath="$outDir/$name.stdout"
+    (cd "$(dirname "$headless")" && "$headless" "$@" > "$stdoutPath" 2> "$outDir/$name.stderr")
+    local code=$?
+
+    local lines
+    lines=$(wc -l < "$stdoutPath")
+    if [ "$code" -ne "$expectedCode" ]; then
+        echo "[HeadlessStdout] Failed! $name exited with $code instead of $expectedCode"
+        exit 1
+    fi
+    if [ "$lines" -ne 1 ] || ! grep -q '^{"status":"'"$expectedStatus"'".*}$' "$stdoutPath"; then
+        echo "[HeadlessStdout] Failed! $name printed $lines lines to stdout instead of one JSON line:"
+        cat "$stdoutPath"
+        exit 1
+    fi
+    echo "[HeadlessStdout] $name: one JSON line with status $expectedStatus"
+}
+
+CheckRun rendered 0 rendered "$baseDir/scenes/validation/deep_bvh.scene" --output "$outDir/render.png" --width 64 --height 40 --samples 1
+CheckRun bad_scene 3 bad_scene "$outDir/missing.scene" --output "$outDir/missing.png"
+CheckRun bad_arguments 1 bad_arguments --samples
+echo "[HeadlessStdout] All checks passed"
@@ -0,0 +1,424 @@
+// ALLOCATION TRACES FOR THE GPU MEMORY MANAGERS ON THE CPU BACKEND. EVERY STEP OF A TRACE IS CHECKED
+// BYTE FOR BYTE AGAINST A REFERENCE COPY OF WHAT THE BUFFERS SHOULD HOLD, THEN THE SAME TRACE IS
+// REPLAYED WITHOUT CHECKS AND TIMED. BUILD AND RUN WITH ./compile_tests.sh, NO GL CONTEXT IS NEEDED
+
+// EXTERNAL LIBRARIES
+#include <GL/glew.h>
+#include "../lib/glm/glm.hpp"
+#include "../lib/tinyfiledialogs/tinyfiledialogs.h"
+
+// STANDARD LIBRARY
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+
+// PROJECT HEADERS
+#include "../src/model_manager.h"
+#include "../src/light_manager.h"
+#include "../src/material_manager.h"
+
+#define TRACE_STEPS 4000
+#define TRACE_SEED 1234
+
+// BINDINGS THE MANAGERS USE, SAME AS THE SHADERS
+#define MATERIAL_BINDING 4
+#define PARTITION_BINDING 6
+#define DIRECTIONAL_LIGHT_BINDING 7
+#define POINT_LIGHT_BINDING 8
+#define SPOTLIGHT_BINDING 9
+
+static void Check(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error("[Check] <Error> " + message);
+}
+
+static CPUBuffer* Bound(int binding)
+{
+    CPUBuffer* buffer = GPUBackend::BoundCPUBuffer(binding);
+    Check(buffer != nullptr, "nothing bound at binding " + std::to_string(binding));
+    return buffer;
+}
+
+// THE USED PART OF A CONTIGUOUS BUFFER MUST MATCH ITS REFERENCE EXACTLY
+static void CheckContiguous(int binding, const std::vector<uint8_t>& reference, const char* name)
+{
+    CPUBuffer* buffer = Bound(binding);
+    Check(buffer->Size() >= reference.size(), std::string(name) + " buffer is smaller than its contents");
+    Check(memcmp(buffer->Data(), reference.data(), reference.size()) == 0, std::string(name) + " buffer differs from the reference");
+}
+
+template <typename T>
+static void WriteReference(std::vector<uint8_t>& reference, size_t index, const T& item)
+{
+    if (reference.size() < (index + 1) * sizeof(T)) reference.resize((index + 1) * sizeof(T));
+    memcpy(reference.data() + index * sizeof(T), &item, sizeof(T));
+}
+
+template <typename T>
+static void EraseReference(std::vector<uint8_t>& reference, size_t index)
+{
+    reference.erase(reference.begin() + index * sizeof(T), reference.begin() + (index + 1) * sizeof(T));
+}
+
+static glm::vec3 RandomVec3(std::mt19937& rng, float range)
+{
+    std::uniform_real_distribution<float> dist(-range, range);
+    return glm::vec3(dist(rng), dist(rng), dist(rng));
+}
+
+// RUNS A TRACE ONCE WITH CHECKS AND ONCE TIMED, THE TRACE BUILDS ITS OWN MANAGERS EACH TIME
+static void RunTrace(const char* name, const std::function<void(bool check)>& trace)
+{
+    trace(true);
+    auto start = std::chrono::high_resolution_clock::now();
+    trace(false);
+    auto end = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "[MemoryManagers] " << name << ": " << TRACE_STEPS << " steps passed, " << ms << " ms unchecked" << std::endl;
+}
+
+// ADDS, UPDATES AND DELETES ALL THREE LIGHT TYPES IN A RANDOM ORDER
+static void LightTrace(bool check)
+{
+    LightManager lightManager;
+    std::vector<uint8_t> directionalReference, pointReference, spotReference;
+    std::mt19937 rng(TRACE_SEED);
+
+    for (int step=0; step<TRACE_STEPS; step++)
+    {
+        uint32_t type = rng() % 3;
+        uint32_t action = rng() % 10;
+
+        if (type == 0)
+        {
+            size_t count = lightManager.directionalLights.size();
+            if (action < 5 || count == 0)
+            {
+                lightManager.AddDirectionalLight();
+                count++;
+            }
+            else if (action < 8)
+            {
+                size_t index = rng() % count;
+                lightManager.DeleteDirectionalLight(static_cast<int>(index));
+                EraseReference<DirectionalLight>(directionalReference, index);
+                count--;
+            }
+            if (count == 0) continue;
+
+            // UPDATES COPY THE WHOLE STRUCT, PADDING INCLUDED, SO THE REFERENCE TAKES THE SAME BYTES
+            size_t index = action < 5 ? count - 1 : rng() % count;
+            DirectionalLight& light = lightManager.directionalLights[index];
+            light.direction = RandomVec3(rng, 1.0f);
+            light.colour = RandomVec3(rng, 1.0f);
+            lightManager.UpdateDirectionalLight(static_cast<int>(index));
+            WriteReference(directionalReference, index, light);
+        }
+        else if (type == 1)
+        {
+            size_t count = lightManager.pointLights.size();
+            if (action < 5 || count == 0)
+            {
+                lightManager.AddPointLight();
+                count++;
+            }
+            else if (action < 8)
+            {
+                size_t index = rng() % count;
+                lightManager.DeletePointLight(static_cast<int>(index));
+                EraseReference<PointLight>(pointReference, index);
+                count--;
+            }
+            if (count == 0) continue;
+
+            size_t index = action < 5 ? count - 1 : rng() % count;
+            PointLight& light = lightManager.pointLights[index];
+            light.position = RandomVec3(rng, 10.0f);
+            light.brightness = static_cast<float>(step);
+            lightManager.UpdatePointLight(static_cast<int>(index));
+            WriteReference(pointReference, index, light);
+        }
+        else
+        {
+            size_t count = lightManager.spotlights.size();
+            if (action < 5 || count == 0)
+            {
+                lightManager.AddSpotlight();
+                count++;
+            }
+            else if (action < 8)
+            {
+                size_t index = rng() % count;
+                lightManager.DeleteSpotlight(static_cast<int>(index));
+                EraseReference<Spotlight>(spotReference, index);
+                count--;
+            }
+            if (count == 0) continue;
+
+            size_t index = action < 5 ? count - 1 : rng() % count;
+            Spotlight& light = lightManager.spotlights[index];
+            light.position = RandomVec3(rng, 10.0f);
+            light.angle = static_cast<float>(step);
+            lightManager.UpdateSpotlight(static_cast<int>(index));
+            WriteReference(spotReference, index, light);
+        }
+
+        if (!check) continue;
+        Check(directionalReference.size() == lightManager.directionalLights.size() * sizeof(DirectionalLight), "directional light count");
+        Check(pointReference.size() == lightManager.pointLights.size() * sizeof(PointLight), "point light count");
+        Check(spotReference.size() == lightManager.spotlights.size() * sizeof(Spotlight), "spotlight count");
+        CheckContiguous(DIRECTIONAL_LIGHT_BINDING, directionalReference, "directional light");
+        CheckContiguous(POINT_LIGHT_BINDING, pointReference, "point light");
+        CheckContiguous(SPOTLIGHT_BINDING, spotReference, "spotlight");
+    }
+}
+
+// MATERIALS ARE NEVER DELETED, THE TRACE ADDS THOUSANDS AND REWRITES RANDOM ONES
+static void MaterialTrace(bool check)
+{
+    MaterialManager materialManager(0);
+    std::vector<uint8_t> reference;
+    WriteReference(reference, 0, materialManager.materials[0].data);
+    std::mt19937 rng(TRACE_SEED);
+
+    for (int step=0; step<TRACE_STEPS; step++)
+    {
+        size_t index;
+        if (rng() % 3 != 0)
+        {
+            MaterialData data;
+            index = static_cast<size_t>(materialManager.AddMaterial(data, "material " + std::to_string(step)));
+        }
+        else
+        {
+            index = rng() % materialManager.materials.size();
+        }
+
+        MaterialData& data = materialManager.materials[index].data;
+        data.colour = RandomVec3(rng, 1.0f);
+        data.roughness = static_cast<float>(step);
+        materialManager.UpdateMaterial(data, static_cast<int>(index));
+        WriteReference(reference, index, data);
+
+        if (!check) continue;
+        Check(reference.size() == materialManager.materials.size() * sizeof(MaterialData), "material count");
+        CheckContiguous(MATERIAL_BINDING, reference, "material");
+    }
+}
+
+// A PLACED MESH AS THE TRACE EXPECTS IT, IN PARTITION ORDER
+struct PlacedMesh
+{
+    Mesh* mesh;
+    uint32_t id;
+    uint32_t materialIndex;
+    glm::mat4 inverseTransform;
+    glm::mat4 transform;
+};
+
+static Mesh* CreateMesh(std::mt19937& rng, uint32_t triangleCount)
+{
+    Mesh* mesh = new Mesh();
+    mesh->Init();
+    mesh->aabbMin = glm::vec3(1e30f);
+    mesh->aabbMax = glm::vec3(-1e30f);
+    // resize VALUE-INITIALIZES, WHICH ZEROES THE PADDING TOO, SO BUFFERS COMPARE BYTE FOR BYTE
+    mesh->vertices.resize(triangleCount * 3);
+    for (uint32_t i=0; i<triangleCount * 3; i++)
+    {
+        Vertex& vertex = mesh->vertices[i];
+        vertex.pos = RandomVec3(rng, 5.0f);
+        vertex.normal = glm::normalize(RandomVec3(rng, 1.0f) + glm::vec3(0.0f, 0.0f, 2.0f));
+        vertex.u = static_cast<float>(i);
+        mesh->aabbMin = glm::min(mesh->aabbMin, vertex.pos);
+        mesh->aabbMax = glm::max(mesh->aabbMax, vertex.pos);
+        mesh->indices.push_back(i);
+    }
+    mesh->BuildBVH();
+    return mesh;
+}
+
+template <typename T>
+static void CheckRange(int binding, uint32_t start, const T* expected, size_t count, const char* name)
+{
+    CPUBuffer* buffer = Bound(binding);
+    Check((start + count) * sizeof(T) <= buffer->Size(), std::string(name) + " range is outside its page");
+    Check(memcmp(buffer->Data() + start * sizeof(T), expected, count * sizeof(T)) == 0, std::string(name) + " data differs from the mesh");
+}
+
+// LIVE RANGES IN ONE PAGE MUST NOT OVERLAP, OTHERWISE TWO INSTANCES OF ONE MESH COULD SHARE BYTES UNNOTICED
+static void CheckDisjoint(std::vector<std::pair<uint64_t, uint64_t>> ranges, const char* name)
+{
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i=1; i<ranges.size(); i++)
+    {
+        Check(ranges[i - 1].second <= ranges[i].first, std::string(name) + " regions overlap");
+    }
+}
+
+static void CheckPlacedMeshes(const std::vector<PlacedMesh>& placed)
+{
+    uint32_t pageCount = GeometryPageCount();
+    CPUBuffer* partitions = Bound(PARTITION_BINDING);
+    Check(partitions->Size() >= placed.size() * sizeof(MeshPartition), "partition buffer is smaller than its contents");
+
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> vertexRanges(pageCount), indexRanges(pageCount), bvhRanges(pageCount);
+    for (size_t i=0; i<placed.size(); i++)
+    {
+        // OFFSETS AND PAGE ARE THE ALLOCATOR'S CHOICE, EVERYTHING ELSE IS KNOWN UP FRONT
+        MeshPartition actual;
+        memcpy(&actual, partitions->Data() + i * sizeof(MeshPartition), sizeof(MeshPartition));
+        Check(actual.page < pageCount, "partition page out of range");
+
+        MeshPartition expected{};
+        expected.verticesStart = actual.verticesStart;
+        expected.indicesStart = actual.indicesStart;
+        expected.bvhNodeStart = actual.bvhNodeStart;
+        expected.page = actual.page;
+        expected.materialIndex = placed[i].materialIndex;
+        expected.inverseTransform = placed[i].inverseTransform;
+        expected.transform = placed[i].transform;
+        Check(memcmp(&expected, &actual, sizeof(MeshPartition)) == 0, "partition " + std::to_string(i) + " differs from the reference");
+
+        const Mesh* mesh = placed[i].mesh;
+        uint32_t page = actual.page;
+        CheckRange(GEOMETRY_PAGE_BINDING + page, actual.verticesStart, mesh->vertices.data(), mesh->vertices.size(), "vertex");
+        CheckRange(GEOMETRY_PAGE_BINDING + pageCount + page, actual.indicesStart, mesh->indices.data(), mesh->indices.size(), "index");
+        CheckRange(GEOMETRY_PAGE_BINDING + 2 * pageCount + page, actual.bvhNodeStart, mesh->bvhNodes, mesh->nodesUsed, "bvh");
+        vertexRanges[page].push_back({ actual.verticesStart, actual.verticesStart + mesh->vertices.size() });
+        indexRanges[page].push_back({ actual.indicesStart, actual.indicesStart + mesh->indices.size() });
+        bvhRanges[page].push_back({ actual.bvhNodeStart, actual.bvhNodeStart + mesh->nodesUsed });
+    }
+    for (uint32_t page=0; page<pageCount; page++)
+    {
+        CheckDisjoint(vertexRanges[page], "vertex");
+        CheckDisjoint(indexRanges[page], "index");
+        CheckDisjoint(bvhRanges[page], "bvh");
+    }
+}
+
+// PLACES INSTANCES OF A FEW MULTI MESH MODELS, DELETES RANDOM MESHES, MOVES AND REPAINTS THEM.
+// SMALL PAGES FORCE THE POOLS TO GROW, REUSE GAPS AND SPILL INTO THE SECOND PAGE
+static void ModelTrace(bool check)
+{
+    ModelManager modelManager;
+    std::vector<PlacedMesh> placed;
+    std::mt19937 rng(TRACE_SEED);
+
+    for (int m=0; m<8; m++)
+    {
+        Model model;
+        model.id = m;
+        strcpy_s(model.name, 32, ("model " + std::to_string(m)).c_str());
+        strcpy_s(model.tempName, 32, model.name);
+        for (int s=0; s<1 + m % 3; s++)
+        {
+            Mesh* mesh = CreateMesh(rng, 4 + rng() % 60);
+            modelManager.meshes.push_back(mesh);
+            model.submeshPtrs.push_back(mesh);
+        }
+        modelManager.models.push_back(model);
+    }
+
+    for (int step=0; step<TRACE_STEPS; step++)
+    {
+        uint32_t action = rng() % 10;
+        if (action < 5 || placed.empty())
+        {
+            int modelIndex = static_cast<int>(rng() % modelManager.models.size());
+            for (Mesh* mesh : modelManager.models[modelIndex].submeshPtrs) mesh->position = RandomVec3(rng, 20.0f);
+
+            int instanceID = modelManager.CreateModelInstance(modelIndex);
+            Model& instance = modelManager.modelInstances[instanceID];
+            try
+            {
+                modelManager.AddModelToScene(&instance);
+            }
+            catch (const std::exception&)
+            {
+                // A FULL SCENE MUST REFUSE THE MODEL AND LEAVE EVERYTHING ELSE AS IT WAS
+                modelManager.DiscardModelInstance(instanceID);
+                if (check) CheckPlacedMeshes(placed);
+                continue;
+            }
+            for (size_t i=0; i<instance.submeshPtrs.size(); i++)
+            {
+                Mesh* mesh = instance.submeshPtrs[i];
+                placed.push_back({ mesh, instance.meshIDs[i], 0, mesh->inverseTransform, mesh->transform });
+            }
+        }
+        else if (action < 8)
+        {
+            // FIND THE INSTANCE AND SUBMESH THAT OWN THE PARTITION, THE WAY THE OBJECTS PANEL DOES
+            size_t meshIndex = rng() % placed.size();
+            size_t partition = 0;
+            for (size_t i=0; i<modelManager.modelInstances.size(); i++)
+            {
+                Model& instance = modelManager.modelInstances[i];
+                if (meshIndex < partition + instance.meshIDs.size())
+                {
+                    size_t submesh = meshIndex - partition;
+                    Check(instance.meshIDs[submesh] == placed[meshIndex].id, "partition order differs from instance order");
+                    modelManager.DeleteInstanceMesh(static_cast<int>(i), static_cast<int>(submesh), static_cast<int>(meshIndex));
+                    break;
+                }
+                partition += instance.meshIDs.size();
+            }
+            placed.erase(placed.begin() + meshIndex);
+        }
+        else if (action < 9)
+        {
+            size_t meshIndex = rng() % placed.size();
+            placed[meshIndex].materialIndex = rng() % 64;
+            modelManager.UpdateMeshMaterial(static_cast<uint32_t>(meshIndex), placed[meshIndex].materialIndex);
+        }
+        else
+        {
+            size_t meshIndex = rng() % placed.size();
+            Mesh* mesh = placed[meshIndex].mesh;
+            mesh->rotation = RandomVec3(rng, 180.0f);
+            mesh->UpdateInverseTransformMat();
+            modelManager.UpdateMeshTransform(mesh, static_cast<uint32_t>(meshIndex));
+            placed[meshIndex].inverseTransform = mesh->inverseTransform;
+            placed[meshIndex].transform = mesh->transform;
+        }
+
+        if (!check) continue;
+        Check(modelManager.meshCount == static_cast<int>(placed.size()), "mesh count");
+        Check(modelManager.sceneQuery.InstanceCount() == static_cast<int>(placed.size()), "scene query instance count");
+        CheckPlacedMeshes(placed);
+    }
+
+    for (Mesh* mesh : modelManager.meshes)
+    {
+        delete[] mesh->bvhNodes;
+        delete mesh;
+    }
+}
+
+int main()
+{
+    GPUBackend::headless = true;
+    GPUBackend::headlessMaxBlockSize = 64 * 1024;
+
+    try
+    {
+        RunTrace("lights", LightTrace);
+        RunTrace("materials", MaterialTrace);
+        RunTrace("models", ModelTrace);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[MemoryManagers] Failed! " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "[MemoryManagers] All traces passed" << std::endl;
+    return 0;
+}
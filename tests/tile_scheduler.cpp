@@ -0,0 +1,194 @@
+// TILE SCHEDULER CHECKS, NO GL. RANDOM MIXED TILE SHAPES MUST COVER EVERY WORK GROUP OF THE GRID
+// EXACTLY ONCE, THE TILE QUEUE MUST STAY FIFO WHILE IT WRAPS AND GROWS, AND SCHEDULING A 4K PASS
+// IS TIMED. BUILD AND RUN WITH ./compile_tests.sh
+
+// STANDARD LIBRARY
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+// PROJECT HEADERS
+#include "../src/tile_scheduler.h"
+
+#define TEST_SEED 1234
+#define COVERAGE_GRIDS 400
+#define QUEUE_STEPS 200000
+#define TIMED_PASSES 50
+
+static void Check(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error("[Check] <Error> " + message);
+}
+
+static void Cover(std::vector<int>& coverage, int columns, int rows, const RenderTile& tile)
+{
+    Check(tile.width > 0 && tile.height > 0, "empty tile");
+    Check(tile.x >= 0 && tile.y >= 0 && tile.x + tile.width <= columns && tile.y + tile.height <= rows, "tile outside the grid");
+    for (int y=tile.y; y<tile.y + tile.height; y++)
+    {
+        for (int x=tile.x; x<tile.x + tile.width; x++) coverage[y * columns + x]++;
+    }
+}
+
+// FILLS ONE GRID THE WAYS A PASS DOES: FIXED SHAPES THROUGH PlaceTile, TILES GROWN FROM A
+// SINGLE GROUP LIKE THE ADAPTIVE PASS, AND CONVERGED GROUPS THAT ARE FILLED WITHOUT A TILE
+static void CheckCoverage(std::mt19937& rng, int columns, int rows)
+{
+    SkylinePacker skyline;
+    skyline.Reset(columns, rows);
+    std::vector<int> coverage(columns * rows, 0);
+
+    while (true)
+    {
+        RenderTile tile;
+        uint32_t mode = rng() % 4;
+        if (mode == 0)
+        {
+            int width = 1 + rng() % 8;
+            int height = 1 + rng() % 8;
+            if (!skyline.PlaceTile(width, height, tile)) break;
+        }
+        else
+        {
+            int x, y;
+            if (!skyline.FindSpace(x, y)) break;
+            tile.x = x;
+            tile.y = y;
+            tile.width = 1;
+            tile.height = 1;
+
+            // SAME RULE AS RenderSystem::GrowTile, ONLY WIDEN INTO COLUMNS AT THE TILE'S BASE
+            if (mode != 1)
+            {
+                int targetWidth = 1 + rng() % 10;
+                int targetHeight = 1 + rng() % 10;
+                while (true)
+                {
+                    bool hSpace = tile.height < targetHeight && tile.y + tile.height < skyline.Rows();
+                    bool vSpace = tile.width < targetWidth && tile.x + tile.width < columns && skyline.ColumnHeight(tile.x + tile.width) == tile.y;
+                    if (hSpace) tile.height++;
+                    if (vSpace) tile.width++;
+                    if (!hSpace && !vSpace) break;
+                }
+            }
+            skyline.Occupy(tile);
+        }
+        Cover(coverage, columns, rows, tile);
+    }
+
+    for (int i=0; i<columns * rows; i++)
+    {
+        Check(coverage[i] == 1, "group " + std::to_string(i % columns) + "," + std::to_string(i / columns) + " of " + std::to_string(columns) + "x" + std::to_string(rows) + " covered " + std::to_string(coverage[i]) + " times");
+    }
+}
+
+// RANDOM PUSHES AND POPS AGAINST A DEQUE, THE QUEUE WRAPS MANY TIMES AND GROWS WHILE WRAPPED
+static void CheckQueue(std::mt19937& rng)
+{
+    RenderTileQueue queue;
+    std::deque<int> reference;
+    int nextID = 0;
+    size_t largest = 0;
+
+    for (int step=0; step<QUEUE_STEPS; step++)
+    {
+        // PHASES OF MOSTLY PUSHING AND MOSTLY POPPING, SO THE HEAD MOVES BEFORE EACH GROW
+        bool pushing = (step / 1000) % 2 == 0;
+        if (reference.empty() || rng() % 10 < (pushing ? 7u : 3u))
+        {
+            RenderTile tile;
+            tile.x = nextID++;
+            queue.Push(tile);
+            reference.push_back(tile.x);
+        }
+        else
+        {
+            Check(queue.Front().x == reference.front(), "queue order differs from the reference");
+            queue.Pop();
+            reference.pop_front();
+        }
+        Check(queue.Size() == reference.size(), "queue size differs from the reference");
+        largest = std::max(largest, reference.size());
+
+        if (step == QUEUE_STEPS / 2)
+        {
+            queue.Clear();
+            reference.clear();
+        }
+    }
+    while (!reference.empty())
+    {
+        Check(queue.Front().x == reference.front(), "queue order differs while draining");
+        queue.Pop();
+        reference.pop_front();
+    }
+    Check(queue.Empty(), "queue not empty after draining");
+
+    bool threw = false;
+    try
+    {
+        queue.Pop();
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    Check(threw, "popping an empty queue did not throw");
+    std::cout << "[TileScheduler] queue: " << QUEUE_STEPS << " steps passed, up to " << largest << " tiles queued" << std::endl;
+}
+
+// A 4K PASS OF 1x1 TILES, THE WORST CASE FOR THE ADAPTIVE SCHEDULE
+static void TimePass()
+{
+    int columns = (3840 + 31) / 32;
+    int rows = (2160 + 31) / 32;
+    SkylinePacker skyline;
+    RenderTileQueue queue;
+    size_t tileCount = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int pass=0; pass<TIMED_PASSES; pass++)
+    {
+        skyline.Reset(columns, rows);
+        RenderTile tile;
+        while (skyline.PlaceTile(1, 1, tile)) queue.Push(tile);
+        tileCount = queue.Size();
+        while (!queue.Empty()) queue.Pop();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / TIMED_PASSES;
+    std::cout << "[TileScheduler] 4K pass: " << tileCount << " tiles scheduled and drained in " << ms << " ms" << std::endl;
+}
+
+int main()
+{
+    std::mt19937 rng(TEST_SEED);
+    try
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i=0; i<COVERAGE_GRIDS; i++)
+        {
+            int columns = 1 + rng() % 130;
+            int rows = 1 + rng() % 70;
+            CheckCoverage(rng, columns, rows);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << "[TileScheduler] coverage: " << COVERAGE_GRIDS << " random grids covered exactly once in " << ms << " ms" << std::endl;
+
+        CheckQueue(rng);
+        TimePass();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[TileScheduler] Failed! " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "[TileScheduler] All checks passed" << std::endl;
+    return 0;
+}